@@ -0,0 +1,348 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include "../math_parallel.h"
+
+namespace bench {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// Nearest-rank percentile of samples
+double percentile(std::vector<double> samples, double fraction) {
+  if (samples.empty()) return 0;
+
+  std::sort(samples.begin(), samples.end());
+  std::size_t rank = std::size_t(std::ceil(fraction * samples.size()));
+  return samples[std::min(samples.size() - 1, rank ? rank - 1 : 0)];
+}
+
+std::size_t parse_size(const std::string& arg, const std::string& value) {
+  std::size_t pos = 0;
+  unsigned long long result = 0;
+  try {
+    result = std::stoull(value, &pos);
+  } catch (const std::exception&) {
+    pos = 0;
+  }
+  if (pos != value.size() || value.empty()) {
+    throw std::invalid_argument("Bad value of " + arg + ": " + value);
+  }
+  return std::size_t(result);
+}
+
+std::vector<std::size_t> parse_list(const std::string& arg,
+                                    const std::string& value) {
+  std::vector<std::size_t> result;
+  std::size_t first = 0;
+  while (first <= value.size()) {
+    std::size_t last = std::min(value.find(',', first), value.size());
+    result.push_back(parse_size(arg, value.substr(first, last - first)));
+    first = last + 1;
+  }
+  return result;
+}
+
+double parse_double(const std::string& arg, const std::string& value) {
+  std::size_t pos = 0;
+  double result = 0;
+  try {
+    result = std::stod(value, &pos);
+  } catch (const std::exception&) {
+    pos = 0;
+  }
+  if (pos != value.size() || value.empty()) {
+    throw std::invalid_argument("Bad value of " + arg + ": " + value);
+  }
+  return result;
+}
+
+std::string json_escape(const std::string& s) {
+  std::string result;
+  for (char c : s) {
+    if (c == '"' || c == '\\') result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+void print_header(std::ostream& out) {
+  out << std::left << std::setw(28) << "benchmark" << std::right
+      << std::setw(7) << "size" << std::setw(14) << "ns/op"
+      << std::setw(14) << "p99 ns/op" << std::setw(10) << "GFLOP/s"
+      << std::setw(10) << "GB/s" << std::setw(10) << "batch" << '\n';
+}
+
+void print_row(std::ostream& out, const result& r) {
+  out << std::left << std::setw(28) << r.name << std::right << std::setw(7)
+      << r.size;
+  if (r.skipped) {
+    out << "  skipped: " << r.reason << std::endl;
+    return;
+  }
+
+  out << std::fixed << std::setprecision(1) << std::setw(14) << r.median_ns()
+      << std::setw(14) << r.p99_ns() << std::setprecision(3) << std::setw(10)
+      << r.gflops() << std::setw(10) << r.gbps() << std::setw(10) << r.batch
+      << std::defaultfloat << std::endl;
+}
+
+}  // namespace
+
+result measure(const benchmark& b, std::size_t size, const options& opts) {
+  result r;
+  r.name = b.name;
+  r.size = size;
+
+  workload w = b.setup(size);
+  r.flops = w.flops;
+  r.bytes = w.bytes;
+
+  // the first run is a warm-up too; it is the only sample of too slow ops
+  auto start = clock_type::now();
+  w.op();
+  double once = std::max(seconds_since(start), 1e-9);
+  if (once > opts.max_op_seconds) {
+    r.batch = 1;
+    r.samples_ns.push_back(once * 1e9);
+    return r;
+  }
+
+  for (std::size_t i = 1; i < opts.warmup; ++i) w.op();
+
+  // batch enough operations into one sample to make timer overhead negligible
+  r.batch = std::max<std::size_t>(
+      1, std::size_t(std::ceil(opts.min_sample_seconds / once)));
+
+  for (std::size_t rep = 0; rep < opts.repetitions; ++rep) {
+    start = clock_type::now();
+    for (std::size_t i = 0; i < r.batch; ++i) w.op();
+    r.samples_ns.push_back(seconds_since(start) * 1e9 / double(r.batch));
+  }
+
+  return r;
+}
+
+double result::median_ns() const { return percentile(samples_ns, 0.5); }
+
+double result::p99_ns() const { return percentile(samples_ns, 0.99); }
+
+double result::mean_ns() const {
+  if (samples_ns.empty()) return 0;
+  return std::accumulate(samples_ns.begin(), samples_ns.end(), 0.0) /
+         double(samples_ns.size());
+}
+
+double result::min_ns() const { return percentile(samples_ns, 0); }
+
+double result::gflops() const {
+  double ns = median_ns();
+  return ns > 0 ? flops / ns : 0;
+}
+
+double result::gbps() const {
+  double ns = median_ns();
+  return ns > 0 ? bytes / ns : 0;
+}
+
+options parse_options(int argc, char** argv) {
+  options opts;
+  std::size_t min_size = 0, max_size = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + arg);
+      return argv[++i];
+    };
+
+    if (arg == "--filter") {
+      opts.filter = value();
+    } else if (arg == "--min-size") {
+      min_size = parse_size(arg, value());
+    } else if (arg == "--max-size") {
+      max_size = parse_size(arg, value());
+    } else if (arg == "--warmup") {
+      opts.warmup = parse_size(arg, value());
+    } else if (arg == "--repetitions") {
+      opts.repetitions = std::max<std::size_t>(1, parse_size(arg, value()));
+    } else if (arg == "--min-sample-time") {
+      opts.min_sample_seconds = parse_double(arg, value());
+    } else if (arg == "--max-op-time") {
+      opts.max_op_seconds = parse_double(arg, value());
+    } else if (arg == "--threads") {
+      math::set_num_threads(parse_size(arg, value()));
+    } else if (arg == "--roofline") {
+      opts.roofline = true;
+    } else if (arg == "--tune") {
+      opts.tune = true;
+    } else if (arg == "--profile") {
+      opts.profile_path = value();
+    } else if (arg == "--thread-counts") {
+      opts.thread_counts = parse_list(arg, value());
+    } else if (arg == "--baseline") {
+      opts.baseline_path = value();
+    } else if (arg == "--threshold") {
+      opts.threshold = parse_double(arg, value());
+    } else if (arg == "--alpha") {
+      opts.alpha = parse_double(arg, value());
+    } else if (arg == "--counters") {
+      opts.counters_path = value();
+    } else if (arg == "--trace") {
+      opts.trace_path = value();
+    } else if (arg == "--hardware") {
+      opts.hardware_path = value();
+    } else if (arg == "--json") {
+      opts.json_path = value();
+    } else {
+      throw std::invalid_argument("Unknown argument: " + arg);
+    }
+  }
+
+  if (opts.roofline && !opts.baseline_path.empty()) {
+    throw std::invalid_argument("--baseline does not apply to --roofline");
+  }
+  if (opts.tune && (opts.roofline || !opts.baseline_path.empty())) {
+    throw std::invalid_argument("--tune runs alone");
+  }
+
+  // compute bound kernels of the roofline mode are not interesting when tiny
+  if (!min_size) min_size = opts.roofline ? 64 : 2;
+  if (!max_size) max_size = opts.roofline ? 2048 : 8192;
+  for (std::size_t size = 2; size <= max_size; size *= 2) {
+    if (size >= min_size) opts.sizes.push_back(size);
+  }
+  return opts;
+}
+
+void print_usage(std::ostream& out, const char* program) {
+  out << "Usage: " << program << " [options]\n"
+      << "  --filter TEXT          run benchmarks which names contain TEXT\n"
+      << "  --min-size N           smallest size, default 2 (64 in roofline)\n"
+      << "  --max-size N           largest size, default 8192 (2048 in "
+         "roofline)\n"
+      << "  --warmup N             untimed runs before measuring, default 2\n"
+      << "  --repetitions N        timed samples, default 15\n"
+      << "  --min-sample-time S    minimal seconds per sample, default 0.001\n"
+      << "  --max-op-time S        skip larger sizes once one operation takes\n"
+      << "                         longer, default 0.5\n"
+      << "  --threads N            threads of parallel kernels, 0 - all\n"
+      << "  --json FILE            write results with all samples to FILE\n"
+      << "  --counters FILE        write operation counters of the whole run\n"
+      << "                         to FILE, needs INSTRUMENTATION=1 build\n"
+      << "  --trace FILE           write Chrome trace of the run to FILE,\n"
+      << "                         needs INSTRUMENTATION=1 build\n"
+      << "  --hardware FILE        write perf counters per operation and size\n"
+      << "                         to FILE, needs INSTRUMENTATION=1 build\n"
+      << "  --baseline FILE        compare with results saved by --json and\n"
+      << "                         exit with 2 if there are regressions\n"
+      << "  --threshold X          relative change of median treated as\n"
+      << "                         noise, default 0.05\n"
+      << "  --alpha X              significance level of Mann-Whitney test,\n"
+      << "                         default 0.05\n"
+      << "  --roofline             compare GEMM and factorizations with\n"
+      << "                         measured peak FLOP/s and memory bandwidth\n"
+      << "  --thread-counts LIST   comma separated threads counts of\n"
+      << "                         roofline, default powers of two up to all\n"
+      << "                         threads\n"
+      << "  --tune                 search blocking parameters and thread\n"
+      << "                         grains of this CPU and save them to the\n"
+      << "                         profile the library loads at startup\n"
+      << "  --profile FILE         profile written by --tune, default\n"
+      << "                         $MATH_TUNING_PROFILE or\n"
+      << "                         ~/.config/cpp_math_library/tuning.profile\n";
+}
+
+std::vector<result> run(const std::vector<benchmark>& list,
+                        const options& opts, std::ostream& out) {
+  std::vector<result> results;
+  print_header(out);
+
+  for (const auto& b : list) {
+    if (b.name.find(opts.filter) == std::string::npos) continue;
+
+    std::string skip_reason;
+    for (std::size_t size : opts.sizes) {
+      result r;
+      if (skip_reason.empty()) {
+        try {
+          r = measure(b, size, opts);
+          if (r.median_ns() * 1e-9 > opts.max_op_seconds) {
+            skip_reason = "smaller size exceeded --max-op-time";
+          }
+        } catch (const std::bad_alloc&) {
+          skip_reason = "out of memory";
+        }
+      }
+
+      if (!skip_reason.empty() && r.samples_ns.empty()) {
+        r.name = b.name;
+        r.size = size;
+        r.skipped = true;
+        r.reason = skip_reason;
+      }
+
+      print_row(out, r);
+      results.push_back(std::move(r));
+    }
+  }
+
+  return results;
+}
+
+void write_json(std::ostream& out, const std::vector<result>& results,
+                const options& opts) {
+  std::time_t now = std::time(nullptr);
+  char date[32] = {};
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  out << std::setprecision(17);
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+      << "    \"threads\": " << math::num_threads() << ",\n"
+      << "    \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n"
+      << "    \"repetitions\": " << opts.repetitions << ",\n"
+      << "    \"warmup\": " << opts.warmup << "\n  },\n"
+      << "  \"benchmarks\": [";
+
+  bool comma = false;
+  for (const auto& r : results) {
+    out << (comma ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(r.name)
+        << "\", \"size\": " << r.size;
+    comma = true;
+
+    if (r.skipped) {
+      out << ", \"skipped\": true, \"reason\": \"" << json_escape(r.reason)
+          << "\"}";
+      continue;
+    }
+
+    out << ", \"batch\": " << r.batch << ", \"median_ns\": " << r.median_ns()
+        << ", \"p99_ns\": " << r.p99_ns() << ", \"mean_ns\": " << r.mean_ns()
+        << ", \"min_ns\": " << r.min_ns() << ", \"flops\": " << r.flops
+        << ", \"bytes\": " << r.bytes << ", \"gflops\": " << r.gflops()
+        << ", \"gbps\": " << r.gbps() << ", \"samples_ns\": [";
+    for (std::size_t i = 0; i < r.samples_ns.size(); ++i) {
+      out << (i ? ", " : "") << r.samples_ns[i];
+    }
+    out << "]}";
+  }
+
+  out << "\n  ]\n}\n";
+}
+
+}  // namespace bench
@@ -0,0 +1,118 @@
+#ifndef CPP_MATH_LIBRARY_BENCH_BENCH_H_
+#define CPP_MATH_LIBRARY_BENCH_BENCH_H_
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief One prepared operation of given size with estimated amount of work,
+ * used to derive GFLOP/s and GB/s
+ *
+ */
+struct workload {
+  std::function<void()> op;
+  double flops = 0;
+  double bytes = 0;
+};
+
+/**
+ * @brief Named benchmark: setup(size) allocates inputs and returns workload
+ * that is timed
+ *
+ */
+struct benchmark {
+  std::string name;
+  std::function<workload(std::size_t)> setup;
+};
+
+// Registers all matrix and vector benchmarks into list
+void register_benchmarks(std::vector<benchmark>& list);
+
+struct options {
+  std::vector<std::size_t> sizes;
+  std::string filter;
+  std::size_t warmup = 2;
+  std::size_t repetitions = 15;
+  // minimal duration of one timed sample, operations are batched to reach it
+  double min_sample_seconds = 1e-3;
+  // larger sizes of a benchmark are skipped once one operation is slower
+  double max_op_seconds = 0.5;
+  std::string json_path;
+  // operation counters dump, needs library built with MATH_INSTRUMENTATION
+  std::string counters_path;
+  // Chrome trace of the run, needs library built with MATH_INSTRUMENTATION
+  std::string trace_path;
+  // hardware counters per operation and size, needs MATH_INSTRUMENTATION
+  // build and perf events allowed by the kernel
+  std::string hardware_path;
+  // roofline mode: sweeps thread_counts and compares with measured limits
+  bool roofline = false;
+  std::vector<std::size_t> thread_counts;
+  // tuning mode: searches kernel parameters and writes them to profile_path,
+  // math::default_tuning_profile() if empty
+  bool tune = false;
+  std::string profile_path;
+  // comparison with results of a previous run written by --json
+  std::string baseline_path;
+  double threshold = 0.05;  // relative change of median ignored as noise
+  double alpha = 0.05;      // significance level of Mann-Whitney test
+};
+
+struct result {
+  std::string name;
+  std::size_t size = 0;
+  std::size_t batch = 0;
+  std::vector<double> samples_ns;  // time of one operation in every sample
+  double flops = 0;
+  double bytes = 0;
+  bool skipped = false;
+  std::string reason;
+
+  double median_ns() const;
+  double p99_ns() const;
+  double mean_ns() const;
+  double min_ns() const;
+  double gflops() const;
+  double gbps() const;
+};
+
+/**
+ * @brief Parses command line arguments. Throws std::invalid_argument on
+ * unknown or malformed arguments
+ *
+ */
+options parse_options(int argc, char** argv);
+
+// Prints command line help
+void print_usage(std::ostream& out, const char* program);
+
+// Times benchmark b of given size according to options
+result measure(const benchmark& b, std::size_t size, const options& opts);
+
+// Runs benchmarks matching options and prints table rows as they finish
+std::vector<result> run(const std::vector<benchmark>& list,
+                        const options& opts, std::ostream& out);
+
+// Writes results as JSON document
+void write_json(std::ostream& out, const std::vector<result>& results,
+                const options& opts);
+
+// Keeps value and all memory writes from being optimized away
+template <class T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+}  // namespace bench
+
+#endif  // CPP_MATH_LIBRARY_BENCH_BENCH_H_
@@ -0,0 +1,99 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../math_instrumentation.h"
+#include "../math_tuning.h"
+#include "bench.h"
+#include "compare.h"
+#include "roofline.h"
+#include "tune.h"
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--help") {
+      bench::print_usage(std::cout, argv[0]);
+      return 0;
+    }
+  }
+
+  int status = 0;
+  try {
+    bench::options opts = bench::parse_options(argc, argv);
+    if ((!opts.counters_path.empty() || !opts.trace_path.empty() ||
+         !opts.hardware_path.empty()) &&
+        !math::instrumentation::enabled()) {
+      throw std::runtime_error(
+          "--counters, --trace and --hardware need INSTRUMENTATION=1 build");
+    }
+
+    std::vector<bench::benchmark> list;
+    bench::register_benchmarks(list);
+    std::ofstream json;
+    if (!opts.json_path.empty()) {
+      json.open(opts.json_path);
+      if (!json) throw std::runtime_error("Can not open " + opts.json_path);
+    }
+
+    if (!opts.trace_path.empty()) {
+      math::instrumentation::start_tracing(opts.trace_path);
+    }
+    if (!opts.hardware_path.empty() &&
+        !math::instrumentation::start_hardware_counters()) {
+      throw std::runtime_error(
+          "Hardware counters are unavailable, check perf_event_paranoid");
+    }
+
+    if (opts.tune) {
+      std::string path = opts.profile_path.empty()
+                             ? math::default_tuning_profile()
+                             : opts.profile_path;
+      if (path.empty()) throw std::runtime_error("--tune needs --profile");
+
+      auto parameters = bench::run_tuning(list, opts, std::cout);
+      math::write_tuning_profile(path, math::cpu_model(), parameters);
+      std::cout << "Profile of " << math::cpu_model() << " written to "
+                << path << std::endl;
+    } else if (opts.roofline) {
+      auto points = bench::run_roofline(list, opts, std::cout);
+      if (json.is_open()) bench::write_roofline_json(json, points, opts);
+    } else {
+      // read baseline first to fail before a long run
+      std::vector<bench::result> baseline;
+      if (!opts.baseline_path.empty()) {
+        std::ifstream in(opts.baseline_path);
+        if (!in) throw std::runtime_error("Can not open " + opts.baseline_path);
+        baseline = bench::read_json(in);
+      }
+
+      auto results = bench::run(list, opts, std::cout);
+      if (json.is_open()) bench::write_json(json, results, opts);
+
+      if (!opts.baseline_path.empty()) {
+        auto comparisons = bench::compare(baseline, results, opts);
+        if (bench::print_comparison(std::cout, comparisons, opts)) status = 2;
+      }
+    }
+
+    math::instrumentation::stop_tracing();
+    math::instrumentation::stop_hardware_counters();
+    if (!opts.counters_path.empty()) {
+      std::ofstream out(opts.counters_path);
+      if (!out) throw std::runtime_error("Can not open " + opts.counters_path);
+      math::instrumentation::dump_json(out, math::instrumentation::snapshot());
+    }
+    if (!opts.hardware_path.empty()) {
+      std::ofstream out(opts.hardware_path);
+      if (!out) throw std::runtime_error("Can not open " + opts.hardware_path);
+      math::instrumentation::dump_hardware_json(
+          out, math::instrumentation::hardware_snapshot());
+    }
+  } catch (const std::exception& e) {
+    std::cerr << argv[0] << ": " << e.what() << std::endl;
+    bench::print_usage(std::cerr, argv[0]);
+    return 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,763 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "../math_blas.h"
+#include "../math_factorization.h"
+#include "../math_functions.h"
+#include "../math_inverse_update.h"
+#include "../math_matrix.h"
+#include "../math_norm.h"
+#include "../math_strassen.h"
+#include "../math_structured.h"
+#include "../math_vector.h"
+#include "bench.h"
+
+namespace bench {
+
+namespace {
+
+// Bytes of one element, work estimates count compulsory memory traffic only
+constexpr double kElement = sizeof(double);
+
+math::vector random_vector(std::size_t n, unsigned seed) {
+  std::mt19937_64 generator(seed);
+  std::uniform_real_distribution<double> distribution(-1, 1);
+
+  math::vector result(n);
+  for (auto& el : result) el = distribution(generator);
+  return result;
+}
+
+math::matrix random_matrix(std::size_t rows, std::size_t columns,
+                           unsigned seed) {
+  std::mt19937_64 generator(seed);
+  std::uniform_real_distribution<double> distribution(-1, 1);
+
+  math::matrix result(rows, columns);
+  for (auto& el : result) el = distribution(generator);
+  return result;
+}
+
+// Diagonally dominant, so it is far from singular and needs no pivoting
+math::matrix well_conditioned(std::size_t n, unsigned seed) {
+  math::matrix result = random_matrix(n, n, seed);
+  for (std::size_t i = 0; i < n; ++i) result(i, i) += double(n);
+  return result;
+}
+
+math::matrix symmetric_positive_definite(std::size_t n, unsigned seed) {
+  math::matrix result = well_conditioned(n, seed);
+  return result + result.transposed();
+}
+
+double cube(std::size_t n) { return double(n) * double(n) * double(n); }
+
+double square(std::size_t n) { return double(n) * double(n); }
+
+using vector_ptr = std::shared_ptr<math::vector>;
+using matrix_ptr = std::shared_ptr<math::matrix>;
+
+vector_ptr make_vector(std::size_t n, unsigned seed) {
+  return std::make_shared<math::vector>(random_vector(n, seed));
+}
+
+matrix_ptr make_matrix(math::matrix m) {
+  return std::make_shared<math::matrix>(std::move(m));
+}
+
+using permutation_ptr = std::shared_ptr<std::vector<math::matrix::size_type>>;
+
+permutation_ptr make_permutation(std::size_t n, unsigned seed) {
+  auto result = std::make_shared<std::vector<math::matrix::size_type>>(n);
+  for (std::size_t i = 0; i < n; ++i) (*result)[i] = i;
+  std::shuffle(result->begin(), result->end(), std::mt19937_64(seed));
+  return result;
+}
+
+void register_vector_benchmarks(std::vector<benchmark>& list) {
+  list.push_back({"vector/construct", [](std::size_t n) {
+                    return workload{[n] { do_not_optimize(math::vector(n)); },
+                                    0, kElement * n};
+                  }});
+  list.push_back({"vector/copy", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(math::vector(*x)); },
+                                    0, 2 * kElement * n};
+                  }});
+  list.push_back({"vector/at", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] {
+                                      double sum = 0;
+                                      for (std::size_t i = 0; i < x->size();
+                                           ++i) {
+                                        sum += x->at(i);
+                                      }
+                                      do_not_optimize(sum);
+                                    },
+                                    double(n), kElement * n};
+                  }});
+  list.push_back({"vector/iterate", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] {
+                                      double sum = 0;
+                                      for (double el : *x) sum += el;
+                                      do_not_optimize(sum);
+                                    },
+                                    double(n), kElement * n};
+                  }});
+  list.push_back({"vector/equal", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 1);
+                    return workload{[x, y] { do_not_optimize(*x == *y); }, 0,
+                                    2 * kElement * n};
+                  }});
+  list.push_back({"vector/add_assign", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { *y += *x; }, double(n),
+                                    3 * kElement * n};
+                  }});
+  list.push_back({"vector/sub_assign", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { *y -= *x; }, double(n),
+                                    3 * kElement * n};
+                  }});
+  list.push_back({"vector/scale_assign", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { *x *= 1.0000001; }, double(n),
+                                    2 * kElement * n};
+                  }});
+  list.push_back({"vector/div_assign", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { *x /= 1.0000001; }, double(n),
+                                    2 * kElement * n};
+                  }});
+  list.push_back({"vector/add", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { do_not_optimize(*x + *y); },
+                                    double(n), 3 * kElement * n};
+                  }});
+  list.push_back({"vector/sub", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { do_not_optimize(*x - *y); },
+                                    double(n), 3 * kElement * n};
+                  }});
+  list.push_back({"vector/scale", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(*x * 2.0); },
+                                    double(n), 2 * kElement * n};
+                  }});
+  list.push_back({"vector/scale_left", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(2.0 * *x); },
+                                    double(n), 2 * kElement * n};
+                  }});
+  list.push_back({"vector/div", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(*x / 2.0); },
+                                    double(n), 2 * kElement * n};
+                  }});
+  list.push_back({"vector/dot", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { do_not_optimize(*x * *y); },
+                                    2.0 * n, 2 * kElement * n};
+                  }});
+  list.push_back({"vector/resize_grow_shrink", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x, n] {
+                                      x->resize(n + 1);
+                                      x->resize(n);
+                                    },
+                                    0, kElement};
+                  }});
+  list.push_back({"vector/extend_shrink", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x, n] {
+                                      x->extend(n + 1);
+                                      x->resize(n);
+                                    },
+                                    0, kElement};
+                  }});
+  list.push_back({"vector/abs", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(x->abs()); },
+                                    2.0 * n, kElement * n};
+                  }});
+  list.push_back({"vector/output", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] {
+                                      std::ostringstream out;
+                                      out << *x;
+                                      do_not_optimize(out);
+                                    },
+                                    0, kElement * n};
+                  }});
+  list.push_back({"vector/input", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    std::ostringstream text;
+                    for (double el : *x) text << el << ' ';
+                    auto in = std::make_shared<std::istringstream>(text.str());
+                    return workload{[x, in] {
+                                      in->clear();
+                                      in->seekg(0);
+                                      *in >> *x;
+                                    },
+                                    0, kElement * n};
+                  }});
+}
+
+void register_blas_benchmarks(std::vector<benchmark>& list) {
+  list.push_back({"blas/axpy", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { math::axpy(1e-7, *x, *y); },
+                                    2.0 * n, 3 * kElement * n};
+                  }});
+  list.push_back({"blas/fused_axpy4", [](std::size_t n) {
+                    auto y = make_vector(n, 1);
+                    auto xs = std::make_shared<std::vector<math::vector>>();
+                    for (unsigned k = 0; k < 4; ++k) {
+                      xs->push_back(random_vector(n, k + 2));
+                    }
+                    return workload{
+                        [xs, y] {
+                          math::fused_axpy({1e-7, 2e-7, 3e-7, 4e-7},
+                                           {(*xs)[0], (*xs)[1], (*xs)[2],
+                                            (*xs)[3]},
+                                           *y);
+                        },
+                        8.0 * n, 6 * kElement * n};
+                  }});
+  list.push_back({"blas/scal", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { math::scal(1.0000001, *x); },
+                                    double(n), 2 * kElement * n};
+                  }});
+  list.push_back({"blas/dot", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{
+                        [x, y] { do_not_optimize(math::dot(*x, *y)); },
+                        2.0 * n, 2 * kElement * n};
+                  }});
+  list.push_back({"blas/compensated_dot", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] {
+                                      do_not_optimize(
+                                          math::compensated_dot(*x, *y));
+                                    },
+                                    2.0 * n, 2 * kElement * n};
+                  }});
+  list.push_back({"blas/fused_dot4", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    auto ys = std::make_shared<std::vector<math::vector>>();
+                    for (unsigned k = 0; k < 4; ++k) {
+                      ys->push_back(random_vector(n, k + 2));
+                    }
+                    return workload{[x, ys] {
+                                      do_not_optimize(math::fused_dot(
+                                          *x, {(*ys)[0], (*ys)[1], (*ys)[2],
+                                               (*ys)[3]}));
+                                    },
+                                    8.0 * n, 5 * kElement * n};
+                  }});
+  list.push_back({"blas/nrm2", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(math::nrm2(*x)); },
+                                    2.0 * n, kElement * n};
+                  }});
+  list.push_back({"blas/asum", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(math::asum(*x)); },
+                                    double(n), kElement * n};
+                  }});
+  list.push_back({"blas/iamax", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(math::iamax(*x)); },
+                                    double(n), kElement * n};
+                  }});
+  list.push_back({"blas/rot", [](std::size_t n) {
+                    auto x = make_vector(n, 1), y = make_vector(n, 2);
+                    return workload{[x, y] { math::rot(*x, *y, 0.6, 0.8); },
+                                    6.0 * n, 4 * kElement * n};
+                  }});
+  list.push_back({"norm/norm1", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{[x] { do_not_optimize(math::norm1(*x)); },
+                                    double(n), kElement * n};
+                  }});
+  list.push_back({"norm/norm_inf", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{
+                        [x] { do_not_optimize(math::norm_inf(*x)); },
+                        double(n), kElement * n};
+                  }});
+  list.push_back({"norm/norm_p3", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{
+                        [x] { do_not_optimize(math::norm(*x, 3)); },
+                        3.0 * n, 2 * kElement * n};
+                  }});
+}
+
+void register_matrix_benchmarks(std::vector<benchmark>& list) {
+  list.push_back({"matrix/construct", [](std::size_t n) {
+                    return workload{
+                        [n] { do_not_optimize(math::matrix(n, n)); }, 0,
+                        kElement * square(n)};
+                  }});
+  list.push_back({"matrix/identity", [](std::size_t n) {
+                    return workload{[n] { do_not_optimize(math::matrix(n)); },
+                                    0, kElement * square(n)};
+                  }});
+  list.push_back({"matrix/from_vector", [](std::size_t n) {
+                    auto x = make_vector(n, 1);
+                    return workload{
+                        [x] { do_not_optimize(math::matrix(*x, true)); }, 0,
+                        2 * kElement * n};
+                  }});
+  list.push_back({"matrix/copy", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(math::matrix(*a)); },
+                                    0, 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/element_access", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] {
+                                      double sum = 0;
+                                      for (std::size_t i = 0; i < a->rows();
+                                           ++i) {
+                                        for (std::size_t j = 0;
+                                             j < a->columns(); ++j) {
+                                          sum += (*a)(i, j);
+                                        }
+                                      }
+                                      do_not_optimize(sum);
+                                    },
+                                    square(n), kElement * square(n)};
+                  }});
+  list.push_back({"matrix/iterate", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] {
+                                      double sum = 0;
+                                      for (double el : *a) sum += el;
+                                      do_not_optimize(sum);
+                                    },
+                                    square(n), kElement * square(n)};
+                  }});
+  list.push_back({"matrix/equal", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a, b] { do_not_optimize(*a == *b); }, 0,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/add_assign", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] { *a += *b; }, square(n),
+                                    3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/sub_assign", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] { *a -= *b; }, square(n),
+                                    3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/mul_assign", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] {
+                                      math::matrix c(*a);
+                                      c *= *b;
+                                      do_not_optimize(c);
+                                    },
+                                    2 * cube(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/scale_assign", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { *a *= 1.0000001; }, square(n),
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/div_assign", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { *a /= 1.0000001; }, square(n),
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/add", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] { do_not_optimize(*a + *b); },
+                                    square(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/sub", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] { do_not_optimize(*a - *b); },
+                                    square(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/mul", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] { do_not_optimize(*a * *b); },
+                                    2 * cube(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/mul_strassen", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    // low crossover so benchmark sizes take the recursion
+                    return workload{[a, b] {
+                                      math::strassen_options saved =
+                                          math::get_strassen_options();
+                                      math::strassen_options options;
+                                      options.enabled = true;
+                                      options.crossover = 128;
+                                      math::set_strassen_options(options);
+                                      do_not_optimize(*a * *b);
+                                      math::set_strassen_options(saved);
+                                    },
+                                    2 * cube(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/scale", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(*a * 2.0); },
+                                    square(n), 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/scale_left", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(2.0 * *a); },
+                                    square(n), 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/div", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(*a / 2.0); },
+                                    square(n), 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/transposed", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(a->transposed()); },
+                                    0, 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/transposed_op", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(!*a); }, 0,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/minor_matrix", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n + 1, n + 1, 1));
+                    return workload{
+                        [a] { do_not_optimize(a->minor_matrix(0, 0)); }, 0,
+                        2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/upper_triangle", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{
+                        [a] { do_not_optimize(a->upper_triangle_matrix()); },
+                        2 * cube(n) / 3, 2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/determinant", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{
+                        [a] { do_not_optimize(a->determinant()); },
+                        2 * cube(n) / 3, kElement * square(n)};
+                  }});
+  list.push_back({"matrix/complements_matrix", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{
+                        [a] { do_not_optimize(a->complements_matrix()); },
+                        square(n) * 2 * cube(n - 1) / 3,
+                        2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/complements_op", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{[a] { do_not_optimize(**a); },
+                                    square(n) * 2 * cube(n - 1) / 3,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/inverse", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{[a] { do_not_optimize(a->inverse()); },
+                                    square(n) * 2 * cube(n - 1) / 3,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/inverse_op", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{[a] { do_not_optimize(~*a); },
+                                    square(n) * 2 * cube(n - 1) / 3,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/negate", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(-*a); }, square(n),
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/unary_plus", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(+*a); }, 0,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/set_rows_grow_shrink", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a, n] {
+                                      a->set_rows(n + 1);
+                                      a->set_rows(n);
+                                    },
+                                    0, 4 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/set_columns_grow_shrink", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a, n] {
+                                      a->set_columns(n + 1);
+                                      a->set_columns(n);
+                                    },
+                                    0, 4 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/swap_rows", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a, n] { a->swap_rows(0, n - 1); }, 0,
+                                    4 * kElement * n};
+                  }});
+  list.push_back({"matrix/swap_columns", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a, n] { a->swap_columns(0, n - 1); }, 0,
+                                    4 * kElement * n};
+                  }});
+  list.push_back({"matrix/permute_rows", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto p = make_permutation(n, 2);
+                    return workload{[a, p] { a->permute_rows(*p); }, 0,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/permute_columns", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto p = make_permutation(n, 2);
+                    return workload{[a, p] { a->permute_columns(*p); }, 0,
+                                    2 * kElement * square(n)};
+                  }});
+  list.push_back({"matrix/block", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    std::size_t h = (n + 1) / 2;
+                    return workload{[a, h, n] {
+                                      do_not_optimize(
+                                          a->block(n / 4, n / 4, h, h));
+                                    },
+                                    0, 2 * kElement * square(h)};
+                  }});
+  list.push_back({"matrix/set_block", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    std::size_t h = (n + 1) / 2;
+                    auto b = make_matrix(random_matrix(h, h, 2));
+                    return workload{
+                        [a, b, n] { a->set_block(n / 4, n / 4, *b); }, 0,
+                        2 * kElement * square(h)};
+                  }});
+  list.push_back({"matrix/reshape", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, 2 * n, 1));
+                    return workload{[a, n] {
+                                      a->reshape(2 * n, n);
+                                      a->reshape(n, 2 * n);
+                                    },
+                                    0, 0};
+                  }});
+  list.push_back({"matrix/output", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] {
+                                      std::ostringstream out;
+                                      out << *a;
+                                      do_not_optimize(out);
+                                    },
+                                    0, kElement * square(n)};
+                  }});
+  list.push_back({"matrix/input", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    std::ostringstream text;
+                    for (double el : *a) text << el << ' ';
+                    auto in = std::make_shared<std::istringstream>(text.str());
+                    return workload{[a, in] {
+                                      in->clear();
+                                      in->seekg(0);
+                                      *in >> *a;
+                                    },
+                                    0, kElement * square(n)};
+                  }});
+}
+
+void register_linear_algebra_benchmarks(std::vector<benchmark>& list) {
+  list.push_back({"blas/gemv", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto x = make_vector(n, 2), y = make_vector(n, 3);
+                    return workload{
+                        [a, x, y] { math::gemv(1, *a, *x, 0, *y); },
+                        2 * square(n), kElement * (square(n) + 2 * n)};
+                  }});
+  list.push_back({"blas/ger", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto x = make_vector(n, 2), y = make_vector(n, 3);
+                    return workload{
+                        [a, x, y] { math::ger(1e-7, *x, *y, *a); },
+                        2 * square(n), 2 * kElement * square(n)};
+                  }});
+  list.push_back({"blas/outer", [](std::size_t n) {
+                    auto x = make_vector(n, 2), y = make_vector(n, 3);
+                    return workload{
+                        [x, y] { do_not_optimize(math::outer(*x, *y)); },
+                        square(n), kElement * square(n)};
+                  }});
+  list.push_back({"norm/frobenius", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{
+                        [a] { do_not_optimize(math::norm_frobenius(*a)); },
+                        2 * square(n), kElement * square(n)};
+                  }});
+  list.push_back({"norm/matrix_norm1", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{[a] { do_not_optimize(math::norm1(*a)); },
+                                    square(n), kElement * square(n)};
+                  }});
+  list.push_back({"norm/matrix_norm_inf", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    return workload{
+                        [a] { do_not_optimize(math::norm_inf(*a)); },
+                        square(n), kElement * square(n)};
+                  }});
+  list.push_back({"lu/factorize", [](std::size_t n) {
+                    auto a = make_matrix(well_conditioned(n, 1));
+                    return workload{
+                        [a] { do_not_optimize(math::lu_factorization(*a)); },
+                        2 * cube(n) / 3, 2 * kElement * square(n)};
+                  }});
+  list.push_back({"lu/solve", [](std::size_t n) {
+                    auto lu = std::make_shared<math::lu_factorization>(
+                        well_conditioned(n, 1));
+                    auto b = make_vector(n, 2);
+                    return workload{[lu, b] { do_not_optimize(lu->solve(*b)); },
+                                    2 * square(n), kElement * square(n)};
+                  }});
+  list.push_back({"lu/update", [](std::size_t n) {
+                    auto lu = std::make_shared<math::lu_factorization>(
+                        well_conditioned(n, 1));
+                    auto u = make_vector(n, 2), v = make_vector(n, 3);
+                    *u *= 1e-9;
+                    return workload{[lu, u, v] { lu->update(*u, *v); },
+                                    4 * square(n), 2 * kElement * square(n)};
+                  }});
+  list.push_back({"cholesky/factorize", [](std::size_t n) {
+                    auto a = make_matrix(symmetric_positive_definite(n, 1));
+                    return workload{[a] {
+                                      do_not_optimize(
+                                          math::cholesky_factorization(*a));
+                                    },
+                                    cube(n) / 3, 2 * kElement * square(n)};
+                  }});
+  list.push_back({"cholesky/update", [](std::size_t n) {
+                    auto c = std::make_shared<math::cholesky_factorization>(
+                        symmetric_positive_definite(n, 1));
+                    auto x = make_vector(n, 2);
+                    *x *= 1e-9;
+                    return workload{[c, x] { c->update(*x); }, 4 * square(n),
+                                    kElement * square(n)};
+                  }});
+  list.push_back({"inverse/sherman_morrison", [](std::size_t n) {
+                    auto a = make_matrix(
+                        math::lu_factorization(well_conditioned(n, 1))
+                            .inverse());
+                    auto u = make_vector(n, 2), v = make_vector(n, 3);
+                    *u *= 1e-9;
+                    return workload{[a, u, v] {
+                                      math::sherman_morrison_update(*a, *u,
+                                                                    *v);
+                                    },
+                                    6 * square(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/kron", [](std::size_t n) {
+                    // about n x n result of 8 x 8 blocks
+                    std::size_t m = std::max<std::size_t>(1, n / 8);
+                    auto a = make_matrix(random_matrix(m, m, 1));
+                    auto b = make_matrix(random_matrix(8, 8, 2));
+                    return workload{
+                        [a, b] { do_not_optimize(math::kron(*a, *b)); },
+                        square(8 * m), kElement * square(8 * m)};
+                  }});
+  list.push_back({"structured/kron_multiply", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    auto x = make_vector(n * n, 3);
+                    return workload{[a, b, x] {
+                                      do_not_optimize(
+                                          math::kron_multiply(*a, *b, *x));
+                                    },
+                                    4 * cube(n), 4 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/hadamard_product", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{[a, b] {
+                                      do_not_optimize(
+                                          math::hadamard_product(*a, *b));
+                                    },
+                                    square(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/hadamard_division", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(well_conditioned(n, 2));
+                    return workload{[a, b] {
+                                      do_not_optimize(
+                                          math::hadamard_division(*a, *b));
+                                    },
+                                    square(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/hstack", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{
+                        [a, b] { do_not_optimize(math::hstack(*a, *b)); }, 0,
+                        4 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/vstack", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    return workload{
+                        [a, b] { do_not_optimize(math::vstack(*a, *b)); }, 0,
+                        4 * kElement * square(n)};
+                  }});
+  list.push_back({"structured/block_diag", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1));
+                    auto b = make_matrix(random_matrix(n, n, 2));
+                    // the zero blocks are written too
+                    return workload{
+                        [a, b] { do_not_optimize(math::block_diag(*a, *b)); },
+                        0, 6 * kElement * square(n)};
+                  }});
+  list.push_back({"functions/pow10", [](std::size_t n) {
+                    auto a = make_matrix(random_matrix(n, n, 1) * (1.0 / n));
+                    // three squarings and one product
+                    return workload{[a] { do_not_optimize(math::pow(*a, 10)); },
+                                    8 * cube(n), 3 * kElement * square(n)};
+                  }});
+  list.push_back({"functions/expm", [](std::size_t n) {
+                    // ||a||_1 about 2 needs a high degree but no squarings
+                    auto a = make_matrix(random_matrix(n, n, 1) * (4.0 / n));
+                    return workload{[a] { do_not_optimize(math::expm(*a)); },
+                                    12 * cube(n), 4 * kElement * square(n)};
+                  }});
+  list.push_back({"functions/expm_scaled", [](std::size_t n) {
+                    // ||a||_1 about 100 takes degree 13 and 5 squarings
+                    auto a = make_matrix(random_matrix(n, n, 1) * (200.0 / n));
+                    return workload{[a] { do_not_optimize(math::expm(*a)); },
+                                    24 * cube(n), 4 * kElement * square(n)};
+                  }});
+  list.push_back({"functions/expm_symmetric", [](std::size_t n) {
+                    auto a = make_matrix(symmetric_positive_definite(n, 1) *
+                                         (1.0 / n));
+                    return workload{[a] { do_not_optimize(math::expm(*a)); },
+                                    8 * cube(n), 4 * kElement * square(n)};
+                  }});
+}
+
+}  // namespace
+
+void register_benchmarks(std::vector<benchmark>& list) {
+  register_vector_benchmarks(list);
+  register_blas_benchmarks(list);
+  register_matrix_benchmarks(list);
+  register_linear_algebra_benchmarks(list);
+}
+
+}  // namespace bench
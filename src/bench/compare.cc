@@ -0,0 +1,328 @@
+#include "compare.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace bench {
+
+namespace {
+
+// Largest sample sizes for which the exact U distribution is computed
+constexpr std::size_t kExactLimit = 20;
+
+// Minimal JSON document model, enough to read files of write_json back
+struct json {
+  enum class kind { null, boolean, number, string, array, object };
+
+  kind type = kind::null;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  std::vector<json> array;
+  std::vector<std::pair<std::string, json>> object;
+
+  const json* find(const std::string& key) const {
+    for (const auto& member : object) {
+      if (member.first == key) return &member.second;
+    }
+    return nullptr;
+  }
+};
+
+class json_parser {
+ public:
+  explicit json_parser(std::string text) : text_(std::move(text)) {}
+
+  json parse() {
+    json result = value();
+    skip_spaces();
+    if (pos_ != text_.size()) fail("trailing characters");
+    return result;
+  }
+
+ private:
+  [[noreturn]] void fail(const std::string& what) const {
+    throw std::runtime_error("Malformed baseline at offset " +
+                             std::to_string(pos_) + ": " + what);
+  }
+
+  void skip_spaces() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  char peek() {
+    skip_spaces();
+    if (pos_ == text_.size()) fail("unexpected end");
+    return text_[pos_];
+  }
+
+  void expect(char c) {
+    if (peek() != c) fail(std::string("expected '") + c + "'");
+    ++pos_;
+  }
+
+  bool literal(const std::string& word) {
+    if (text_.compare(pos_, word.size(), word) != 0) return false;
+    pos_ += word.size();
+    return true;
+  }
+
+  json value() {
+    json result;
+    char c = peek();
+    if (c == '{') {
+      result.type = json::kind::object;
+      expect('{');
+      while (peek() != '}') {
+        if (!result.object.empty()) expect(',');
+        std::string key = string();
+        expect(':');
+        result.object.emplace_back(std::move(key), value());
+      }
+      expect('}');
+    } else if (c == '[') {
+      result.type = json::kind::array;
+      expect('[');
+      while (peek() != ']') {
+        if (!result.array.empty()) expect(',');
+        result.array.push_back(value());
+      }
+      expect(']');
+    } else if (c == '"') {
+      result.type = json::kind::string;
+      result.string = string();
+    } else if (literal("true")) {
+      result.type = json::kind::boolean;
+      result.boolean = true;
+    } else if (literal("false")) {
+      result.type = json::kind::boolean;
+    } else if (literal("null")) {
+      result.type = json::kind::null;
+    } else {
+      result.type = json::kind::number;
+      const char* begin = text_.c_str() + pos_;
+      char* end = nullptr;
+      result.number = std::strtod(begin, &end);
+      if (end == begin) fail("unexpected character");
+      pos_ += std::size_t(end - begin);
+    }
+    return result;
+  }
+
+  std::string string() {
+    expect('"');
+    std::string result;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      if (text_[pos_] == '\\') ++pos_;
+      if (pos_ < text_.size()) result += text_[pos_++];
+    }
+    expect('"');
+    return result;
+  }
+
+  std::string text_;
+  std::size_t pos_ = 0;
+};
+
+const json& member(const json& object, const std::string& key) {
+  const json* found = object.find(key);
+  if (!found) throw std::runtime_error("Baseline entry misses " + key);
+  return *found;
+}
+
+// Average ranks of values of x and y pooled together; returns rank sum of x
+// and stores sum of t^3 - t over groups of t ties
+double rank_sum(const std::vector<double>& x, const std::vector<double>& y,
+                double* ties) {
+  std::vector<std::pair<double, bool>> pooled;
+  for (double v : x) pooled.emplace_back(v, true);
+  for (double v : y) pooled.emplace_back(v, false);
+  std::sort(pooled.begin(), pooled.end());
+
+  double sum = 0;
+  *ties = 0;
+  for (std::size_t first = 0; first < pooled.size();) {
+    std::size_t last = first;
+    while (last < pooled.size() && pooled[last].first == pooled[first].first) {
+      ++last;
+    }
+    double t = double(last - first);
+    double rank = (double(first + 1) + double(last)) / 2;
+    for (std::size_t i = first; i < last; ++i) {
+      if (pooled[i].second) sum += rank;
+    }
+    *ties += t * t * t - t;
+    first = last;
+  }
+  return sum;
+}
+
+// P(U <= u) under the null hypothesis for samples of sizes m and n
+double exact_cdf(std::size_t m, std::size_t n, std::size_t u) {
+  // counts[i][j][k]: orderings of i and j values with U statistic k
+  std::vector<std::vector<std::vector<double>>> counts(
+      m + 1, std::vector<std::vector<double>>(n + 1));
+  for (std::size_t i = 0; i <= m; ++i) {
+    for (std::size_t j = 0; j <= n; ++j) {
+      std::vector<double>& c = counts[i][j];
+      c.assign(i * j + 1, 0);
+      if (!i || !j) {
+        c[0] = 1;
+        continue;
+      }
+      // the largest value either comes from x (beating all j values of y)
+      // or from y
+      const std::vector<double>& from_x = counts[i - 1][j];
+      const std::vector<double>& from_y = counts[i][j - 1];
+      for (std::size_t k = 0; k < from_x.size(); ++k) c[k + j] += from_x[k];
+      for (std::size_t k = 0; k < from_y.size(); ++k) c[k] += from_y[k];
+    }
+  }
+
+  const std::vector<double>& c = counts[m][n];
+  double below = 0, total = 0;
+  for (std::size_t k = 0; k < c.size(); ++k) {
+    if (k <= u) below += c[k];
+    total += c[k];
+  }
+  return below / total;
+}
+
+const char* verdict_name(verdict status) {
+  switch (status) {
+    case verdict::improvement:
+      return "improvement";
+    case verdict::regression:
+      return "REGRESSION";
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+std::vector<result> read_json(std::istream& in) {
+  std::string text{std::istreambuf_iterator<char>(in),
+                   std::istreambuf_iterator<char>()};
+  json document = json_parser(std::move(text)).parse();
+
+  const json& benchmarks = member(document, "benchmarks");
+  if (benchmarks.type != json::kind::array) {
+    throw std::runtime_error("Baseline benchmarks is not an array");
+  }
+
+  std::vector<result> results;
+  for (const json& entry : benchmarks.array) {
+    result r;
+    r.name = member(entry, "name").string;
+    r.size = std::size_t(member(entry, "size").number);
+    if (const json* skipped = entry.find("skipped")) {
+      r.skipped = skipped->boolean;
+    }
+    if (!r.skipped) {
+      r.batch = std::size_t(member(entry, "batch").number);
+      r.flops = member(entry, "flops").number;
+      r.bytes = member(entry, "bytes").number;
+      for (const json& sample : member(entry, "samples_ns").array) {
+        r.samples_ns.push_back(sample.number);
+      }
+    }
+    results.push_back(std::move(r));
+  }
+  return results;
+}
+
+double mann_whitney_p(const std::vector<double>& x,
+                      const std::vector<double>& y) {
+  if (x.empty() || y.empty()) return 1;
+
+  double m = double(x.size()), n = double(y.size());
+  double ties = 0;
+  double u = rank_sum(x, y, &ties) - m * (m + 1) / 2;
+  double smaller = std::min(u, m * n - u);
+
+  if (ties == 0 && x.size() <= kExactLimit && y.size() <= kExactLimit) {
+    double p = 2 * exact_cdf(x.size(), y.size(), std::size_t(smaller));
+    return std::min(1.0, p);
+  }
+
+  double total = m + n;
+  double variance =
+      m * n / 12 * ((total + 1) - ties / (total * (total - 1)));
+  if (variance <= 0) return 1;
+
+  double z = (m * n / 2 - smaller - 0.5) / std::sqrt(variance);
+  return z <= 0 ? 1 : std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<comparison> compare(const std::vector<result>& baseline,
+                                const std::vector<result>& current,
+                                const options& opts) {
+  std::map<std::pair<std::string, std::size_t>, const result*> old;
+  for (const auto& r : baseline) {
+    if (!r.skipped) old[{r.name, r.size}] = &r;
+  }
+
+  std::vector<comparison> comparisons;
+  for (const auto& r : current) {
+    auto found = old.find({r.name, r.size});
+    if (r.skipped || found == old.end()) continue;
+
+    const result& base = *found->second;
+    comparison c;
+    c.name = r.name;
+    c.size = r.size;
+    c.baseline_ns = base.median_ns();
+    c.current_ns = r.median_ns();
+    c.change = c.baseline_ns > 0 ? c.current_ns / c.baseline_ns - 1 : 0;
+    c.p_value = mann_whitney_p(base.samples_ns, r.samples_ns);
+
+    if (c.p_value < opts.alpha && std::fabs(c.change) > opts.threshold) {
+      c.status = c.change > 0 ? verdict::regression : verdict::improvement;
+    }
+    comparisons.push_back(std::move(c));
+  }
+  return comparisons;
+}
+
+std::size_t print_comparison(std::ostream& out,
+                             const std::vector<comparison>& comparisons,
+                             const options& opts) {
+  out << '\n'
+      << std::left << std::setw(28) << "benchmark" << std::right
+      << std::setw(7) << "size" << std::setw(14) << "baseline ns"
+      << std::setw(14) << "current ns" << std::setw(10) << "change"
+      << std::setw(10) << "p-value" << "  verdict\n";
+
+  std::size_t regressions = 0, improvements = 0;
+  for (const auto& c : comparisons) {
+    out << std::left << std::setw(28) << c.name << std::right << std::setw(7)
+        << c.size << std::fixed << std::setprecision(1) << std::setw(14)
+        << c.baseline_ns << std::setw(14) << c.current_ns << std::showpos
+        << std::setw(9) << 100 * c.change << '%' << std::noshowpos
+        << std::setprecision(4) << std::setw(10) << c.p_value << "  "
+        << verdict_name(c.status) << std::defaultfloat << '\n';
+
+    if (c.status == verdict::regression) ++regressions;
+    if (c.status == verdict::improvement) ++improvements;
+  }
+
+  out << '\n'
+      << comparisons.size() << " compared, " << regressions
+      << " regressions, " << improvements << " improvements (threshold "
+      << 100 * opts.threshold << "%, alpha " << opts.alpha << ")"
+      << std::endl;
+  return regressions;
+}
+
+}  // namespace bench
@@ -0,0 +1,60 @@
+#ifndef CPP_MATH_LIBRARY_BENCH_COMPARE_H_
+#define CPP_MATH_LIBRARY_BENCH_COMPARE_H_
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+namespace bench {
+
+/**
+ * @brief Reads results written by write_json. Throws std::runtime_error if
+ * the document is malformed
+ *
+ */
+std::vector<result> read_json(std::istream& in);
+
+/**
+ * @brief Two-sided p-value of the Mann-Whitney U test that samples x and y
+ * come from the same distribution. Exact for small samples without ties,
+ * normal approximation with tie and continuity corrections otherwise
+ *
+ */
+double mann_whitney_p(const std::vector<double>& x,
+                      const std::vector<double>& y);
+
+enum class verdict { same, improvement, regression };
+
+// Change of one benchmark size between baseline and current run
+struct comparison {
+  std::string name;
+  std::size_t size = 0;
+  double baseline_ns = 0;
+  double current_ns = 0;
+  double change = 0;  // current / baseline - 1 of medians
+  double p_value = 1;
+  verdict status = verdict::same;
+};
+
+/**
+ * @brief Compares benchmarks present in both runs. A change is a regression
+ * or an improvement when medians differ by more than opts.threshold and the
+ * difference is significant at level opts.alpha
+ *
+ */
+std::vector<comparison> compare(const std::vector<result>& baseline,
+                                const std::vector<result>& current,
+                                const options& opts);
+
+// Prints comparison table and summary, returns number of regressions
+std::size_t print_comparison(std::ostream& out,
+                             const std::vector<comparison>& comparisons,
+                             const options& opts);
+
+}  // namespace bench
+
+#endif  // CPP_MATH_LIBRARY_BENCH_COMPARE_H_
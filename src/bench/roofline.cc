@@ -0,0 +1,271 @@
+#include "roofline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <map>
+#include <thread>
+#include <utility>
+
+#include "../math_parallel.h"
+
+namespace bench {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// Benchmarks swept when no filter is given
+const char* const kDefaultKernels[] = {"matrix/mul", "lu/factorize",
+                                       "cholesky/factorize"};
+
+// Independent accumulator chains of the multiply-add probe, enough to hide
+// the latency of the operation with the widest SIMD registers
+constexpr std::size_t kProbeLanes = 32;
+
+// Elements of every triad array, 32 MiB each, much larger than caches
+constexpr std::size_t kStreamElements = std::size_t(1) << 22;
+
+constexpr std::size_t kProbeRepetitions = 5;
+
+double multiply_add_chains(std::size_t iterations) {
+  double acc[kProbeLanes];
+  for (std::size_t j = 0; j < kProbeLanes; ++j) acc[j] = 1 + 1e-3 * double(j);
+
+  const double mul = 0.999999, add = 1e-6;
+  for (std::size_t i = 0; i < iterations; ++i) {
+    for (std::size_t j = 0; j < kProbeLanes; ++j) acc[j] = acc[j] * mul + add;
+  }
+
+  double sum = 0;
+  for (double value : acc) sum += value;
+  return sum;
+}
+
+// Best GFLOP/s of multiply-add chains run by every thread
+double measure_peak(std::size_t threads) {
+  // grow work until one thread runs long enough for a stable timing
+  std::size_t iterations = std::size_t(1) << 14;
+  for (;;) {
+    auto start = clock_type::now();
+    do_not_optimize(multiply_add_chains(iterations));
+    if (seconds_since(start) > 0.02) break;
+    iterations *= 2;
+  }
+
+  double best = 0;
+  for (std::size_t rep = 0; rep < kProbeRepetitions; ++rep) {
+    auto start = clock_type::now();
+    math::detail::parallel_for(threads, 1, [&](std::size_t, std::size_t) {
+      do_not_optimize(multiply_add_chains(iterations));
+    });
+    double seconds = seconds_since(start);
+    best = std::max(best, 2e-9 * double(kProbeLanes) * double(iterations) *
+                              double(threads) / seconds);
+  }
+  return best;
+}
+
+// Best GB/s of a[i] = b[i] + s * c[i], counting 24 bytes per element as
+// STREAM does
+double measure_bandwidth(std::size_t threads) {
+  std::vector<double> a(kStreamElements), b(kStreamElements),
+      c(kStreamElements);
+  std::size_t grain = math::detail::chunks_count(kStreamElements, threads);
+
+  // first touch by the threads that run the triad
+  math::detail::parallel_for(kStreamElements, grain,
+                             [&](std::size_t first, std::size_t last) {
+                               for (std::size_t i = first; i < last; ++i) {
+                                 a[i] = 0;
+                                 b[i] = 1;
+                                 c[i] = 2;
+                               }
+                             });
+
+  double best = 0;
+  const double scalar = 3;
+  for (std::size_t rep = 0; rep < 2 * kProbeRepetitions; ++rep) {
+    auto start = clock_type::now();
+    math::detail::parallel_for(kStreamElements, grain,
+                               [&](std::size_t first, std::size_t last) {
+                                 for (std::size_t i = first; i < last; ++i) {
+                                   a[i] = b[i] + scalar * c[i];
+                                 }
+                               });
+    double seconds = seconds_since(start);
+    do_not_optimize(a.front());
+    best = std::max(best, 24e-9 * double(kStreamElements) / seconds);
+  }
+  return best;
+}
+
+std::vector<std::size_t> default_thread_counts() {
+  std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::size_t> result;
+  for (std::size_t threads = 1; threads < hardware; threads *= 2) {
+    result.push_back(threads);
+  }
+  result.push_back(hardware);
+  return result;
+}
+
+bool selected(const benchmark& b, const options& opts) {
+  if (!opts.filter.empty()) {
+    return b.name.find(opts.filter) != std::string::npos;
+  }
+  return std::find(std::begin(kDefaultKernels), std::end(kDefaultKernels),
+                   b.name) != std::end(kDefaultKernels);
+}
+
+void print_limits(std::ostream& out, const machine_limits& limits) {
+  out << std::fixed << std::setprecision(2) << "threads " << limits.threads
+      << ": peak " << limits.peak_gflops << " GFLOP/s, bandwidth "
+      << limits.bandwidth_gbps << " GB/s, ridge "
+      << limits.peak_gflops / limits.bandwidth_gbps << " flop/byte"
+      << std::defaultfloat << std::endl;
+}
+
+void print_header(std::ostream& out) {
+  out << std::left << std::setw(22) << "benchmark" << std::right
+      << std::setw(7) << "size" << std::setw(8) << "threads" << std::setw(10)
+      << "GFLOP/s" << std::setw(11) << "attainable" << std::setw(10)
+      << "roofline" << std::setw(9) << "speedup" << std::setw(10) << "par.eff"
+      << '\n';
+}
+
+void print_row(std::ostream& out, const roofline_point& p) {
+  out << std::left << std::setw(22) << p.r.name << std::right << std::setw(7)
+      << p.r.size << std::setw(8) << p.limits.threads << std::fixed
+      << std::setprecision(2) << std::setw(10) << p.r.gflops()
+      << std::setw(11) << p.attainable_gflops() << std::setw(9)
+      << 100 * p.efficiency() << '%' << std::setw(9) << p.speedup
+      << std::setw(9) << 100 * p.parallel_efficiency() << '%'
+      << std::defaultfloat << std::endl;
+}
+
+}  // namespace
+
+machine_limits measure_machine_limits() {
+  machine_limits limits;
+  limits.threads = math::num_threads();
+  limits.peak_gflops = measure_peak(limits.threads);
+  limits.bandwidth_gbps = measure_bandwidth(limits.threads);
+  return limits;
+}
+
+double roofline_point::intensity() const {
+  return r.bytes > 0 ? r.flops / r.bytes : 0;
+}
+
+double roofline_point::attainable_gflops() const {
+  return std::min(limits.peak_gflops, intensity() * limits.bandwidth_gbps);
+}
+
+double roofline_point::efficiency() const {
+  double bound = attainable_gflops();
+  return bound > 0 ? r.gflops() / bound : 0;
+}
+
+double roofline_point::parallel_efficiency() const {
+  return speedup * double(base_threads) / double(limits.threads);
+}
+
+std::vector<roofline_point> run_roofline(const std::vector<benchmark>& list,
+                                         const options& opts,
+                                         std::ostream& out) {
+  std::vector<std::size_t> thread_counts = opts.thread_counts;
+  if (thread_counts.empty()) thread_counts = default_thread_counts();
+  std::sort(thread_counts.begin(), thread_counts.end());
+  thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()),
+                      thread_counts.end());
+
+  std::size_t saved_threads = math::num_threads();
+  std::vector<machine_limits> limits;
+  for (std::size_t threads : thread_counts) {
+    math::set_num_threads(threads);
+    limits.push_back(measure_machine_limits());
+    print_limits(out, limits.back());
+  }
+  out << '\n';
+  print_header(out);
+
+  std::vector<roofline_point> points;
+  for (const auto& b : list) {
+    if (!selected(b, opts)) continue;
+
+    for (std::size_t size : opts.sizes) {
+      double base_ns = 0;
+      for (std::size_t t = 0; t < thread_counts.size(); ++t) {
+        math::set_num_threads(thread_counts[t]);
+
+        roofline_point p;
+        p.r = measure(b, size, opts);
+        p.limits = limits[t];
+        p.base_threads = limits.front().threads;
+        if (t == 0) base_ns = p.r.median_ns();
+        p.speedup = p.r.median_ns() > 0 ? base_ns / p.r.median_ns() : 0;
+
+        print_row(out, p);
+        points.push_back(std::move(p));
+      }
+    }
+  }
+
+  math::set_num_threads(saved_threads);
+  return points;
+}
+
+void write_roofline_json(std::ostream& out,
+                         const std::vector<roofline_point>& points,
+                         const options& opts) {
+  std::time_t now = std::time(nullptr);
+  char date[32] = {};
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  // every threads count has its own limits, list them once
+  std::map<std::size_t, machine_limits> limits;
+  for (const auto& p : points) limits[p.limits.threads] = p.limits;
+
+  out << std::setprecision(17);
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+      << "    \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n"
+      << "    \"repetitions\": " << opts.repetitions << ",\n"
+      << "    \"warmup\": " << opts.warmup << "\n  },\n"
+      << "  \"limits\": [";
+
+  bool comma = false;
+  for (const auto& entry : limits) {
+    const machine_limits& l = entry.second;
+    out << (comma ? ",\n" : "\n") << "    {\"threads\": " << l.threads
+        << ", \"peak_gflops\": " << l.peak_gflops
+        << ", \"bandwidth_gbps\": " << l.bandwidth_gbps << "}";
+    comma = true;
+  }
+
+  out << "\n  ],\n  \"points\": [";
+  comma = false;
+  for (const auto& p : points) {
+    out << (comma ? ",\n" : "\n") << "    {\"name\": \"" << p.r.name
+        << "\", \"size\": " << p.r.size << ", \"threads\": " << p.limits.threads
+        << ", \"median_ns\": " << p.r.median_ns()
+        << ", \"p99_ns\": " << p.r.p99_ns() << ", \"gflops\": " << p.r.gflops()
+        << ", \"intensity\": " << p.intensity()
+        << ", \"attainable_gflops\": " << p.attainable_gflops()
+        << ", \"efficiency\": " << p.efficiency()
+        << ", \"speedup\": " << p.speedup
+        << ", \"parallel_efficiency\": " << p.parallel_efficiency() << "}";
+    comma = true;
+  }
+
+  out << "\n  ]\n}\n";
+}
+
+}  // namespace bench
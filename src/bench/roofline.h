@@ -0,0 +1,69 @@
+#ifndef CPP_MATH_LIBRARY_BENCH_ROOFLINE_H_
+#define CPP_MATH_LIBRARY_BENCH_ROOFLINE_H_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "bench.h"
+
+namespace bench {
+
+/**
+ * @brief Machine limits measured with the current threads count: multiply-add
+ * throughput of independent accumulators and STREAM-like triad bandwidth.
+ * Both are what code compiled with the library flags can reach.
+ *
+ */
+struct machine_limits {
+  std::size_t threads = 1;
+  double peak_gflops = 0;
+  double bandwidth_gbps = 0;
+};
+
+// Measures limits of math::num_threads() threads
+machine_limits measure_machine_limits();
+
+/**
+ * @brief Result of a kernel with given threads count placed on the roofline
+ * of the machine
+ *
+ */
+struct roofline_point {
+  result r;
+  machine_limits limits;
+  // speedup relative to the smallest measured threads count
+  std::size_t base_threads = 1;
+  double speedup = 0;
+
+  // Flops per byte of compulsory memory traffic
+  double intensity() const;
+
+  // Performance bound min(peak, intensity * bandwidth), GFLOP/s
+  double attainable_gflops() const;
+
+  // Achieved fraction of the attainable performance
+  double efficiency() const;
+
+  // Speedup divided by the ratio of threads counts
+  double parallel_efficiency() const;
+};
+
+/**
+ * @brief Sweeps sizes and thread counts of options over compute bound
+ * benchmarks (matrix product and factorizations unless filtered) and prints
+ * roofline efficiency and parallel speedup
+ *
+ */
+std::vector<roofline_point> run_roofline(const std::vector<benchmark>& list,
+                                         const options& opts,
+                                         std::ostream& out);
+
+// Writes roofline points as JSON document
+void write_roofline_json(std::ostream& out,
+                         const std::vector<roofline_point>& points,
+                         const options& opts);
+
+}  // namespace bench
+
+#endif  // CPP_MATH_LIBRARY_BENCH_ROOFLINE_H_
@@ -0,0 +1,164 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "../math_parallel.h"
+
+namespace bench {
+
+namespace {
+
+// Sizes parameter groups are tuned at: the product and LU are large enough
+// for panels to matter, transposition leaves the last level cache
+constexpr std::size_t kGemmSize = 512;
+constexpr std::size_t kTransposeSize = 2048;
+constexpr std::size_t kLuSize = 1024;
+
+const std::size_t kPanelColumns[] = {64, 128, 256, 512};
+const std::size_t kPanelDepths[] = {32, 64, 128, 256};
+const std::size_t kTransposeBlocks[] = {8, 16, 32, 64, 128};
+const std::size_t kLuBlocks[] = {16, 32, 64, 128, 256};
+const std::size_t kRowsGrains[] = {8, 16, 32, 64, 128};
+const std::size_t kLuGrains[] = {1 << 12, 1 << 13, 1 << 14,
+                                 1 << 15, 1 << 16, 1 << 17};
+
+using label_type = std::function<std::string(const math::tuning_parameters&)>;
+
+const benchmark& find(const std::vector<benchmark>& list,
+                      const std::string& name) {
+  for (const auto& b : list) {
+    if (b.name == name) return b;
+  }
+  throw std::runtime_error("Tuning needs benchmark " + name);
+}
+
+std::string key(const char* name, std::size_t value) {
+  return std::string(name) + "=" + std::to_string(value);
+}
+
+// Times b with every candidate set and leaves the fastest one set
+math::tuning_parameters fastest(
+    const std::vector<math::tuning_parameters>& candidates, const benchmark& b,
+    std::size_t size, const options& opts, const label_type& label,
+    std::ostream& out) {
+  out << b.name << ' ' << size << ", " << math::num_threads()
+      << " threads\n";
+
+  math::tuning_parameters best = math::tuning();
+  double best_ns = std::numeric_limits<double>::infinity();
+  for (const auto& candidate : candidates) {
+    math::set_tuning(candidate);
+    double ns = measure(b, size, opts).median_ns();
+    out << "  " << std::left << std::setw(40) << label(candidate) << std::right
+        << std::fixed << std::setprecision(3) << std::setw(12) << ns * 1e-6
+        << " ms" << std::defaultfloat << std::endl;
+    if (ns < best_ns) {
+      best_ns = ns;
+      best = candidate;
+    }
+  }
+
+  math::set_tuning(best);
+  out << "  best: " << label(best) << "\n\n";
+  return best;
+}
+
+// Candidates differing from base in one parameter
+std::vector<math::tuning_parameters> vary(
+    const math::tuning_parameters& base,
+    std::size_t math::tuning_parameters::*member,
+    const std::vector<std::size_t>& values) {
+  std::vector<math::tuning_parameters> result;
+  for (std::size_t value : values) {
+    result.push_back(base);
+    result.back().*member = value;
+  }
+  return result;
+}
+
+template <std::size_t N>
+std::vector<std::size_t> values(const std::size_t (&array)[N]) {
+  return std::vector<std::size_t>(array, array + N);
+}
+
+}  // namespace
+
+math::tuning_parameters run_tuning(const std::vector<benchmark>& list,
+                                   const options& opts, std::ostream& out) {
+  const benchmark& gemm = find(list, "matrix/mul");
+  const benchmark& transpose = find(list, "matrix/transposed");
+  const benchmark& lu = find(list, "lu/factorize");
+
+  // --max-size shrinks all problems for a quick run
+  std::size_t limit = opts.sizes.empty() ? kTransposeSize : opts.sizes.back();
+  std::size_t threads = math::num_threads();
+
+  // start from defaults, not from a profile loaded at startup
+  math::tuning_parameters base;
+  math::set_tuning(base);
+
+  // blocking is about caches of one core, thread counts come later
+  math::set_num_threads(1);
+  std::vector<math::tuning_parameters> panels;
+  for (std::size_t columns : kPanelColumns) {
+    for (std::size_t depth : kPanelDepths) {
+      panels.push_back(base);
+      panels.back().gemm_columns = columns;
+      panels.back().gemm_depth = depth;
+    }
+  }
+  base = fastest(
+      panels, gemm, std::min(kGemmSize, limit), opts,
+      [](const math::tuning_parameters& p) {
+        return key("gemm_columns", p.gemm_columns) + " " +
+               key("gemm_depth", p.gemm_depth);
+      },
+      out);
+
+  base = fastest(
+      vary(base, &math::tuning_parameters::transpose_block,
+           values(kTransposeBlocks)),
+      transpose, std::min(kTransposeSize, limit), opts,
+      [](const math::tuning_parameters& p) {
+        return key("transpose_block", p.transpose_block);
+      },
+      out);
+
+  base = fastest(
+      vary(base, &math::tuning_parameters::lu_block, values(kLuBlocks)), lu,
+      std::min(kLuSize, limit), opts,
+      [](const math::tuning_parameters& p) {
+        return key("lu_block", p.lu_block);
+      },
+      out);
+
+  math::set_num_threads(threads);
+  if (threads == 1) {
+    out << "thread grains are not tuned with one thread\n\n";
+    return base;
+  }
+
+  base = fastest(
+      vary(base, &math::tuning_parameters::gemm_rows_grain,
+           values(kRowsGrains)),
+      gemm, std::min(kGemmSize, limit), opts,
+      [](const math::tuning_parameters& p) {
+        return key("gemm_rows_grain", p.gemm_rows_grain);
+      },
+      out);
+
+  return fastest(
+      vary(base, &math::tuning_parameters::lu_grain, values(kLuGrains)), lu,
+      std::min(kLuSize, limit), opts,
+      [](const math::tuning_parameters& p) {
+        return key("lu_grain", p.lu_grain);
+      },
+      out);
+}
+
+}  // namespace bench
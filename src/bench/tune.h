@@ -0,0 +1,26 @@
+#ifndef CPP_MATH_LIBRARY_BENCH_TUNE_H_
+#define CPP_MATH_LIBRARY_BENCH_TUNE_H_
+
+#include <ostream>
+#include <vector>
+
+#include "../math_tuning.h"
+#include "bench.h"
+
+namespace bench {
+
+/**
+ * @brief Searches tuning parameters of this machine one group at a time:
+ * GEMM panel sizes on one thread, then transpose tiles and LU panels, then
+ * thread grains if there are several threads. Every candidate is timed with
+ * the matrix/mul, matrix/transposed and lu/factorize benchmarks of list and
+ * the one with the lowest median wins. Prints timings as it goes and leaves
+ * the best parameters set.
+ *
+ */
+math::tuning_parameters run_tuning(const std::vector<benchmark>& list,
+                                   const options& opts, std::ostream& out);
+
+}  // namespace bench
+
+#endif  // CPP_MATH_LIBRARY_BENCH_TUNE_H_
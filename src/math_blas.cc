@@ -0,0 +1,451 @@
+#include "math_blas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_memory.h"
+#include "math_norm.h"
+#include "math_parallel.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+// Elements of y processed by all vectors of fused routines before moving on,
+// small enough to stay in L1 cache
+constexpr std::size_t kFusedBlock = 512;
+
+template <class L, class R>
+void check_sizes(const L& x, const R& y) {
+  if (x.size() != y.size()) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: x.size = " + std::to_string(x.size()) +
+        ", y.size = " + std::to_string(y.size())));
+  }
+}
+
+void check_update_sizes(matrix::size_type rows, matrix::size_type columns,
+                        const matrix& a) {
+  if (rows != a.rows() || columns != a.columns()) {
+    MATH_THROW(std::invalid_argument(
+        "Update sizes mismatch: rows = " + std::to_string(rows) +
+        ", a.rows = " + std::to_string(a.rows()) +
+        ", columns = " + std::to_string(columns) +
+        ", a.columns = " + std::to_string(a.columns())));
+  }
+}
+
+// Number of rows of a matrix with given columns processed by one thread
+std::size_t rows_grain(matrix::size_type columns) noexcept {
+  return std::max<std::size_t>(1, detail::kBlas1Grain / columns);
+}
+
+// Copies strided view into contiguous buffer if needed, returns pointer to
+// contiguous elements of x
+const double* contiguous_data(const_vector_view x,
+                              detail::buffer<double>& buffer) {
+  if (x.stride() == 1) return x.data();
+
+  buffer.resize(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) buffer[i] = x[i];
+  return buffer.data();
+}
+
+// Returns true if x shares storage with a
+bool overlaps(const_vector_view x, const matrix& a) noexcept {
+  if (!x.size()) return false;
+  std::less<const double*> less;
+  const double* first = std::min(&x[0], &x[x.size() - 1], less);
+  const double* last = std::max(&x[0], &x[x.size() - 1], less);
+  const double* a_last = a.data() + (a.rows() * a.columns() - 1);
+  return !less(last, a.data()) && !less(a_last, first);
+}
+
+// Returns contiguous elements of x, copied to buffer if x is strided or
+// shares storage with a matrix that is about to be written
+const double* private_data(const_vector_view x, const matrix& a,
+                           detail::buffer<double>& buffer) {
+  if (!overlaps(x, a)) return contiguous_data(x, buffer);
+
+  buffer.resize(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) buffer[i] = x[i];
+  return buffer.data();
+}
+
+template <class View>
+bool is_contiguous(const View& v) noexcept {
+  return v.stride() == 1;
+}
+
+}  // namespace
+
+vector_view row_view(matrix& m, matrix::size_type row) {
+  return vector_view(&m(row, 0), m.columns());
+}
+
+const_vector_view row_view(const matrix& m, matrix::size_type row) {
+  return const_vector_view(&m(row, 0), m.columns());
+}
+
+vector_view column_view(matrix& m, matrix::size_type column) {
+  return vector_view(&m(0, column), m.rows(), m.columns());
+}
+
+const_vector_view column_view(const matrix& m, matrix::size_type column) {
+  return const_vector_view(&m(0, column), m.rows(), m.columns());
+}
+
+void axpy(double alpha, const_vector_view x, vector_view y) {
+  MATH_INSTRUMENT_OP("axpy", 2.0 * y.size(), 24.0 * y.size(), y.size());
+  check_sizes(x, y);
+  if (alpha == 0) return;
+
+  if (!is_contiguous(x) || !is_contiguous(y)) {
+    for (std::size_t i = 0; i < y.size(); ++i) y[i] += alpha * x[i];
+    return;
+  }
+
+  if (x.data() == y.data()) {
+    scal(1 + alpha, y);
+    return;
+  }
+
+  detail::parallel_for(y.size(), detail::kBlas1Grain,
+                       [&](std::size_t first, std::size_t last) {
+                         detail::axpy_kernel(last - first, alpha,
+                                             x.data() + first,
+                                             y.data() + first);
+                       });
+}
+
+void fused_axpy(const std::vector<double>& alphas,
+                const std::vector<const_vector_view>& xs, vector_view y) {
+  MATH_INSTRUMENT_OP("fused_axpy", 2.0 * xs.size() * y.size(),
+                     8.0 * (xs.size() + 2) * y.size(), xs.size(), y.size());
+  if (alphas.size() != xs.size()) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: alphas.size = " + std::to_string(alphas.size()) +
+        ", xs.size = " + std::to_string(xs.size())));
+  }
+  for (const auto& x : xs) check_sizes(x, y);
+
+  auto block = [&](std::size_t first, std::size_t last) {
+    for (std::size_t k = 0; k < xs.size(); ++k) {
+      const_vector_view x = xs[k];
+      if (is_contiguous(x) && is_contiguous(y) && x.data() != y.data()) {
+        detail::axpy_kernel(last - first, alphas[k], x.data() + first,
+                            y.data() + first);
+      } else {
+        for (std::size_t i = first; i < last; ++i) y[i] += alphas[k] * x[i];
+      }
+    }
+  };
+
+  detail::parallel_for(y.size(), detail::kBlas1Grain,
+                       [&](std::size_t first, std::size_t last) {
+                         for (; first < last; first += kFusedBlock) {
+                           block(first, std::min(last, first + kFusedBlock));
+                         }
+                       });
+}
+
+void scal(double alpha, vector_view x) {
+  MATH_INSTRUMENT_OP("scal", x.size(), 16.0 * x.size(), x.size());
+  if (!is_contiguous(x)) {
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] *= alpha;
+    return;
+  }
+
+  detail::parallel_for(x.size(), detail::kBlas1Grain,
+                       [&](std::size_t first, std::size_t last) {
+                         detail::scal_kernel(last - first, alpha,
+                                             x.data() + first);
+                       });
+}
+
+double dot(const_vector_view x, const_vector_view y) {
+  MATH_INSTRUMENT_OP("dot", 2.0 * x.size(), 16.0 * x.size(), x.size());
+  check_sizes(x, y);
+
+  if (!is_contiguous(x) || !is_contiguous(y)) {
+    double result = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) result += x[i] * y[i];
+    return result;
+  }
+
+  return detail::parallel_sum(
+      x.size(), detail::kBlas1Grain, [&](std::size_t first, std::size_t last) {
+        return detail::dot_kernel(last - first, x.data() + first,
+                                  y.data() + first);
+      });
+}
+
+double compensated_dot(const_vector_view x, const_vector_view y) {
+  // TwoProduct and TwoSum of every element
+  MATH_INSTRUMENT_OP("compensated_dot", 25.0 * x.size(), 16.0 * x.size(),
+                     x.size());
+  check_sizes(x, y);
+
+  if (!is_contiguous(x) || !is_contiguous(y)) {
+    detail::buffer<double> x_copy(x.size()), y_copy(y.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      x_copy[i] = x[i];
+      y_copy[i] = y[i];
+    }
+    return compensated_dot(const_vector_view(x_copy.data(), x_copy.size()),
+                           const_vector_view(y_copy.data(), y_copy.size()));
+  }
+
+  std::size_t chunks = detail::chunks_count(x.size(), detail::kBlas1Grain);
+  std::vector<double> sums(chunks), errors(chunks);
+  detail::parallel_for(
+      x.size(), detail::kBlas1Grain, [&](std::size_t first, std::size_t last) {
+        std::size_t chunk = first / detail::kBlas1Grain;
+        sums[chunk] = detail::compensated_dot_kernel(
+            last - first, x.data() + first, y.data() + first, &errors[chunk]);
+      });
+
+  double sum = 0, error = 0;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    double chunk_error;
+    sum = detail::two_sum(sum, sums[chunk], &chunk_error);
+    error += chunk_error + errors[chunk];
+  }
+  return sum + error;
+}
+
+vector fused_dot(const_vector_view x,
+                 const std::vector<const_vector_view>& ys) {
+  MATH_INSTRUMENT_OP("fused_dot", 2.0 * ys.size() * x.size(),
+                     8.0 * (ys.size() + 1) * x.size(), ys.size(), x.size());
+  if (ys.empty()) {
+    MATH_THROW(std::invalid_argument("fused_dot needs at least one vector"));
+  }
+  for (const auto& y : ys) check_sizes(x, y);
+
+  std::size_t chunks = detail::chunks_count(x.size(), detail::kBlas1Grain);
+  std::vector<double> partials(chunks * ys.size());
+
+  detail::parallel_for(
+      x.size(), detail::kBlas1Grain, [&](std::size_t first, std::size_t last) {
+        double* partial =
+            partials.data() + first / detail::kBlas1Grain * ys.size();
+        for (; first < last; first += kFusedBlock) {
+          std::size_t block_last = std::min(last, first + kFusedBlock);
+          for (std::size_t k = 0; k < ys.size(); ++k) {
+            const_vector_view y = ys[k];
+            if (is_contiguous(x) && is_contiguous(y)) {
+              partial[k] += detail::dot_kernel(
+                  block_last - first, x.data() + first, y.data() + first);
+            } else {
+              for (std::size_t i = first; i < block_last; ++i) {
+                partial[k] += x[i] * y[i];
+              }
+            }
+          }
+        }
+      });
+
+  vector result(ys.size());
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    for (std::size_t k = 0; k < ys.size(); ++k) {
+      result[k] += partials[chunk * ys.size() + k];
+    }
+  }
+  return result;
+}
+
+double nrm2(const_vector_view x) { return norm2(x); }
+
+double asum(const_vector_view x) {
+  MATH_INSTRUMENT_OP("asum", x.size(), 8.0 * x.size(), x.size());
+  if (is_contiguous(x)) {
+    return detail::parallel_sum(x.size(), detail::kBlas1Grain,
+                                [&](std::size_t first, std::size_t last) {
+                                  return detail::asum_kernel(last - first,
+                                                             x.data() + first);
+                                });
+  }
+
+  double result = 0;
+  for (std::size_t i = 0; i < x.size(); ++i) result += std::fabs(x[i]);
+  return result;
+}
+
+std::size_t iamax(const_vector_view x) {
+  MATH_INSTRUMENT_OP("iamax", x.size(), 16.0 * x.size(), x.size());
+  // one pass like BLAS: the first NaN wins, ties keep the first position
+  std::size_t result = 0;
+  double max = -1;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    double value = std::fabs(x[i]);
+    if (std::isnan(value)) return i;
+    if (value > max) {
+      max = value;
+      result = i;
+    }
+  }
+  return result;
+}
+
+void rot(vector_view x, vector_view y, double c, double s) {
+  MATH_INSTRUMENT_OP("rot", 6.0 * x.size(), 32.0 * x.size(), x.size());
+  check_sizes(x, y);
+
+  if (!is_contiguous(x) || !is_contiguous(y) || x.data() == y.data()) {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      double xi = x[i], yi = y[i];
+      x[i] = c * xi + s * yi;
+      y[i] = c * yi - s * xi;
+    }
+    return;
+  }
+
+  detail::parallel_for(x.size(), detail::kBlas1Grain,
+                       [&](std::size_t first, std::size_t last) {
+                         detail::rot_kernel(last - first, x.data() + first,
+                                            y.data() + first, c, s);
+                       });
+}
+
+void gemv(double alpha, const matrix& a, const_vector_view x, double beta,
+          vector_view y, bool transpose) {
+  MATH_INSTRUMENT_OP("gemv", 2.0 * a.rows() * a.columns(),
+                     8.0 * (a.rows() * a.columns() + x.size() + 2 * y.size()),
+                     a.rows(), a.columns());
+  if (x.size() != (transpose ? a.rows() : a.columns()) ||
+      y.size() != (transpose ? a.columns() : a.rows())) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: a.rows = " + std::to_string(a.rows()) +
+        ", a.columns = " + std::to_string(a.columns()) +
+        ", x.size = " + std::to_string(x.size()) +
+        ", y.size = " + std::to_string(y.size())));
+  }
+
+  detail::buffer<double> x_buffer;
+  const double* x_data = contiguous_data(x, x_buffer);
+  std::size_t columns = a.columns();
+
+  if (!transpose) {
+    detail::parallel_for(a.rows(), rows_grain(columns),
+                         [&](std::size_t first, std::size_t last) {
+                           for (std::size_t i = first; i < last; ++i) {
+                             double product = detail::dot_kernel(
+                                 columns, a.data() + i * columns, x_data);
+                             y[i] = alpha * product +
+                                    (beta == 0 ? 0 : beta * y[i]);
+                           }
+                         });
+    return;
+  }
+
+  // a^T * x is a sum of rows of a, every thread owns a range of columns
+  detail::buffer<double> y_buffer(y.size());
+  for (std::size_t j = 0; j < y.size(); ++j) {
+    y_buffer[j] = beta == 0 ? 0 : beta * y[j];
+  }
+
+  std::size_t grain = std::max<std::size_t>(
+      kFusedBlock, detail::kBlas1Grain / std::max<std::size_t>(1, a.rows()));
+  detail::parallel_for(columns, grain,
+                       [&](std::size_t first, std::size_t last) {
+                         for (std::size_t i = 0; i < a.rows(); ++i) {
+                           detail::axpy_kernel(
+                               last - first, alpha * x_data[i],
+                               a.data() + i * columns + first,
+                               y_buffer.data() + first);
+                         }
+                       });
+
+  for (std::size_t j = 0; j < y.size(); ++j) y[j] = y_buffer[j];
+}
+
+matrix outer(const_vector_view u, const_vector_view v) {
+  MATH_INSTRUMENT_OP("outer", double(u.size()) * v.size(),
+                     8.0 * (u.size() * v.size() + u.size() + v.size()),
+                     u.size(), v.size());
+  if (!u.size() || !v.size()) {
+    MATH_THROW(std::invalid_argument("Outer product of empty vector"));
+  }
+
+  detail::buffer<double> buffer;
+  const double* MATH_RESTRICT y = contiguous_data(v, buffer);
+
+  matrix result(u.size(), v.size());
+  detail::parallel_for(u.size(), rows_grain(v.size()),
+                       [&](std::size_t first, std::size_t last) {
+                         for (std::size_t i = first; i < last; ++i) {
+                           double* MATH_RESTRICT row =
+                               result.data() + i * v.size();
+                           double scale = u[i];
+                           for (std::size_t j = 0; j < v.size(); ++j) {
+                             row[j] = scale * y[j];
+                           }
+                         }
+                       });
+  return result;
+}
+
+void ger(double alpha, const_vector_view x, const_vector_view y, matrix& a) {
+  MATH_INSTRUMENT_OP("ger", 2.0 * a.rows() * a.columns(),
+                     16.0 * a.rows() * a.columns(), a.rows(), a.columns());
+  check_update_sizes(x.size(), y.size(), a);
+  if (alpha == 0) return;
+
+  // x or y may be a row or column of a, rows of a are rewritten concurrently
+  detail::buffer<double> x_buffer, y_buffer;
+  if (overlaps(x, a)) x = {private_data(x, a, x_buffer), x.size()};
+  const double* MATH_RESTRICT row_update = private_data(y, a, y_buffer);
+
+  detail::parallel_for(a.rows(), rows_grain(a.columns()),
+                       [&](std::size_t first, std::size_t last) {
+                         for (std::size_t i = first; i < last; ++i) {
+                           detail::axpy_kernel(a.columns(), alpha * x[i],
+                                               row_update,
+                                               a.data() + i * a.columns());
+                         }
+                       });
+}
+
+void rank_k_update(double alpha, const matrix& u, const matrix& v,
+                   matrix& a) {
+  MATH_INSTRUMENT_OP(
+      "rank_k_update", 2.0 * a.rows() * a.columns() * u.columns(),
+      8.0 * (2 * a.rows() * a.columns() + (u.rows() + v.rows()) * u.columns()),
+      a.rows(), a.columns(), u.columns());
+  if (u.columns() != v.columns()) {
+    MATH_THROW(std::invalid_argument(
+        "Inner sizes mismatch: u.columns = " + std::to_string(u.columns()) +
+        ", v.columns = " + std::to_string(v.columns())));
+  }
+  check_update_sizes(u.rows(), v.rows(), a);
+  if (alpha == 0) return;
+
+  // rows of v^T are the contiguous vectors added to every row of a
+  matrix v_transposed = v.transposed();
+  std::size_t k = u.columns(), columns = a.columns();
+
+  detail::parallel_for(
+      a.rows(), rows_grain(columns), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          double* row = a.data() + i * columns;
+          const double* coefficients = u.data() + i * k;
+          for (std::size_t block = 0; block < columns; block += kFusedBlock) {
+            std::size_t size = std::min(kFusedBlock, columns - block);
+            for (std::size_t p = 0; p < k; ++p) {
+              detail::axpy_kernel(size, alpha * coefficients[p],
+                                  v_transposed.data() + p * columns + block,
+                                  row + block);
+            }
+          }
+        }
+      });
+}
+
+}  // namespace math
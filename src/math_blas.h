@@ -0,0 +1,200 @@
+#ifndef CPP_MATH_LIBRARY_MATH_BLAS_H_
+#define CPP_MATH_LIBRARY_MATH_BLAS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "math_matrix.h"
+#include "math_vector.h"
+
+namespace math {
+
+/**
+ * @brief Non-owning strided view of size elements data[0], data[stride], ...
+ * Used to pass vectors, matrix rows and matrix columns to BLAS routines
+ * without copying.
+ *
+ */
+class vector_view {
+ public:
+  using value_type = double;
+  using pointer = value_type*;
+  using reference = value_type&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  vector_view(pointer data, size_type size,
+              difference_type stride = 1) noexcept
+      : data_(data), size_(size), stride_(stride) {}
+
+  // Contiguous view of the whole vector
+  vector_view(vector& v) noexcept : vector_view(v.data(), v.size()) {}
+
+  pointer data() const noexcept { return data_; }
+
+  size_type size() const noexcept { return size_; }
+
+  difference_type stride() const noexcept { return stride_; }
+
+  // Get element without bounds checking
+  reference operator[](size_type pos) const noexcept {
+    return data_[difference_type(pos) * stride_];
+  }
+
+ private:
+  pointer data_;
+  size_type size_;
+  difference_type stride_;
+};
+
+/**
+ * @brief Read-only version of vector_view.
+ *
+ */
+class const_vector_view {
+ public:
+  using value_type = double;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  const_vector_view(pointer data, size_type size,
+                    difference_type stride = 1) noexcept
+      : data_(data), size_(size), stride_(stride) {}
+
+  // Contiguous view of the whole vector
+  const_vector_view(const vector& v) noexcept
+      : const_vector_view(v.data(), v.size()) {}
+
+  const_vector_view(const vector_view& v) noexcept
+      : const_vector_view(v.data(), v.size(), v.stride()) {}
+
+  pointer data() const noexcept { return data_; }
+
+  size_type size() const noexcept { return size_; }
+
+  difference_type stride() const noexcept { return stride_; }
+
+  // Get element without bounds checking
+  reference operator[](size_type pos) const noexcept {
+    return data_[difference_type(pos) * stride_];
+  }
+
+ private:
+  pointer data_;
+  size_type size_;
+  difference_type stride_;
+};
+
+/**
+ * @brief Returns view of matrix row. Throws std::out_of_range if row >= rows
+ *
+ */
+vector_view row_view(matrix& m, matrix::size_type row);
+const_vector_view row_view(const matrix& m, matrix::size_type row);
+
+/**
+ * @brief Returns view of matrix column. Throws std::out_of_range if column >=
+ * columns
+ *
+ */
+vector_view column_view(matrix& m, matrix::size_type column);
+const_vector_view column_view(const matrix& m, matrix::size_type column);
+
+// Level-1 BLAS routines. Long contiguous vectors are processed by several
+// threads (see set_num_threads). Routines with two vectors throw
+// std::invalid_argument if their sizes are not equal; x and y must not overlap.
+
+// y = alpha * x + y
+void axpy(double alpha, const_vector_view x, vector_view y);
+
+/**
+ * @brief y = alphas[0] * xs[0] + ... + alphas[k - 1] * xs[k - 1] + y in a
+ * single pass over y. Throws std::invalid_argument if alphas and xs have
+ * different sizes.
+ *
+ */
+void fused_axpy(const std::vector<double>& alphas,
+                const std::vector<const_vector_view>& xs, vector_view y);
+
+// x = alpha * x
+void scal(double alpha, vector_view x);
+
+// Returns x^T * y
+double dot(const_vector_view x, const_vector_view y);
+
+/**
+ * @brief Returns x^T * y computed with compensated (Dot2) summation: the
+ * result is as accurate as if computed in twice the working precision and
+ * then rounded, for about 3-4 times the cost of dot
+ *
+ */
+double compensated_dot(const_vector_view x, const_vector_view y);
+
+/**
+ * @brief Returns vector of x^T * ys[i] computed in a single pass over x.
+ * Throws std::invalid_argument if ys is empty.
+ *
+ */
+vector fused_dot(const_vector_view x, const std::vector<const_vector_view>& ys);
+
+// Returns euclidean norm of x without intermediate overflow or underflow
+double nrm2(const_vector_view x);
+
+// Returns sum of absolute values of x
+double asum(const_vector_view x);
+
+/**
+ * @brief Returns position of the first element with maximum absolute value,
+ * or of the first NaN if there is one. 0 for an empty view.
+ *
+ */
+std::size_t iamax(const_vector_view x);
+
+/**
+ * @brief Applies plane rotation: x[i], y[i] = c * x[i] + s * y[i],
+ * c * y[i] - s * x[i]
+ *
+ */
+void rot(vector_view x, vector_view y, double c, double s);
+
+// Level-2 routines
+
+/**
+ * @brief y = alpha * a * x + beta * y, or y = alpha * a^T * x + beta * y if
+ * transpose is true. Throws std::invalid_argument if sizes mismatch; x and y
+ * must not overlap a
+ *
+ */
+void gemv(double alpha, const matrix& a, const_vector_view x, double beta,
+          vector_view y, bool transpose = false);
+
+// Rank updates. Every row of the updated matrix is streamed once, rows are
+// processed by several threads for large matrices. Matrices must not overlap
+// the updated matrix, vectors may: ger() copies them first.
+
+/**
+ * @brief Returns outer product u * v^T as u.size() x v.size() matrix. Throws
+ * std::invalid_argument if any of vectors is empty
+ *
+ */
+matrix outer(const_vector_view u, const_vector_view v);
+
+/**
+ * @brief Rank-1 update a = alpha * x * y^T + a. Throws std::invalid_argument
+ * if x.size() != a.rows() or y.size() != a.columns()
+ *
+ */
+void ger(double alpha, const_vector_view x, const_vector_view y, matrix& a);
+
+/**
+ * @brief Rank-k update a = alpha * u * v^T + a, where u is a.rows() x k and v
+ * is a.columns() x k. Throws std::invalid_argument if sizes mismatch
+ *
+ */
+void rank_k_update(double alpha, const matrix& u, const matrix& v, matrix& a);
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_BLAS_H_
@@ -0,0 +1,286 @@
+#include "math_cross_check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+using extended = long double;
+
+// Inputs with at most that many elements are printed by the default handler
+constexpr std::size_t kPrintedElements = 64;
+
+std::atomic<double> sampled_fraction{0};
+std::atomic<double> tolerance{kCrossCheckUlps};
+std::atomic<std::uint64_t> mismatches{0};
+
+std::mutex& handler_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+cross_check_handler& handler() {
+  static cross_check_handler function;
+  return function;
+}
+
+void print_mismatch(const cross_check_mismatch& m) {
+  std::cerr << "cross-check mismatch in " << m.operation << ": inputs";
+  for (const auto& input : m.inputs) {
+    std::cerr << ' ' << input.rows() << 'x' << input.columns();
+  }
+  auto precision = std::cerr.precision(17);
+  std::cerr << ", element " << m.index << " is " << m.actual << " instead of "
+            << m.expected << " (" << m.ulps << " ulps)\n";
+
+  for (std::size_t i = 0; i < m.inputs.size(); ++i) {
+    const matrix& input = m.inputs[i];
+    if (input.rows() * input.columns() <= kPrintedElements) {
+      std::cerr << "input " << i << ":\n" << input << '\n';
+    }
+  }
+  std::cerr.precision(precision);
+  std::cerr.flush();
+}
+
+void report(cross_check_mismatch mismatch) {
+  mismatches.fetch_add(1, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(handler_mutex());
+  if (handler()) {
+    handler()(mismatch);
+  } else {
+    print_mismatch(mismatch);
+  }
+}
+
+// Distance between value and the next representable number towards zero
+double ulp(double value) {
+  if (value == 0) return std::numeric_limits<double>::denorm_min();
+  return value - std::nextafter(value, 0.0);
+}
+
+// Reports the worst element of actual if it differs from expected by more
+// than the tolerance; inputs are built only then
+void compare(const char* operation, const double* actual,
+             const double* expected, std::size_t count,
+             const std::function<std::vector<matrix>()>& inputs) {
+  double scale = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (std::isfinite(expected[i])) {
+      scale = std::max(scale, std::fabs(expected[i]));
+    }
+  }
+  double unit = ulp(scale);
+
+  std::size_t worst = 0;
+  double worst_ulps = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (actual[i] == expected[i]) continue;
+    if (std::isnan(actual[i]) && std::isnan(expected[i])) continue;
+
+    double ulps = std::isfinite(actual[i]) && std::isfinite(expected[i])
+                      ? std::fabs(actual[i] - expected[i]) / unit
+                      : std::numeric_limits<double>::infinity();
+    if (ulps > worst_ulps) {
+      worst = i;
+      worst_ulps = ulps;
+    }
+  }
+  if (worst_ulps <= tolerance.load(std::memory_order_relaxed)) return;
+
+  cross_check_mismatch mismatch;
+  mismatch.operation = operation;
+  mismatch.inputs = inputs();
+  mismatch.index = worst;
+  mismatch.expected = expected[worst];
+  mismatch.actual = actual[worst];
+  mismatch.ulps = worst_ulps;
+  report(std::move(mismatch));
+}
+
+matrix row_matrix(const_vector_view x) {
+  matrix result(std::size_t(1), x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) result(0, i) = x[i];
+  return result;
+}
+
+// Reference p-norm in extended precision, scaled by the largest element
+double reference_norm(const_vector_view x, double p) {
+  extended max = 0;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (std::isnan(x[i])) return x[i];
+    max = std::max(max, std::fabs(extended(x[i])));
+  }
+  if (std::isinf(p) || max == 0 || std::isinf(max)) return double(max);
+
+  extended sum = 0;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    sum += std::pow(std::fabs(extended(x[i])) / max, extended(p));
+  }
+  return double(max * std::pow(sum, 1 / extended(p)));
+}
+
+}  // namespace
+
+void set_cross_check(double fraction, double tolerance_ulps) {
+  if (!(fraction >= 0 && fraction <= 1)) {
+    MATH_THROW(std::invalid_argument(
+        "Cross-check fraction must be in [0, 1], " + std::to_string(fraction) +
+        " given"));
+  }
+  if (!(tolerance_ulps >= 0)) {
+    MATH_THROW(
+        std::invalid_argument("Cross-check tolerance can not be negative"));
+  }
+  tolerance.store(tolerance_ulps, std::memory_order_relaxed);
+  sampled_fraction.store(fraction, std::memory_order_relaxed);
+}
+
+double cross_check_fraction() noexcept {
+  return sampled_fraction.load(std::memory_order_relaxed);
+}
+
+double cross_check_tolerance() noexcept {
+  return tolerance.load(std::memory_order_relaxed);
+}
+
+void set_cross_check_handler(cross_check_handler function) {
+  std::lock_guard<std::mutex> lock(handler_mutex());
+  handler() = std::move(function);
+}
+
+std::uint64_t cross_check_mismatches() noexcept {
+  return mismatches.load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+bool cross_check_sampled() noexcept {
+  double fraction = sampled_fraction.load(std::memory_order_relaxed);
+  if (fraction <= 0) return false;
+  if (fraction >= 1) return true;
+
+  thread_local std::minstd_rand generator(
+      unsigned(std::hash<std::thread::id>()(std::this_thread::get_id())));
+  return std::uniform_real_distribution<double>()(generator) < fraction;
+}
+
+void check_product(const matrix& a, const matrix& b, const matrix& product) {
+  matrix expected(a.rows(), b.columns());
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < b.columns(); ++j) {
+      double sum = 0;
+      for (std::size_t p = 0; p < a.columns(); ++p) sum += a(i, p) * b(p, j);
+      expected(i, j) = sum;
+    }
+  }
+
+  compare("matrix::operator*=(matrix)", product.data(), expected.data(),
+          a.rows() * b.columns(),
+          [&] { return std::vector<matrix>{a, b}; });
+}
+
+void check_transpose(const matrix& a, const matrix& transposed) {
+  matrix expected(a.columns(), a.rows());
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < a.columns(); ++j) expected(j, i) = a(i, j);
+  }
+
+  compare("matrix::transposed", transposed.data(), expected.data(),
+          a.rows() * a.columns(), [&] { return std::vector<matrix>{a}; });
+}
+
+void check_lu(const matrix& a, const matrix& packed,
+              const std::vector<std::size_t>& permutation) {
+  // unblocked right-looking elimination with partial pivoting
+  std::size_t n = a.rows();
+  matrix expected(a);
+  std::vector<std::size_t> rows(n);
+  for (std::size_t i = 0; i < n; ++i) rows[i] = i;
+
+  for (std::size_t k = 0; k < n; ++k) {
+    std::size_t pivot = k;
+    for (std::size_t i = k + 1; i < n; ++i) {
+      if (std::fabs(expected(i, k)) > std::fabs(expected(pivot, k))) pivot = i;
+    }
+    if (expected(pivot, k) == 0) break;
+
+    for (std::size_t j = 0; j < n; ++j) {
+      std::swap(expected(k, j), expected(pivot, j));
+    }
+    std::swap(rows[k], rows[pivot]);
+
+    double inverse_pivot = 1 / expected(k, k);
+    for (std::size_t i = k + 1; i < n; ++i) {
+      expected(i, k) *= inverse_pivot;
+      for (std::size_t j = k + 1; j < n; ++j) {
+        expected(i, j) -= expected(i, k) * expected(k, j);
+      }
+    }
+  }
+
+  auto inputs = [&] { return std::vector<matrix>{a}; };
+  if (rows != permutation) {
+    // different pivots make factors incomparable
+    std::size_t first = 0;
+    while (rows[first] == permutation[first]) ++first;
+
+    cross_check_mismatch mismatch;
+    mismatch.operation = "lu_factorization::factorize";
+    mismatch.inputs = inputs();
+    mismatch.index = first;
+    mismatch.expected = double(rows[first]);
+    mismatch.actual = double(permutation[first]);
+    mismatch.ulps = std::numeric_limits<double>::infinity();
+    report(std::move(mismatch));
+    return;
+  }
+
+  compare("lu_factorization::factorize", packed.data(), expected.data(),
+          n * n, inputs);
+}
+
+void check_norm(const char* operation, const_vector_view x, double p,
+                double actual) {
+  double expected = reference_norm(x, p);
+  compare(operation, &actual, &expected, 1,
+          [&] { return std::vector<matrix>{row_matrix(x)}; });
+}
+
+void check_matrix_norm(const char* operation, const matrix& m, double p,
+                       double actual) {
+  bool by_columns = p == 1;
+  std::size_t outer = by_columns ? m.columns() : m.rows();
+  std::size_t inner = by_columns ? m.rows() : m.columns();
+
+  extended expected = 0;
+  for (std::size_t i = 0; i < outer; ++i) {
+    extended sum = 0;
+    for (std::size_t j = 0; j < inner; ++j) {
+      sum += std::fabs(extended(by_columns ? m(j, i) : m(i, j)));
+    }
+    expected = std::max(expected, sum);
+  }
+
+  double rounded = double(expected);
+  compare(operation, &actual, &rounded, 1,
+          [&] { return std::vector<matrix>{m}; });
+}
+
+}  // namespace detail
+
+}  // namespace math
@@ -0,0 +1,94 @@
+#ifndef CPP_MATH_LIBRARY_MATH_CROSS_CHECK_H_
+#define CPP_MATH_LIBRARY_MATH_CROSS_CHECK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "math_blas.h"
+#include "math_matrix.h"
+
+// Cross-check mode recomputes results of optimized kernels (matrix product,
+// transposition, LU factorization, norms) with plain reference loops on a
+// sampled fraction of calls and reports results that differ by more than a
+// tolerance. It is off by default and costs one atomic load per call then.
+
+namespace math {
+
+// Default tolerance of cross-checks in units in the last place
+constexpr double kCrossCheckUlps = 64;
+
+/**
+ * @brief Result of an optimized kernel that differs from the reference.
+ * Differences are measured in ULPs of the largest absolute value of the
+ * reference result, so cancellation in small elements is not reported.
+ *
+ */
+struct cross_check_mismatch {
+  std::string operation;
+  std::vector<matrix> inputs;  // operands, vectors as one-row matrices
+  std::size_t index = 0;       // row-major position of the worst element
+  double expected = 0;         // reference value of that element
+  double actual = 0;           // optimized value of that element
+  double ulps = 0;             // infinity if LU pivots differ
+};
+
+using cross_check_handler = std::function<void(const cross_check_mismatch&)>;
+
+/**
+ * @brief Enables cross-checks of a random fraction of calls, 0 disables them
+ * and 1 checks every call. Throws std::invalid_argument if fraction is not in
+ * [0, 1] or tolerance is negative
+ *
+ * @param fraction probability that a call is checked
+ * @param tolerance_ulps largest difference that is not reported
+ */
+void set_cross_check(double fraction, double tolerance_ulps = kCrossCheckUlps);
+
+// Returns probability that a call is checked
+double cross_check_fraction() noexcept;
+
+// Returns largest difference in ULPs that is not reported
+double cross_check_tolerance() noexcept;
+
+/**
+ * @brief Sets function called with every mismatch, calls are serialized. The
+ * default handler (restored by an empty function) writes the mismatch with
+ * shapes of inputs to std::cerr, and small inputs themselves
+ *
+ */
+void set_cross_check_handler(cross_check_handler handler);
+
+// Returns number of mismatches found since the start of the program
+std::uint64_t cross_check_mismatches() noexcept;
+
+namespace detail {
+
+// Returns true if the current call has to be cross-checked
+bool cross_check_sampled() noexcept;
+
+// Checks product == a * b
+void check_product(const matrix& a, const matrix& b, const matrix& product);
+
+// Checks transposed == a^T
+void check_transpose(const matrix& a, const matrix& transposed);
+
+// Checks packed LU factors and row permutation of a
+void check_lu(const matrix& a, const matrix& packed,
+              const std::vector<std::size_t>& permutation);
+
+// Checks actual == p-norm of x, p may be infinity
+void check_norm(const char* operation, const_vector_view x, double p,
+                double actual);
+
+// Checks actual == induced 1- or infinity-norm of m
+void check_matrix_norm(const char* operation, const matrix& m, double p,
+                       double actual);
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_CROSS_CHECK_H_
@@ -0,0 +1,539 @@
+#include "math_factorization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "math_blas.h"
+#include "math_cross_check.h"
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_memory.h"
+#include "math_norm.h"
+#include "math_parallel.h"
+#include "math_status.h"
+#include "math_tuning.h"
+
+namespace math {
+
+namespace {
+
+void check_square(const matrix& a) {
+  if (a.rows() != a.columns()) {
+    MATH_THROW(std::logic_error("Matrix is not square"));
+  }
+}
+
+void check_size(matrix::size_type size, matrix::size_type expected) {
+  if (size != expected) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: size = " + std::to_string(size) +
+        ", expected = " + std::to_string(expected)));
+  }
+}
+
+void check_update_sizes(const matrix& u, const matrix& v,
+                        matrix::size_type size) {
+  check_size(u.rows(), size);
+  check_size(v.rows(), size);
+  check_size(v.columns(), u.columns());
+}
+
+vector column(const matrix& m, matrix::size_type j) {
+  vector result(m.rows());
+  for (matrix::size_type i = 0; i < m.rows(); ++i) result[i] = m(i, j);
+  return result;
+}
+
+// Number of trailing rows of size columns processed by one thread
+std::size_t rows_grain(matrix::size_type columns,
+                       std::size_t elements = detail::kBlas1Grain) noexcept {
+  return std::max<std::size_t>(1, elements / columns);
+}
+
+}  // namespace
+
+namespace detail {
+
+drift_monitor::drift_monitor(const matrix& a, double tolerance)
+    : tolerance_(tolerance) {
+  if (std::isnan(tolerance) || tolerance < 0) {
+    MATH_THROW(std::invalid_argument("Drift tolerance can not be negative"));
+  }
+
+  if (enabled()) source_.emplace(a);
+}
+
+bool drift_monitor::enabled() const noexcept { return tolerance_ > 0; }
+
+const matrix& drift_monitor::source() const noexcept { return *source_; }
+
+void drift_monitor::update(const vector& u, const vector& v) {
+  if (source_) ger(1, u, v, *source_);
+}
+
+void drift_monitor::update(const matrix& u, const matrix& v) {
+  if (source_) rank_k_update(1, u, v, *source_);
+}
+
+bool drift_monitor::exceeded(
+    const std::function<vector(const vector&)>& solve) {
+  if (!source_) return false;
+
+  const matrix& a = *source_;
+  vector probe(a.rows());
+  for (size_type i = 0; i < probe.size(); ++i) {
+    probe[i] = (i % 2 ? -1.0 : 1.0) / double(1 + i % 8);
+  }
+
+  vector b(a.rows());
+  gemv(1, a, probe, 0, b);
+  vector x = solve(b);
+
+  vector residual(b);
+  gemv(1, a, x, -1, residual);
+
+  drift_ = norm_inf(residual) / (norm_inf(a) * norm_inf(x) + norm_inf(b));
+  return !(drift_ <= tolerance_);
+}
+
+void drift_monitor::refactorized() noexcept {
+  drift_ = 0;
+  ++refactorizations_;
+}
+
+double drift_monitor::drift() const noexcept { return drift_; }
+
+drift_monitor::size_type drift_monitor::refactorizations() const noexcept {
+  return refactorizations_;
+}
+
+}  // namespace detail
+
+lu_factorization::lu_factorization(const matrix& a, double drift_tolerance)
+    : lu_(a), monitor_(a, drift_tolerance) {
+  factorize();
+}
+
+lu_factorization::size_type lu_factorization::size() const noexcept {
+  return lu_.rows();
+}
+
+const matrix& lu_factorization::packed() const noexcept { return lu_; }
+
+const std::vector<lu_factorization::size_type>&
+lu_factorization::permutation() const noexcept {
+  return permutation_;
+}
+
+vector lu_factorization::solve(const vector& b) const {
+  MATH_INSTRUMENT_OP("lu_factorization::solve(vector)", 2.0 * size() * size(),
+                     8.0 * size() * size(), size());
+  check_size(b.size(), size());
+
+  size_type n = size();
+  vector x(n);
+  for (size_type i = 0; i < n; ++i) x[i] = b[permutation_[i]];
+
+  for (size_type i = 1; i < n; ++i) {
+    x[i] -= detail::dot_kernel(i, lu_.data() + i * n, x.data());
+  }
+  for (size_type i = n; i-- > 0;) {
+    const double* row = lu_.data() + i * n;
+    x[i] = (x[i] - detail::dot_kernel(n - i - 1, row + i + 1,
+                                      x.data() + i + 1)) /
+           row[i];
+  }
+
+  return x;
+}
+
+matrix lu_factorization::solve(const matrix& b) const {
+  MATH_INSTRUMENT_OP("lu_factorization::solve(matrix)",
+                     2.0 * size() * size() * b.columns(),
+                     8.0 * size() * (size() + 2 * b.columns()), size(),
+                     b.columns());
+  check_size(b.rows(), size());
+
+  size_type n = size(), m = b.columns();
+  matrix x(n, m);
+  for (size_type i = 0; i < n; ++i) {
+    std::copy_n(b.data() + permutation_[i] * m, m, x.data() + i * m);
+  }
+
+  // columns of x are independent, every thread substitutes its own range
+  detail::parallel_for(
+      m, std::max<std::size_t>(64, detail::kBlas1Grain / (n * n)),
+      [&](std::size_t first, std::size_t last) {
+        std::size_t width = last - first;
+        for (size_type i = 0; i < n; ++i) {
+          const double* l = lu_.data() + i * n;
+          for (size_type j = 0; j < i; ++j) {
+            detail::axpy_kernel(width, -l[j], x.data() + j * m + first,
+                                x.data() + i * m + first);
+          }
+        }
+        for (size_type i = n; i-- > 0;) {
+          const double* u = lu_.data() + i * n;
+          for (size_type j = i + 1; j < n; ++j) {
+            detail::axpy_kernel(width, -u[j], x.data() + j * m + first,
+                                x.data() + i * m + first);
+          }
+          detail::scal_kernel(width, 1 / u[i], x.data() + i * m + first);
+        }
+      });
+
+  return x;
+}
+
+lu_factorization::value_type lu_factorization::determinant() const noexcept {
+  value_type result = odd_permutation_ ? -1 : 1;
+  for (size_type i = 0; i < size(); ++i) result *= lu_(i, i);
+  return result;
+}
+
+matrix lu_factorization::inverse() const { return solve(matrix(size())); }
+
+void lu_factorization::update(const vector& u, const vector& v) {
+  update(matrix(u, true), matrix(v, true));
+}
+
+void lu_factorization::update(const matrix& u, const matrix& v) {
+  MATH_INSTRUMENT_OP("lu_factorization::update",
+                     4.0 * size() * size() * u.columns(),
+                     16.0 * size() * size() * u.columns(), size(), u.columns());
+  check_update_sizes(u, v, size());
+  monitor_.update(u, v);
+
+  for (size_type p = 0; p < u.columns(); ++p) {
+    vector x(size());
+    for (size_type i = 0; i < size(); ++i) x[i] = u(permutation_[i], p);
+
+    if (!monitor_.enabled()) {
+      // without monitor the matrix is restored from factors on breakdown
+      matrix saved(lu_);
+      if (!bennett_update(std::move(x), column(v, p))) {
+        lu_ = std::move(saved);
+        refactorize(u, v, p);
+        return;
+      }
+    } else if (!bennett_update(std::move(x), column(v, p))) {
+      refactorize(u, v, p);
+      return;
+    }
+  }
+
+  check_drift();
+}
+
+lu_factorization::value_type lu_factorization::drift() const noexcept {
+  return monitor_.drift();
+}
+
+lu_factorization::size_type lu_factorization::refactorizations()
+    const noexcept {
+  return monitor_.refactorizations();
+}
+
+void lu_factorization::factorize() {
+  MATH_INSTRUMENT_OP("lu_factorization::factorize",
+                     2.0 * lu_.rows() * lu_.rows() * lu_.rows() / 3,
+                     16.0 * lu_.rows() * lu_.columns(), lu_.rows(),
+                     lu_.columns());
+  check_square(lu_);
+  std::optional<matrix> input;
+  if (detail::cross_check_sampled()) input = lu_;
+
+  size_type n = size();
+  permutation_.resize(n);
+  std::iota(permutation_.begin(), permutation_.end(), size_type(0));
+  odd_permutation_ = false;
+
+  // right-looking blocked factorization: a panel of lu_block columns is
+  // factorized with partial pivoting, then the trailing matrix is updated by
+  // one matrix product, which does most of the work
+  tuning_parameters parameters = tuning();
+  detail::buffer<double> negated;
+  double* a = lu_.data();
+  for (size_type kk = 0; kk < n; kk += parameters.lu_block) {
+    size_type panel_end = std::min(n, kk + parameters.lu_block);
+    for (size_type k = kk; k < panel_end; ++k) {
+      size_type pivot = k;
+      for (size_type i = k + 1; i < n; ++i) {
+        if (std::fabs(a[i * n + k]) > std::fabs(a[pivot * n + k])) pivot = i;
+      }
+      if (a[pivot * n + k] == 0) {
+        MATH_THROW(std::logic_error("Matrix is singular"));
+      }
+
+      if (pivot != k) {
+        std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+        std::swap(permutation_[k], permutation_[pivot]);
+        odd_permutation_ = !odd_permutation_;
+      }
+
+      const double* pivot_row = a + k * n;
+      double inverse_pivot = 1 / pivot_row[k];
+      size_type width = panel_end - k - 1;
+      detail::parallel_for(
+          n - k - 1, rows_grain(width + 1, parameters.lu_grain),
+          [&](std::size_t first, std::size_t last) {
+            for (size_type i = k + 1 + first; i < k + 1 + last; ++i) {
+              double* row = a + i * n;
+              row[k] *= inverse_pivot;
+              detail::axpy_kernel(width, -row[k], pivot_row + k + 1,
+                                  row + k + 1);
+            }
+          });
+    }
+
+    size_type rest = n - panel_end;
+    if (!rest) break;
+    size_type width = panel_end - kk;
+
+    // u12 = l11^-1 * a12, l11 is unit lower triangular
+    for (size_type i = kk + 1; i < panel_end; ++i) {
+      for (size_type p = kk; p < i; ++p) {
+        detail::axpy_kernel(rest, -a[i * n + p], a + p * n + panel_end,
+                            a + i * n + panel_end);
+      }
+    }
+
+    // a22 -= l21 * u12, gemm_kernel adds so u12 is copied negated
+    negated.resize(width * rest);
+    for (size_type i = 0; i < width; ++i) {
+      const double* row = a + (kk + i) * n + panel_end;
+      for (size_type j = 0; j < rest; ++j) negated[i * rest + j] = -row[j];
+    }
+    detail::parallel_for(
+        rest, parameters.gemm_rows_grain,
+        [&](std::size_t first, std::size_t last) {
+          double* rows = a + (panel_end + first) * n;
+          detail::gemm_kernel(last - first, rest, width, rows + kk, n,
+                              negated.data(), rest, rows + panel_end, n);
+        });
+  }
+
+  if (input) detail::check_lu(*input, lu_, permutation_);
+}
+
+bool lu_factorization::bennett_update(vector x, vector y) noexcept {
+  // l * u + x * y^T, see J. M. Bennett, "Triangular factors of modified
+  // matrices", 1965
+  size_type n = size();
+  double* a = lu_.data();
+
+  for (size_type j = 0; j < n; ++j) {
+    double* row = a + j * n;
+    row[j] += x[j] * y[j];
+    if (row[j] == 0 || !std::isfinite(row[j])) return false;
+
+    double beta = y[j] / row[j];
+    for (size_type i = j + 1; i < n; ++i) {
+      x[i] -= x[j] * a[i * n + j];
+      a[i * n + j] += beta * x[i];
+    }
+    for (size_type i = j + 1; i < n; ++i) {
+      row[i] += x[j] * y[i];
+      y[i] -= beta * row[i];
+    }
+  }
+
+  return true;
+}
+
+void lu_factorization::refactorize(const matrix& u, const matrix& v,
+                                   size_type first) {
+  if (monitor_.enabled()) {
+    lu_ = monitor_.source();
+  } else {
+    matrix a = reconstruct();
+    for (size_type p = first; p < u.columns(); ++p) {
+      ger(1, column_view(u, p), column_view(v, p), a);
+    }
+    lu_ = std::move(a);
+  }
+
+  factorize();
+  monitor_.refactorized();
+}
+
+matrix lu_factorization::reconstruct() const {
+  size_type n = size();
+  matrix result(n, n);
+
+  for (size_type i = 0; i < n; ++i) {
+    const double* l = lu_.data() + i * n;
+    double* row = result.data() + permutation_[i] * n;
+    for (size_type k = 0; k < i; ++k) {
+      detail::axpy_kernel(n - k, l[k], lu_.data() + k * n + k, row + k);
+    }
+    detail::axpy_kernel(n - i, 1, l + i, row + i);
+  }
+
+  return result;
+}
+
+void lu_factorization::check_drift() {
+  if (monitor_.exceeded([this](const vector& b) { return solve(b); })) {
+    lu_ = monitor_.source();
+    factorize();
+    monitor_.refactorized();
+  }
+}
+
+cholesky_factorization::cholesky_factorization(const matrix& a,
+                                               double drift_tolerance)
+    : u_(a), monitor_(a, drift_tolerance) {
+  factorize();
+}
+
+cholesky_factorization::size_type cholesky_factorization::size()
+    const noexcept {
+  return u_.rows();
+}
+
+const matrix& cholesky_factorization::upper() const noexcept { return u_; }
+
+matrix cholesky_factorization::lower() const { return u_.transposed(); }
+
+vector cholesky_factorization::solve(const vector& b) const {
+  MATH_INSTRUMENT_OP("cholesky_factorization::solve", 2.0 * size() * size(),
+                     8.0 * size() * size(), size());
+  check_size(b.size(), size());
+
+  size_type n = size();
+  vector x(b);
+
+  // u^T * y = b, u^T is traversed by rows of u
+  for (size_type j = 0; j < n; ++j) {
+    const double* row = u_.data() + j * n;
+    x[j] /= row[j];
+    detail::axpy_kernel(n - j - 1, -x[j], row + j + 1, x.data() + j + 1);
+  }
+  for (size_type i = n; i-- > 0;) {
+    const double* row = u_.data() + i * n;
+    x[i] = (x[i] - detail::dot_kernel(n - i - 1, row + i + 1,
+                                      x.data() + i + 1)) /
+           row[i];
+  }
+
+  return x;
+}
+
+void cholesky_factorization::update(const vector& x) {
+  MATH_INSTRUMENT_OP("cholesky_factorization::update", 2.0 * size() * size(),
+                     8.0 * size() * size(), size());
+  check_size(x.size(), size());
+  monitor_.update(x, x);
+
+  if (!rotate(x, 1)) {
+    MATH_THROW(std::logic_error("Updated matrix is not positive definite"));
+  }
+  check_drift();
+}
+
+void cholesky_factorization::update(const matrix& x) {
+  MATH_INSTRUMENT_OP("cholesky_factorization::update",
+                     2.0 * size() * size() * x.columns(),
+                     8.0 * size() * size() * x.columns(), size(), x.columns());
+  check_size(x.rows(), size());
+  monitor_.update(x, x);
+
+  for (size_type p = 0; p < x.columns(); ++p) {
+    if (!rotate(column(x, p), 1)) {
+      MATH_THROW(std::logic_error("Updated matrix is not positive definite"));
+    }
+  }
+  check_drift();
+}
+
+void cholesky_factorization::downdate(const vector& x) {
+  MATH_INSTRUMENT_OP("cholesky_factorization::downdate", 2.0 * size() * size(),
+                     16.0 * size() * size(), size());
+  check_size(x.size(), size());
+
+  matrix saved(u_);
+  if (!rotate(x, -1)) {
+    u_ = std::move(saved);
+    MATH_THROW(std::logic_error("Downdated matrix is not positive definite"));
+  }
+
+  monitor_.update(x * -1, x);
+  check_drift();
+}
+
+cholesky_factorization::value_type cholesky_factorization::drift()
+    const noexcept {
+  return monitor_.drift();
+}
+
+cholesky_factorization::size_type cholesky_factorization::refactorizations()
+    const noexcept {
+  return monitor_.refactorizations();
+}
+
+void cholesky_factorization::factorize() {
+  MATH_INSTRUMENT_OP("cholesky_factorization::factorize",
+                     double(u_.rows()) * u_.rows() * u_.rows() / 3,
+                     16.0 * u_.rows() * u_.columns(), u_.rows(), u_.columns());
+  check_square(u_);
+
+  size_type n = size();
+  double* a = u_.data();
+  for (size_type k = 0; k < n; ++k) {
+    double* pivot_row = a + k * n;
+    if (!(pivot_row[k] > 0)) {
+      MATH_THROW(std::logic_error("Matrix is not positive definite"));
+    }
+
+    pivot_row[k] = std::sqrt(pivot_row[k]);
+    detail::scal_kernel(n - k - 1, 1 / pivot_row[k], pivot_row + k + 1);
+
+    detail::parallel_for(n - k - 1, rows_grain(n - k),
+                         [&](std::size_t first, std::size_t last) {
+                           for (size_type i = k + 1 + first;
+                                i < k + 1 + last; ++i) {
+                             detail::axpy_kernel(n - i, -pivot_row[i],
+                                                 pivot_row + i,
+                                                 a + i * n + i);
+                           }
+                         });
+  }
+
+  for (size_type i = 1; i < n; ++i) std::fill_n(a + i * n, i, 0.0);
+}
+
+bool cholesky_factorization::rotate(vector x, double sign) noexcept {
+  // sequence of (hyperbolic for downdate) rotations of u rows with x
+  size_type n = size();
+  for (size_type k = 0; k < n; ++k) {
+    double* row = u_.data() + k * n;
+    double diagonal = row[k] * row[k] + sign * x[k] * x[k];
+    if (!(diagonal > 0) || !std::isfinite(diagonal)) return false;
+
+    double r = std::sqrt(diagonal);
+    double c = r / row[k], s = x[k] / row[k];
+    row[k] = r;
+    for (size_type i = k + 1; i < n; ++i) {
+      row[i] = (row[i] + sign * s * x[i]) / c;
+      x[i] = c * x[i] - s * row[i];
+    }
+  }
+
+  return true;
+}
+
+void cholesky_factorization::check_drift() {
+  if (monitor_.exceeded([this](const vector& b) { return solve(b); })) {
+    u_ = monitor_.source();
+    factorize();
+    monitor_.refactorized();
+  }
+}
+
+}  // namespace math
@@ -0,0 +1,196 @@
+#ifndef CPP_MATH_LIBRARY_MATH_FACTORIZATION_H_
+#define CPP_MATH_LIBRARY_MATH_FACTORIZATION_H_
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "math_matrix.h"
+#include "math_vector.h"
+
+namespace math {
+
+namespace detail {
+
+/**
+ * @brief Keeps an updated copy of a factorized matrix and measures normwise
+ * backward error ||a * x - b|| / (||a|| * ||x|| + ||b||) of solutions made by
+ * the factorization. Disabled (and stores nothing) if tolerance is 0
+ *
+ */
+class drift_monitor {
+ public:
+  using size_type = matrix::size_type;
+
+  drift_monitor(const matrix& a, double tolerance);
+
+  bool enabled() const noexcept;
+
+  // Returns tracked matrix, must be enabled
+  const matrix& source() const noexcept;
+
+  // source += u * v^T
+  void update(const vector& u, const vector& v);
+
+  // source += u * v^T for u and v with k columns
+  void update(const matrix& u, const matrix& v);
+
+  /**
+   * @brief Measures drift of solve, where solve(b) returns solution of
+   * source * x = b. Returns true if drift exceeds tolerance
+   *
+   */
+  bool exceeded(const std::function<vector(const vector&)>& solve);
+
+  // Must be called after factorization is recomputed from source
+  void refactorized() noexcept;
+
+  double drift() const noexcept;
+
+  size_type refactorizations() const noexcept;
+
+ private:
+  double tolerance_;
+  std::optional<matrix> source_;
+  double drift_ = 0;
+  size_type refactorizations_ = 0;
+};
+
+}  // namespace detail
+
+/**
+ * @brief LU factorization with partial pivoting p * a = l * u, where l is unit
+ * lower triangular and u is upper triangular, both packed into one matrix.
+ * Supports O(n^2) rank-1 updates (Bennett's algorithm), which do not pivot: if
+ * drift tolerance is not 0, backward error is checked after every update and
+ * the factorization is recomputed when it exceeds tolerance.
+ *
+ */
+class lu_factorization {
+ public:
+  using value_type = matrix::value_type;
+  using size_type = matrix::size_type;
+
+  /**
+   * @brief Factorizes a. Throws std::logic_error if a is not square or is
+   * singular
+   *
+   * @param a matrix to factorize
+   * @param drift_tolerance maximum backward error after updates, 0 disables
+   * monitoring
+   */
+  explicit lu_factorization(const matrix& a, double drift_tolerance = 0);
+
+  size_type size() const noexcept;
+
+  // Returns packed factors: strictly lower part of l and upper part of u
+  const matrix& packed() const noexcept;
+
+  // Returns row permutation: row i of p * a is row permutation()[i] of a
+  const std::vector<size_type>& permutation() const noexcept;
+
+  // Solves a * x = b. Throws std::invalid_argument if b.size() != size()
+  vector solve(const vector& b) const;
+
+  // Solves a * x = b for every column of b
+  matrix solve(const matrix& b) const;
+
+  value_type determinant() const noexcept;
+
+  matrix inverse() const;
+
+  /**
+   * @brief Updates factorization of a to factorization of a + u * v^T. Falls
+   * back to full factorization if the update breaks down. Throws
+   * std::logic_error if updated matrix is singular
+   *
+   */
+  void update(const vector& u, const vector& v);
+
+  // Updates factorization to a + u * v^T for u and v with k columns
+  void update(const matrix& u, const matrix& v);
+
+  // Backward error measured after the last update, 0 after factorization
+  double drift() const noexcept;
+
+  // Number of full factorizations triggered by updates
+  size_type refactorizations() const noexcept;
+
+ private:
+  void factorize();
+  bool bennett_update(vector x, vector y) noexcept;
+  void refactorize(const matrix& u, const matrix& v, size_type first);
+  matrix reconstruct() const;
+  void check_drift();
+
+  matrix lu_;
+  std::vector<size_type> permutation_;
+  bool odd_permutation_ = false;
+  detail::drift_monitor monitor_;
+};
+
+/**
+ * @brief Cholesky factorization a = u^T * u of symmetric positive definite
+ * matrix, u is upper triangular. Only upper triangle of a is used. Supports
+ * O(n^2) rank-1 updates and downdates; if drift tolerance is not 0, backward
+ * error is checked after every update and the factorization is recomputed
+ * when it exceeds tolerance.
+ *
+ */
+class cholesky_factorization {
+ public:
+  using value_type = matrix::value_type;
+  using size_type = matrix::size_type;
+
+  /**
+   * @brief Factorizes a. Throws std::logic_error if a is not square or is not
+   * positive definite
+   *
+   * @param a matrix to factorize
+   * @param drift_tolerance maximum backward error after updates, 0 disables
+   * monitoring
+   */
+  explicit cholesky_factorization(const matrix& a, double drift_tolerance = 0);
+
+  size_type size() const noexcept;
+
+  // Returns upper triangular factor u
+  const matrix& upper() const noexcept;
+
+  // Returns lower triangular factor u^T
+  matrix lower() const;
+
+  // Solves a * x = b. Throws std::invalid_argument if b.size() != size()
+  vector solve(const vector& b) const;
+
+  // Updates factorization to a + x * x^T
+  void update(const vector& x);
+
+  // Updates factorization to a + x * x^T for every column of x
+  void update(const matrix& x);
+
+  /**
+   * @brief Updates factorization to a - x * x^T. Throws std::logic_error and
+   * leaves factorization unchanged if the result is not positive definite
+   *
+   */
+  void downdate(const vector& x);
+
+  // Backward error measured after the last update, 0 after factorization
+  double drift() const noexcept;
+
+  // Number of full factorizations triggered by updates
+  size_type refactorizations() const noexcept;
+
+ private:
+  void factorize();
+  bool rotate(vector x, double sign) noexcept;
+  void check_drift();
+
+  matrix u_;
+  detail::drift_monitor monitor_;
+};
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_FACTORIZATION_H_
@@ -0,0 +1,467 @@
+#ifndef CPP_MATH_LIBRARY_MATH_FIXED_H_
+#define CPP_MATH_LIBRARY_MATH_FIXED_H_
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+#include "math_matrix.h"
+#include "math_status.h"
+#include "math_vector.h"
+
+// Matrices and vectors with sizes known at compile time. All their operations
+// are constexpr, so constant transformations, their determinants and inverses
+// are computed by the compiler and placed in read-only data:
+//
+//   constexpr math::fixed_matrix<2, 2> kRotation{{0, -1}, {1, 0}};
+//   constexpr auto kInverse = kRotation.inverse();
+//
+// Errors found during constant evaluation (a singular matrix) fail the build.
+
+namespace math {
+
+namespace detail {
+
+constexpr double fixed_abs(double value) noexcept {
+  return value < 0 ? -value : value;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Vector of N elements with constexpr operations.
+ *
+ */
+template <std::size_t N>
+class fixed_vector {
+  static_assert(N > 0, "Vector size can not be 0");
+
+ public:
+  using value_type = double;
+  using size_type = std::size_t;
+
+  // Constructs vector filled by 0
+  constexpr fixed_vector() noexcept = default;
+
+  /**
+   * @brief Construct a new vector from initializer list. Throws
+   * std::invalid_argument if its size is not N
+   *
+   */
+  constexpr fixed_vector(std::initializer_list<value_type> values) {
+    if (values.size() != N) {
+      MATH_THROW(std::invalid_argument("Initializer list size is not N"));
+    }
+    size_type i = 0;
+    for (value_type value : values) data_[i++] = value;
+  }
+
+  /**
+   * @brief Copies a vector of size N. Throws std::invalid_argument if sizes
+   * are not equal
+   *
+   */
+  explicit fixed_vector(const vector& v) {
+    if (v.size() != N) {
+      MATH_THROW(std::invalid_argument(
+          "Sizes mismatch: v.size = " + std::to_string(v.size()) +
+          ", N = " + std::to_string(N)));
+    }
+    for (size_type i = 0; i < N; ++i) data_[i] = v[i];
+  }
+
+  static constexpr size_type size() noexcept { return N; }
+
+  // Get element without bounds checking
+  constexpr value_type& operator[](size_type pos) noexcept {
+    return data_[pos];
+  }
+
+  constexpr const value_type& operator[](size_type pos) const noexcept {
+    return data_[pos];
+  }
+
+  constexpr value_type* data() noexcept { return data_.data(); }
+
+  constexpr const value_type* data() const noexcept { return data_.data(); }
+
+  // Returns copy as a dynamic vector
+  vector to_vector() const { return vector(data_.begin(), data_.end()); }
+
+  friend constexpr bool operator==(const fixed_vector& l,
+                                   const fixed_vector& r) noexcept {
+    for (size_type i = 0; i < N; ++i) {
+      if (l[i] != r[i]) return false;
+    }
+    return true;
+  }
+
+  friend constexpr bool operator!=(const fixed_vector& l,
+                                   const fixed_vector& r) noexcept {
+    return !(l == r);
+  }
+
+  friend constexpr fixed_vector operator+(fixed_vector l,
+                                          const fixed_vector& r) noexcept {
+    for (size_type i = 0; i < N; ++i) l[i] += r[i];
+    return l;
+  }
+
+  friend constexpr fixed_vector operator-(fixed_vector l,
+                                          const fixed_vector& r) noexcept {
+    for (size_type i = 0; i < N; ++i) l[i] -= r[i];
+    return l;
+  }
+
+  friend constexpr fixed_vector operator*(fixed_vector v,
+                                          value_type value) noexcept {
+    for (size_type i = 0; i < N; ++i) v[i] *= value;
+    return v;
+  }
+
+  friend constexpr fixed_vector operator*(value_type value,
+                                          const fixed_vector& v) noexcept {
+    return v * value;
+  }
+
+  // Dot product
+  friend constexpr value_type operator*(const fixed_vector& l,
+                                        const fixed_vector& r) noexcept {
+    value_type sum = 0;
+    for (size_type i = 0; i < N; ++i) sum += l[i] * r[i];
+    return sum;
+  }
+
+ private:
+  std::array<value_type, N> data_{};
+};
+
+/**
+ * @brief Rows x Columns matrix in row-major order with constexpr operations.
+ *
+ */
+template <std::size_t Rows, std::size_t Columns>
+class fixed_matrix {
+  static_assert(Rows > 0 && Columns > 0, "Matrix sizes can not be 0");
+
+ public:
+  using value_type = double;
+  using size_type = std::size_t;
+
+  // Constructs matrix filled by 0
+  constexpr fixed_matrix() noexcept = default;
+
+  /**
+   * @brief Construct a new matrix from initializer list in format
+   * {{1, 2}, {3, 4}}. Throws std::invalid_argument if there are not Rows
+   * rows of Columns elements
+   *
+   */
+  constexpr fixed_matrix(
+      std::initializer_list<std::initializer_list<value_type>> items) {
+    if (items.size() != Rows) {
+      MATH_THROW(std::invalid_argument("Initializer list size is not Rows"));
+    }
+    size_type i = 0;
+    for (const auto& row : items) {
+      if (row.size() != Columns) {
+        MATH_THROW(
+            std::invalid_argument("Initializer list row size is not Columns"));
+      }
+      for (value_type value : row) data_[i++] = value;
+    }
+  }
+
+  /**
+   * @brief Copies a Rows x Columns matrix. Throws std::invalid_argument if
+   * sizes are not equal
+   *
+   */
+  explicit fixed_matrix(const matrix& m) {
+    if (m.rows() != Rows || m.columns() != Columns) {
+      MATH_THROW(std::invalid_argument(
+          "Sizes mismatch: m.rows = " + std::to_string(m.rows()) +
+          ", m.columns = " + std::to_string(m.columns()) +
+          ", Rows = " + std::to_string(Rows) +
+          ", Columns = " + std::to_string(Columns)));
+    }
+    for (size_type i = 0; i < Rows * Columns; ++i) data_[i] = m.data()[i];
+  }
+
+  // Returns identity matrix
+  static constexpr fixed_matrix identity() noexcept {
+    static_assert(Rows == Columns, "Identity matrix must be square");
+    fixed_matrix result;
+    for (size_type i = 0; i < Rows; ++i) result.unchecked(i, i) = 1;
+    return result;
+  }
+
+  static constexpr size_type rows() noexcept { return Rows; }
+
+  static constexpr size_type columns() noexcept { return Columns; }
+
+  /**
+   * @brief Get element by position. Throws std::out_of_range if row >= Rows
+   * or column >= Columns
+   *
+   */
+  constexpr value_type& operator()(size_type row, size_type column) {
+    bounds_check(row, column);
+    return unchecked(row, column);
+  }
+
+  constexpr const value_type& operator()(size_type row,
+                                         size_type column) const {
+    bounds_check(row, column);
+    return unchecked(row, column);
+  }
+
+  // Get element by position without bounds checking
+  constexpr value_type& unchecked(size_type row, size_type column) noexcept {
+    return data_[row * Columns + column];
+  }
+
+  constexpr const value_type& unchecked(size_type row,
+                                        size_type column) const noexcept {
+    return data_[row * Columns + column];
+  }
+
+  constexpr value_type* data() noexcept { return data_.data(); }
+
+  constexpr const value_type* data() const noexcept { return data_.data(); }
+
+  // Returns copy as a dynamic matrix
+  matrix to_matrix() const {
+    matrix result(Rows, Columns);
+    for (size_type i = 0; i < Rows * Columns; ++i) result.data()[i] = data_[i];
+    return result;
+  }
+
+  friend constexpr bool operator==(const fixed_matrix& l,
+                                   const fixed_matrix& r) noexcept {
+    for (size_type i = 0; i < Rows * Columns; ++i) {
+      if (l.data_[i] != r.data_[i]) return false;
+    }
+    return true;
+  }
+
+  friend constexpr bool operator!=(const fixed_matrix& l,
+                                   const fixed_matrix& r) noexcept {
+    return !(l == r);
+  }
+
+  friend constexpr fixed_matrix operator+(fixed_matrix l,
+                                          const fixed_matrix& r) noexcept {
+    for (size_type i = 0; i < Rows * Columns; ++i) l.data_[i] += r.data_[i];
+    return l;
+  }
+
+  friend constexpr fixed_matrix operator-(fixed_matrix l,
+                                          const fixed_matrix& r) noexcept {
+    for (size_type i = 0; i < Rows * Columns; ++i) l.data_[i] -= r.data_[i];
+    return l;
+  }
+
+  friend constexpr fixed_matrix operator*(fixed_matrix m,
+                                          value_type value) noexcept {
+    for (size_type i = 0; i < Rows * Columns; ++i) m.data_[i] *= value;
+    return m;
+  }
+
+  friend constexpr fixed_matrix operator*(value_type value,
+                                          const fixed_matrix& m) noexcept {
+    return m * value;
+  }
+
+  // Matrix product, inner sizes are checked at compile time
+  template <std::size_t Others>
+  constexpr fixed_matrix<Rows, Others> operator*(
+      const fixed_matrix<Columns, Others>& other) const noexcept {
+    fixed_matrix<Rows, Others> result;
+    for (size_type i = 0; i < Rows; ++i) {
+      for (size_type p = 0; p < Columns; ++p) {
+        value_type a = unchecked(i, p);
+        for (size_type j = 0; j < Others; ++j) {
+          result.unchecked(i, j) += a * other.unchecked(p, j);
+        }
+      }
+    }
+    return result;
+  }
+
+  // Matrix-vector product
+  constexpr fixed_vector<Rows> operator*(
+      const fixed_vector<Columns>& v) const noexcept {
+    fixed_vector<Rows> result;
+    for (size_type i = 0; i < Rows; ++i) {
+      value_type sum = 0;
+      for (size_type j = 0; j < Columns; ++j) sum += unchecked(i, j) * v[j];
+      result[i] = sum;
+    }
+    return result;
+  }
+
+  constexpr fixed_matrix<Columns, Rows> transposed() const noexcept {
+    fixed_matrix<Columns, Rows> result;
+    for (size_type i = 0; i < Rows; ++i) {
+      for (size_type j = 0; j < Columns; ++j) {
+        result.unchecked(j, i) = unchecked(i, j);
+      }
+    }
+    return result;
+  }
+
+  // Returns determinant computed by LU factorization with partial pivoting
+  constexpr value_type determinant() const noexcept;
+
+  // Returns inverse matrix. Throws std::logic_error if matrix is singular
+  constexpr fixed_matrix inverse() const;
+
+ private:
+  constexpr void bounds_check(size_type row, size_type column) const {
+    if (row >= Rows || column >= Columns) {
+      MATH_THROW(std::out_of_range("Out of range of fixed matrix"));
+    }
+  }
+
+  std::array<value_type, Rows * Columns> data_{};
+};
+
+/**
+ * @brief LU factorization with partial pivoting of a fixed N x N matrix,
+ * usable in constant expressions.
+ *
+ */
+template <std::size_t N>
+class fixed_lu {
+ public:
+  using value_type = double;
+  using size_type = std::size_t;
+
+  explicit constexpr fixed_lu(const fixed_matrix<N, N>& a) noexcept : lu_(a) {
+    for (size_type i = 0; i < N; ++i) permutation_[i] = i;
+
+    for (size_type k = 0; k < N; ++k) {
+      size_type pivot = k;
+      for (size_type i = k + 1; i < N; ++i) {
+        if (detail::fixed_abs(lu_.unchecked(i, k)) >
+            detail::fixed_abs(lu_.unchecked(pivot, k))) {
+          pivot = i;
+        }
+      }
+      if (lu_.unchecked(pivot, k) == 0) {
+        singular_ = true;
+        continue;
+      }
+
+      if (pivot != k) {
+        for (size_type j = 0; j < N; ++j) {
+          value_type t = lu_.unchecked(k, j);
+          lu_.unchecked(k, j) = lu_.unchecked(pivot, j);
+          lu_.unchecked(pivot, j) = t;
+        }
+        size_type t = permutation_[k];
+        permutation_[k] = permutation_[pivot];
+        permutation_[pivot] = t;
+        negative_ = !negative_;
+      }
+
+      for (size_type i = k + 1; i < N; ++i) {
+        value_type l = lu_.unchecked(i, k) / lu_.unchecked(k, k);
+        lu_.unchecked(i, k) = l;
+        for (size_type j = k + 1; j < N; ++j) {
+          lu_.unchecked(i, j) -= l * lu_.unchecked(k, j);
+        }
+      }
+    }
+  }
+
+  constexpr bool singular() const noexcept { return singular_; }
+
+  constexpr value_type determinant() const noexcept {
+    if (singular_) return 0;
+    value_type result = negative_ ? -1 : 1;
+    for (size_type i = 0; i < N; ++i) result *= lu_.unchecked(i, i);
+    return result;
+  }
+
+  // Solves a x = b. Throws std::logic_error if a is singular
+  constexpr fixed_vector<N> solve(const fixed_vector<N>& b) const {
+    singular_check();
+    fixed_vector<N> x;
+    for (size_type i = 0; i < N; ++i) x[i] = b[permutation_[i]];
+    substitute(x.data(), 1);
+    return x;
+  }
+
+  // Solves a x = b for every column of b. Throws std::logic_error if a is
+  // singular
+  template <std::size_t M>
+  constexpr fixed_matrix<N, M> solve(const fixed_matrix<N, M>& b) const {
+    singular_check();
+    fixed_matrix<N, M> x;
+    for (size_type i = 0; i < N; ++i) {
+      for (size_type j = 0; j < M; ++j) {
+        x.unchecked(i, j) = b.unchecked(permutation_[i], j);
+      }
+    }
+    substitute(x.data(), M);
+    return x;
+  }
+
+ private:
+  constexpr void singular_check() const {
+    if (singular_) MATH_THROW(std::logic_error("Matrix is singular"));
+  }
+
+  // Forward and back substitution of N x m row-major right-hand sides
+  constexpr void substitute(value_type* x, size_type m) const noexcept {
+    for (size_type i = 0; i < N; ++i) {
+      for (size_type k = 0; k < i; ++k) {
+        for (size_type j = 0; j < m; ++j) {
+          x[i * m + j] -= lu_.unchecked(i, k) * x[k * m + j];
+        }
+      }
+    }
+    for (size_type i = N; i-- > 0;) {
+      for (size_type k = i + 1; k < N; ++k) {
+        for (size_type j = 0; j < m; ++j) {
+          x[i * m + j] -= lu_.unchecked(i, k) * x[k * m + j];
+        }
+      }
+      for (size_type j = 0; j < m; ++j) x[i * m + j] /= lu_.unchecked(i, i);
+    }
+  }
+
+  fixed_matrix<N, N> lu_;
+  std::array<size_type, N> permutation_{};
+  bool singular_ = false;
+  bool negative_ = false;
+};
+
+template <std::size_t Rows, std::size_t Columns>
+constexpr typename fixed_matrix<Rows, Columns>::value_type
+fixed_matrix<Rows, Columns>::determinant() const noexcept {
+  static_assert(Rows == Columns, "Determinant needs a square matrix");
+  return fixed_lu<Rows>(*this).determinant();
+}
+
+template <std::size_t Rows, std::size_t Columns>
+constexpr fixed_matrix<Rows, Columns> fixed_matrix<Rows, Columns>::inverse()
+    const {
+  static_assert(Rows == Columns, "Inverse needs a square matrix");
+  return fixed_lu<Rows>(*this).solve(identity());
+}
+
+// Solves a x = b. Throws std::logic_error if a is singular
+template <std::size_t N>
+constexpr fixed_vector<N> lu_solve(const fixed_matrix<N, N>& a,
+                                   const fixed_vector<N>& b) {
+  return fixed_lu<N>(a).solve(b);
+}
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_FIXED_H_
@@ -0,0 +1,398 @@
+#include "math_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "math_factorization.h"
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_norm.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+using size_type = matrix::size_type;
+
+// QL iterations per eigenvalue after which it is accepted as converged, it
+// usually takes 1-3
+constexpr int kQlIterations = 30;
+
+// Pade approximant r(x) = q(x)^-1 p(x) of e^x, p(x) = sum b[j] x^j and
+// q(x) = p(-x), is accurate to double precision while ||x||_1 <= theta
+struct pade_approximant {
+  std::size_t degree;
+  double theta;
+  double b[14];
+};
+
+constexpr pade_approximant kPade[] = {
+    {3, 1.495585217958292e-2, {120, 60, 12, 1}},
+    {5, 2.539398330063230e-1, {30240, 15120, 3360, 420, 30, 1}},
+    {7,
+     9.504178996162932e-1,
+     {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1}},
+    {9,
+     2.097847961257068,
+     {17643225600, 8821612800, 2075673600, 302702400, 30270240, 2162160,
+      110880, 3960, 90, 1}},
+    {13,
+     5.371920351148152,
+     {64764752532480000, 32382376266240000, 7771770303897600,
+      1187353796428800, 129060195264000, 10559470521600, 670442572800,
+      33522128640, 1323241920, 40840800, 960960, 16380, 182, 1}},
+};
+
+void check_square(const matrix& m) {
+  if (m.rows() != m.columns()) {
+    MATH_THROW(std::logic_error("Matrix is not square"));
+  }
+}
+
+// c = a * b for square matrices of the same size as c, c is not reallocated
+void multiply(const matrix& a, const matrix& b, matrix& c) {
+  size_type n = a.rows();
+  detail::product(n, n, n, a.data(), b.data(), c.data());
+}
+
+// y += alpha * x
+void add_scaled(double alpha, const matrix& x, matrix& y) noexcept {
+  detail::axpy_kernel(x.rows() * x.columns(), alpha, x.data(), y.data());
+}
+
+// y += alpha * identity
+void add_identity(double alpha, matrix& y) noexcept {
+  for (size_type i = 0; i < y.rows(); ++i) y.unchecked(i, i) += alpha;
+}
+
+bool is_diagonal(const matrix& m) noexcept {
+  for (size_type i = 0; i < m.rows(); ++i) {
+    for (size_type j = 0; j < m.columns(); ++j) {
+      if (i != j && m.unchecked(i, j) != 0) return false;
+    }
+  }
+  return true;
+}
+
+bool is_symmetric(const matrix& m) noexcept {
+  for (size_type i = 0; i < m.rows(); ++i) {
+    for (size_type j = 0; j < i; ++j) {
+      if (m.unchecked(i, j) != m.unchecked(j, i)) return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Eigen-decomposition of symmetric a = w^T diag(d) w by Householder
+ * reduction to tridiagonal form and implicit QL iteration (tred2 and tql2 of
+ * EISPACK). Loops of EISPACK run down columns of the transformation, it is
+ * kept transposed in w so they run along rows. Returns eigenvalues, rows of w
+ * become eigenvectors
+ *
+ */
+std::vector<double> symmetric_eigen(matrix& w) {
+  size_type n = w.rows();
+  // v(k, j) of EISPACK
+  auto v = [&w](size_type k, size_type j) -> double& {
+    return w.unchecked(j, k);
+  };
+  std::vector<double> d(n), e(n);
+
+  // householder reduction, d and e become diagonal and subdiagonal
+  for (size_type j = 0; j < n; ++j) d[j] = v(n - 1, j);
+  for (size_type i = n - 1; i > 0; --i) {
+    double scale = 0, h = 0;
+    for (size_type k = 0; k < i; ++k) scale += std::fabs(d[k]);
+    if (scale == 0) {
+      e[i] = d[i - 1];
+      for (size_type j = 0; j < i; ++j) {
+        d[j] = v(i - 1, j);
+        v(i, j) = v(j, i) = 0;
+      }
+      d[i] = h;
+      continue;
+    }
+
+    for (size_type k = 0; k < i; ++k) {
+      d[k] /= scale;
+      h += d[k] * d[k];
+    }
+    double f = d[i - 1];
+    double g = f > 0 ? -std::sqrt(h) : std::sqrt(h);
+    e[i] = scale * g;
+    h -= f * g;
+    d[i - 1] = f - g;
+    std::fill(e.begin(), e.begin() + i, 0.0);
+
+    for (size_type j = 0; j < i; ++j) {
+      f = d[j];
+      v(j, i) = f;
+      g = e[j] + v(j, j) * f;
+      const double* column = w.row_data(j);
+      for (size_type k = j + 1; k < i; ++k) {
+        g += column[k] * d[k];
+        e[k] += column[k] * f;
+      }
+      e[j] = g;
+    }
+    f = 0;
+    for (size_type j = 0; j < i; ++j) {
+      e[j] /= h;
+      f += e[j] * d[j];
+    }
+    double hh = f / (h + h);
+    for (size_type j = 0; j < i; ++j) e[j] -= hh * d[j];
+    for (size_type j = 0; j < i; ++j) {
+      double* column = w.row_data(j);
+      for (size_type k = j; k < i; ++k) {
+        column[k] -= d[j] * e[k] + e[j] * d[k];
+      }
+      d[j] = v(i - 1, j);
+      v(i, j) = 0;
+    }
+    d[i] = h;
+  }
+
+  // accumulate transformations
+  for (size_type i = 0; i + 1 < n; ++i) {
+    v(n - 1, i) = v(i, i);
+    v(i, i) = 1;
+    double h = d[i + 1];
+    double* next = w.row_data(i + 1);
+    if (h != 0) {
+      for (size_type k = 0; k <= i; ++k) d[k] = next[k] / h;
+      for (size_type j = 0; j <= i; ++j) {
+        double* column = w.row_data(j);
+        double g = detail::dot_kernel(i + 1, next, column);
+        detail::axpy_kernel(i + 1, -g, d.data(), column);
+      }
+    }
+    std::fill(next, next + i + 1, 0.0);
+  }
+  for (size_type j = 0; j < n; ++j) {
+    d[j] = v(n - 1, j);
+    v(n - 1, j) = 0;
+  }
+  v(n - 1, n - 1) = 1;
+
+  // QL iteration on the tridiagonal matrix
+  for (size_type i = 1; i < n; ++i) e[i - 1] = e[i];
+  e[n - 1] = 0;
+  double shift = 0, norm = 0;
+  double epsilon = std::numeric_limits<double>::epsilon();
+  for (size_type l = 0; l < n; ++l) {
+    norm = std::max(norm, std::fabs(d[l]) + std::fabs(e[l]));
+    size_type m = l;
+    while (std::fabs(e[m]) > epsilon * norm) ++m;
+    if (m == l) {
+      d[l] += shift;
+      e[l] = 0;
+      continue;
+    }
+
+    for (int iteration = 0; iteration < kQlIterations; ++iteration) {
+      double g = d[l];
+      double p = (d[l + 1] - g) / (2 * e[l]);
+      double r = std::hypot(p, 1.0);
+      if (p < 0) r = -r;
+      d[l] = e[l] / (p + r);
+      d[l + 1] = e[l] * (p + r);
+      double dl1 = d[l + 1];
+      double h = g - d[l];
+      for (size_type i = l + 2; i < n; ++i) d[i] -= h;
+      shift += h;
+
+      p = d[m];
+      double c = 1, c2 = 1, c3 = 1, s = 0, s2 = 0;
+      double el1 = e[l + 1];
+      for (size_type i = m; i-- > l;) {
+        c3 = c2;
+        c2 = c;
+        s2 = s;
+        g = c * e[i];
+        h = c * p;
+        r = std::hypot(p, e[i]);
+        e[i + 1] = s * r;
+        s = e[i] / r;
+        c = p / r;
+        p = c * d[i] - s * g;
+        d[i + 1] = h + s * (c * g + s * d[i]);
+        detail::rot_kernel(n, w.row_data(i), w.row_data(i + 1), c, -s);
+      }
+      p = -s * s2 * c3 * el1 * e[l] / dl1;
+      e[l] = s * p;
+      d[l] = c * p;
+      if (std::fabs(e[l]) <= epsilon * norm) break;
+    }
+    d[l] += shift;
+    e[l] = 0;
+  }
+  return d;
+}
+
+// e^a = w^T diag(e^d) w for eigen-decomposition of symmetric a
+matrix symmetric_exponential(const matrix& a) {
+  size_type n = a.rows();
+  matrix w = a;
+  std::vector<double> d = symmetric_eigen(w);
+  matrix scaled = w;
+  for (size_type i = 0; i < n; ++i) {
+    detail::scal_kernel(n, std::exp(d[i]), scaled.row_data(i));
+  }
+
+  matrix result(n, n);
+  multiply(w.transposed(), scaled, result);
+
+  // rounding of the product differs between (i, j) and (j, i)
+  for (size_type i = 0; i < n; ++i) {
+    for (size_type j = i + 1; j < n; ++j) {
+      double mean = (result.unchecked(i, j) + result.unchecked(j, i)) / 2;
+      result.unchecked(i, j) = result.unchecked(j, i) = mean;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Returns r(a) for approximant of degree up to 9: u = a * sum b[2j + 1]
+ * a^2j, v = sum b[2j] a^2j and r = (v - u)^-1 (v + u)
+ *
+ */
+matrix pade_low(const matrix& a, const pade_approximant& pade) {
+  size_type n = a.rows();
+  matrix odd(n, n), even(n, n), a2(n, n), power(n, n), spare(n, n);
+  multiply(a, a, a2);
+  add_identity(pade.b[1], odd);
+  add_identity(pade.b[0], even);
+  for (std::size_t j = 2; j <= pade.degree; j += 2) {
+    if (j == 2) {
+      power = a2;
+    } else {
+      multiply(power, a2, spare);
+      std::swap(power, spare);
+    }
+    add_scaled(pade.b[j + 1], power, odd);
+    add_scaled(pade.b[j], power, even);
+  }
+
+  matrix u(n, n);
+  multiply(a, odd, u);
+  matrix q = even, p = std::move(even);
+  add_scaled(-1, u, q);
+  add_scaled(1, u, p);
+  return lu_factorization(q).solve(p);
+}
+
+// Returns r(a) for the approximant of degree 13 evaluated with 6 products
+matrix pade_13(const matrix& a) {
+  const double* b = kPade[4].b;
+  size_type n = a.rows();
+  matrix a2(n, n), a4(n, n), a6(n, n);
+  multiply(a, a, a2);
+  multiply(a2, a2, a4);
+  multiply(a4, a2, a6);
+
+  // u = a (a6 (b13 a6 + b11 a4 + b9 a2) + b7 a6 + b5 a4 + b3 a2 + b1 i)
+  matrix inner(n, n), sum(n, n), u(n, n);
+  add_scaled(b[13], a6, inner);
+  add_scaled(b[11], a4, inner);
+  add_scaled(b[9], a2, inner);
+  multiply(a6, inner, sum);
+  add_scaled(b[7], a6, sum);
+  add_scaled(b[5], a4, sum);
+  add_scaled(b[3], a2, sum);
+  add_identity(b[1], sum);
+  multiply(a, sum, u);
+
+  // v = a6 (b12 a6 + b10 a4 + b8 a2) + b6 a6 + b4 a4 + b2 a2 + b0 i
+  std::fill(inner.begin(), inner.end(), 0.0);
+  add_scaled(b[12], a6, inner);
+  add_scaled(b[10], a4, inner);
+  add_scaled(b[8], a2, inner);
+  matrix& v = sum;
+  multiply(a6, inner, v);
+  add_scaled(b[6], a6, v);
+  add_scaled(b[4], a4, v);
+  add_scaled(b[2], a2, v);
+  add_identity(b[0], v);
+
+  matrix& q = inner;
+  q = v;
+  add_scaled(-1, u, q);
+  add_scaled(1, u, v);
+  return lu_factorization(q).solve(v);
+}
+
+}  // namespace
+
+matrix pow(const matrix& m, std::size_t k) {
+  MATH_INSTRUMENT_OP("pow(matrix)",
+                     4.0 * m.rows() * m.rows() * m.rows() * std::log2(k + 1),
+                     24.0 * m.rows() * m.columns(), m.rows(), k);
+  check_square(m);
+  size_type n = m.rows();
+  if (!k) return matrix(n);
+
+  // result starts as the lowest power of two in k, so it is never multiplied
+  // by the identity; products alternate between the buffers by swapping
+  matrix base = m, result(n, n), spare(n, n);
+  for (; !(k & 1); k >>= 1) {
+    multiply(base, base, spare);
+    std::swap(base, spare);
+  }
+  result = base;
+  for (k >>= 1; k; k >>= 1) {
+    multiply(base, base, spare);
+    std::swap(base, spare);
+    if (k & 1) {
+      multiply(result, base, spare);
+      std::swap(result, spare);
+    }
+  }
+  return result;
+}
+
+matrix expm(const matrix& m) {
+  MATH_INSTRUMENT_OP("expm", 20.0 * m.rows() * m.rows() * m.rows(),
+                     64.0 * m.rows() * m.columns(), m.rows());
+  check_square(m);
+  if (!std::all_of(m.begin(), m.end(),
+                   [](double x) { return std::isfinite(x); })) {
+    MATH_THROW(std::invalid_argument("Matrix has infinite or NaN elements"));
+  }
+  size_type n = m.rows();
+  if (is_diagonal(m)) {
+    matrix result(n, n);
+    for (size_type i = 0; i < n; ++i) {
+      result.unchecked(i, i) = std::exp(m.unchecked(i, i));
+    }
+    return result;
+  }
+  if (is_symmetric(m)) return symmetric_exponential(m);
+
+  double norm = norm1(m);
+  for (const pade_approximant& pade : kPade) {
+    if (pade.degree < 13 && norm <= pade.theta) return pade_low(m, pade);
+  }
+
+  // e^m = (e^(m / 2^s))^(2^s) with ||m / 2^s||_1 <= theta of degree 13
+  double theta = kPade[4].theta;
+  int s = norm > theta ? int(std::ceil(std::log2(norm / theta))) : 0;
+  matrix scaled = m;
+  for (double& x : scaled) x = std::ldexp(x, -s);
+
+  matrix result = pade_13(scaled), spare(n, n);
+  for (int i = 0; i < s; ++i) {
+    multiply(result, result, spare);
+    std::swap(result, spare);
+  }
+  return result;
+}
+
+}  // namespace math
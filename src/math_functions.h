@@ -0,0 +1,34 @@
+#ifndef CPP_MATH_LIBRARY_MATH_FUNCTIONS_H_
+#define CPP_MATH_LIBRARY_MATH_FUNCTIONS_H_
+
+#include <cstddef>
+
+#include "math_matrix.h"
+
+namespace math {
+
+// Functions of square matrices
+
+/**
+ * @brief Returns m^k by binary exponentiation: at most 2 log2(k) products
+ * instead of k - 1, computed into three buffers allocated once. m^0 is the
+ * identity. Throws std::logic_error if m is not square
+ *
+ */
+matrix pow(const matrix& m, std::size_t k);
+
+/**
+ * @brief Returns matrix exponential e^m. Uses scaling and squaring with the
+ * Pade approximant of the lowest degree (3, 5, 7, 9 or 13) that is accurate
+ * to double precision for ||m||_1 (Higham, 2005). Symmetric m is diagonalized
+ * instead (tridiagonal QL), e^m = q e^d q^T: it takes about half the time,
+ * needs no squarings and the result is made exactly symmetric. Diagonal m is
+ * exponentiated elementwise. Throws std::logic_error if m is not square and
+ * std::invalid_argument if it has infinite or NaN elements
+ *
+ */
+matrix expm(const matrix& m);
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_FUNCTIONS_H_
@@ -0,0 +1,530 @@
+#include "math_instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "math_perf_counters.h"
+#include "math_status.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace math {
+
+namespace detail {
+
+struct op_counters {
+  explicit op_counters(const char* op_name) : name(op_name) {}
+
+  const char* name;
+  std::atomic<std::uint64_t> calls{0};
+  std::atomic<std::uint64_t> flops{0};
+  std::atomic<std::uint64_t> bytes{0};
+  std::atomic<std::uint64_t> allocations{0};
+  std::atomic<std::uint64_t> allocated_bytes{0};
+  std::atomic<std::uint64_t> peak_bytes{0};
+  std::atomic<std::uint64_t> nanoseconds{0};
+};
+
+}  // namespace detail
+
+namespace {
+
+std::mutex& registry_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Deque keeps addresses of counters stable while it grows
+std::deque<detail::op_counters>& registry() {
+  static std::deque<detail::op_counters> counters;
+  return counters;
+}
+
+// Complete event of an operation (with operand sizes) or of a pool task
+struct trace_event {
+  const char* name;
+  std::int64_t start_ns;
+  std::int64_t duration_ns;
+  std::uint64_t thread;
+  bool task;
+  std::uint64_t job;
+  std::size_t chunk;
+  std::size_t shape[detail::kTraceShape];
+  std::size_t rank;
+};
+
+std::atomic<bool> tracing_on{false};
+
+// Ring buffer of events, or write buffer of the trace file if it is open
+struct trace_buffer {
+  std::mutex mutex;
+  std::vector<trace_event> events;
+  std::size_t recorded = 0;  // events recorded since start
+  std::ofstream file;
+  bool file_comma = false;
+};
+
+trace_buffer& trace() {
+  static trace_buffer buffer;
+  return buffer;
+}
+
+std::uint64_t process_id() {
+#if defined(__unix__) || defined(__APPLE__)
+  return std::uint64_t(getpid());
+#else
+  return 0;
+#endif
+}
+
+std::uint64_t thread_id() {
+#if defined(__linux__)
+  thread_local std::uint64_t id = std::uint64_t(syscall(SYS_gettid));
+#else
+  static std::atomic<std::uint64_t> next{1};
+  thread_local std::uint64_t id = next.fetch_add(1);
+#endif
+  return id;
+}
+
+std::int64_t nanoseconds(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             t.time_since_epoch())
+      .count();
+}
+
+void write_event(std::ostream& out, const trace_event& e, std::uint64_t pid) {
+  out << "{\"name\": \"" << e.name << "\", \"cat\": \""
+      << (e.task ? "pool" : "op") << "\", \"ph\": \"X\", \"ts\": "
+      << std::fixed << std::setprecision(3) << double(e.start_ns) * 1e-3
+      << ", \"dur\": " << double(e.duration_ns) * 1e-3 << std::defaultfloat
+      << ", \"pid\": " << pid << ", \"tid\": " << e.thread
+      << ", \"args\": {";
+  if (e.task) {
+    out << "\"job\": " << e.job << ", \"chunk\": " << e.chunk;
+  } else {
+    out << "\"shape\": [";
+    for (std::size_t i = 0; i < e.rank; ++i) {
+      out << (i ? ", " : "") << e.shape[i];
+    }
+    out << ']';
+  }
+  out << "}}";
+}
+
+// Appends buffered events to the trace file, buffer lock must be held
+void flush_trace_file(trace_buffer& buffer) {
+  std::uint64_t pid = process_id();
+  for (std::size_t i = 0; i < buffer.recorded; ++i) {
+    buffer.file << (buffer.file_comma ? ",\n" : "\n");
+    write_event(buffer.file, buffer.events[i], pid);
+    buffer.file_comma = true;
+  }
+  buffer.recorded = 0;
+}
+
+void record(const trace_event& e) {
+  trace_buffer& buffer = trace();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  if (!tracing_on.load(std::memory_order_relaxed)) return;
+
+  if (buffer.file.is_open() && buffer.recorded == buffer.events.size()) {
+    flush_trace_file(buffer);
+  }
+  buffer.events[buffer.recorded % buffer.events.size()] = e;
+  ++buffer.recorded;
+}
+
+void start(std::size_t capacity, const std::string* path) {
+  trace_buffer& buffer = trace();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+
+  if (buffer.file.is_open()) {
+    flush_trace_file(buffer);
+    buffer.file << "\n]\n";
+    buffer.file.close();
+  }
+  if (path) {
+    buffer.file.open(*path);
+    if (!buffer.file) {
+      tracing_on = false;
+      MATH_THROW(std::runtime_error("Can not open trace file " + *path));
+    }
+    buffer.file << '[';
+    buffer.file_comma = false;
+  }
+
+  buffer.events.assign(std::max<std::size_t>(1, capacity), trace_event());
+  buffer.recorded = 0;
+  tracing_on = instrumentation::enabled();
+}
+
+std::atomic<bool> hardware_on{false};
+
+// Number of operations running on this thread, ones called by another
+// operation are not counted
+thread_local std::size_t op_depth = 0;
+
+struct hardware_registry {
+  std::mutex mutex;
+  std::map<std::pair<const detail::op_counters*, std::size_t>,
+           instrumentation::hardware_stats>
+      stats;
+};
+
+hardware_registry& hardware() {
+  static hardware_registry registry;
+  return registry;
+}
+
+std::size_t size_bucket(const std::size_t* shape, std::size_t rank) {
+  std::size_t largest = rank ? *std::max_element(shape, shape + rank) : 0;
+  std::size_t bucket = 1;
+  while (bucket < largest) bucket *= 2;
+  return bucket;
+}
+
+// Drops the sample if its entry can not be allocated
+void add_hardware(const detail::op_counters* counters, std::size_t bucket,
+                  const detail::hardware_sample& begin,
+                  const detail::hardware_sample& end) noexcept {
+  // counters shared with other events only ran a part of the time
+  std::uint64_t enabled = end.enabled - begin.enabled;
+  std::uint64_t running = end.running - begin.running;
+  double scale = running && running < enabled ? double(enabled) / running : 1;
+
+  std::uint64_t delta[detail::kHardwareEvents];
+  for (std::size_t i = 0; i < detail::kHardwareEvents; ++i) {
+    delta[i] = std::uint64_t(
+        std::llround(double(end.values[i] - begin.values[i]) * scale));
+  }
+
+  hardware_registry& registry = hardware();
+#if MATH_EXCEPTIONS
+  try {
+#endif
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    instrumentation::hardware_stats& s = registry.stats[{counters, bucket}];
+    ++s.calls;
+    s.cycles += delta[detail::hardware_cycles];
+    s.instructions += delta[detail::hardware_instructions];
+    s.l1d_misses += delta[detail::hardware_l1d_misses];
+    s.llc_misses += delta[detail::hardware_llc_misses];
+    s.branch_misses += delta[detail::hardware_branch_misses];
+#if MATH_EXCEPTIONS
+  } catch (...) {
+  }
+#endif
+}
+
+// Events per thousand instructions
+double per_kilo(std::uint64_t events, std::uint64_t instructions) {
+  return instructions ? 1000.0 * double(events) / double(instructions) : 0;
+}
+
+}  // namespace
+
+namespace instrumentation {
+
+snapshot_type snapshot() {
+  std::lock_guard<std::mutex> lock(registry_mutex());
+
+  snapshot_type result;
+  for (const auto& c : registry()) {
+    std::uint64_t calls = c.calls.load(std::memory_order_relaxed);
+    if (!calls) continue;
+
+    // operations sharing a name are reported together
+    op_stats& stats = result[c.name];
+    stats.calls += calls;
+    stats.flops += c.flops.load(std::memory_order_relaxed);
+    stats.bytes += c.bytes.load(std::memory_order_relaxed);
+    stats.allocations += c.allocations.load(std::memory_order_relaxed);
+    stats.allocated_bytes += c.allocated_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = std::max<std::uint64_t>(
+        stats.peak_bytes, c.peak_bytes.load(std::memory_order_relaxed));
+    stats.nanoseconds += c.nanoseconds.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+void reset() {
+  std::lock_guard<std::mutex> lock(registry_mutex());
+
+  for (auto& c : registry()) {
+    c.calls = 0;
+    c.flops = 0;
+    c.bytes = 0;
+    c.allocations = 0;
+    c.allocated_bytes = 0;
+    c.peak_bytes = 0;
+    c.nanoseconds = 0;
+  }
+
+  std::lock_guard<std::mutex> hardware_lock(hardware().mutex);
+  hardware().stats.clear();
+}
+
+void dump_text(std::ostream& out, const snapshot_type& stats) {
+  out << std::left << std::setw(36) << "operation" << std::right
+      << std::setw(12) << "calls" << std::setw(16) << "flops"
+      << std::setw(16) << "bytes" << std::setw(12) << "allocs"
+      << std::setw(16) << "alloc bytes" << std::setw(16) << "peak bytes"
+      << std::setw(14) << "time ms"
+      << '\n';
+
+  for (const auto& entry : stats) {
+    const op_stats& s = entry.second;
+    out << std::left << std::setw(36) << entry.first << std::right
+        << std::setw(12) << s.calls << std::setw(16) << s.flops
+        << std::setw(16) << s.bytes << std::setw(12) << s.allocations
+        << std::setw(16) << s.allocated_bytes << std::setw(16)
+        << s.peak_bytes << std::fixed
+        << std::setprecision(3) << std::setw(14) << double(s.nanoseconds) * 1e-6
+        << std::defaultfloat << '\n';
+  }
+}
+
+void dump_json(std::ostream& out, const snapshot_type& stats) {
+  out << '{';
+  bool comma = false;
+  for (const auto& entry : stats) {
+    const op_stats& s = entry.second;
+    out << (comma ? ",\n  " : "\n  ") << '"' << entry.first << "\": {"
+        << "\"calls\": " << s.calls << ", \"flops\": " << s.flops
+        << ", \"bytes\": " << s.bytes << ", \"allocations\": " << s.allocations
+        << ", \"allocated_bytes\": " << s.allocated_bytes
+        << ", \"peak_bytes\": " << s.peak_bytes
+        << ", \"nanoseconds\": " << s.nanoseconds << '}';
+    comma = true;
+  }
+  out << (comma ? "\n}\n" : "}\n");
+}
+
+void start_tracing(std::size_t capacity) { start(capacity, nullptr); }
+
+void start_tracing(const std::string& path, std::size_t capacity) {
+  start(capacity, &path);
+}
+
+void stop_tracing() {
+  trace_buffer& buffer = trace();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  tracing_on = false;
+
+  if (buffer.file.is_open()) {
+    flush_trace_file(buffer);
+    buffer.file << "\n]\n";
+    buffer.file.close();
+  }
+}
+
+bool tracing() noexcept { return tracing_on.load(std::memory_order_relaxed); }
+
+void write_trace(std::ostream& out) {
+  trace_buffer& buffer = trace();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+
+  std::size_t capacity = buffer.events.size();
+  std::size_t count = std::min(buffer.recorded, capacity);
+  std::size_t first = buffer.recorded - count;
+  std::uint64_t pid = process_id();
+
+  out << "{\"traceEvents\": [";
+  for (std::size_t i = 0; i < count; ++i) {
+    out << (i ? ",\n" : "\n");
+    write_event(out, buffer.events[(first + i) % capacity], pid);
+  }
+  out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+bool start_hardware_counters() {
+  detail::hardware_sample sample;
+  if (!enabled() || !detail::read_hardware_counters(&sample)) return false;
+
+  hardware_on = true;
+  return true;
+}
+
+void stop_hardware_counters() { hardware_on = false; }
+
+bool hardware_counters() noexcept {
+  return hardware_on.load(std::memory_order_relaxed);
+}
+
+hardware_snapshot_type hardware_snapshot() {
+  hardware_registry& registry = hardware();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  hardware_snapshot_type result;
+  for (const auto& entry : registry.stats) {
+    hardware_stats& s = result[{entry.first.first->name, entry.first.second}];
+    const hardware_stats& add = entry.second;
+    s.calls += add.calls;
+    s.cycles += add.cycles;
+    s.instructions += add.instructions;
+    s.l1d_misses += add.l1d_misses;
+    s.llc_misses += add.llc_misses;
+    s.branch_misses += add.branch_misses;
+  }
+  return result;
+}
+
+void dump_hardware_text(std::ostream& out,
+                        const hardware_snapshot_type& stats) {
+  out << std::left << std::setw(36) << "operation" << std::right
+      << std::setw(8) << "size" << std::setw(10) << "calls" << std::setw(16)
+      << "cycles" << std::setw(16) << "instructions" << std::setw(7) << "IPC"
+      << std::setw(9) << "L1D/ki" << std::setw(9) << "LLC/ki" << std::setw(9)
+      << "br/ki" << '\n';
+
+  for (const auto& entry : stats) {
+    const hardware_stats& s = entry.second;
+    double ipc = s.cycles ? double(s.instructions) / double(s.cycles) : 0;
+    out << std::left << std::setw(36) << entry.first.first << std::right
+        << std::setw(8) << entry.first.second << std::setw(10) << s.calls
+        << std::setw(16) << s.cycles << std::setw(16) << s.instructions
+        << std::fixed << std::setprecision(2) << std::setw(7) << ipc
+        << std::setw(9) << per_kilo(s.l1d_misses, s.instructions)
+        << std::setw(9) << per_kilo(s.llc_misses, s.instructions)
+        << std::setw(9) << per_kilo(s.branch_misses, s.instructions)
+        << std::defaultfloat << '\n';
+  }
+}
+
+void dump_hardware_json(std::ostream& out,
+                        const hardware_snapshot_type& stats) {
+  out << '[';
+  bool comma = false;
+  for (const auto& entry : stats) {
+    const hardware_stats& s = entry.second;
+    out << (comma ? ",\n  " : "\n  ") << "{\"operation\": \""
+        << entry.first.first << "\", \"size\": " << entry.first.second
+        << ", \"calls\": " << s.calls << ", \"cycles\": " << s.cycles
+        << ", \"instructions\": " << s.instructions
+        << ", \"l1d_misses\": " << s.l1d_misses
+        << ", \"llc_misses\": " << s.llc_misses
+        << ", \"branch_misses\": " << s.branch_misses << '}';
+    comma = true;
+  }
+  out << (comma ? "\n]\n" : "]\n");
+}
+
+}  // namespace instrumentation
+
+namespace detail {
+
+op_counters* register_op(const char* name) noexcept {
+#if MATH_EXCEPTIONS
+  try {
+#endif
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().emplace_back(name);
+    return &registry().back();
+#if MATH_EXCEPTIONS
+  } catch (...) {
+    static op_counters unregistered("unregistered");
+    return &unregistered;
+  }
+#endif
+}
+
+op_scope::op_scope(op_counters* counters, double flops, double bytes,
+                   std::initializer_list<std::size_t> shape) noexcept
+    : counters_(counters),
+      start_(std::chrono::steady_clock::now()),
+      allocations_(thread_allocations()),
+      storage_(push_storage_mark()),
+      shape_(),
+      rank_(std::min(shape.size(), kTraceShape)),
+      hardware_(),
+      hardware_valid_(false),
+      nested_(op_depth++ != 0) {
+  std::copy_n(shape.begin(), rank_, shape_);
+  if (nested_) return;
+
+  counters_->calls.fetch_add(1, std::memory_order_relaxed);
+  counters_->flops.fetch_add(std::uint64_t(flops), std::memory_order_relaxed);
+  counters_->bytes.fetch_add(std::uint64_t(bytes), std::memory_order_relaxed);
+
+  // read last to leave bookkeeping above out of the counted range
+  if (instrumentation::hardware_counters()) {
+    hardware_valid_ = read_hardware_counters(&hardware_);
+  }
+}
+
+op_scope::~op_scope() {
+  --op_depth;
+  if (hardware_valid_ && instrumentation::hardware_counters()) {
+    hardware_sample sample;
+    if (read_hardware_counters(&sample)) {
+      add_hardware(counters_, size_bucket(shape_, rank_), hardware_, sample);
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  std::uint64_t peak = pop_storage_mark(storage_);
+  if (!nested_) add_call(end - start_, peak);
+
+  if (instrumentation::tracing()) {
+    trace_event e{counters_->name, nanoseconds(start_),
+                  nanoseconds(end) - nanoseconds(start_), thread_id(), false,
+                  0, 0, {}, rank_};
+    std::copy_n(shape_, rank_, e.shape);
+    record(e);
+  }
+}
+
+void op_scope::add_call(std::chrono::steady_clock::duration elapsed,
+                        std::uint64_t peak) noexcept {
+  counters_->nanoseconds.fetch_add(
+      std::uint64_t(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()),
+      std::memory_order_relaxed);
+  thread_allocation_stats allocations = thread_allocations();
+  counters_->allocations.fetch_add(
+      allocations.allocations - allocations_.allocations,
+      std::memory_order_relaxed);
+  counters_->allocated_bytes.fetch_add(allocations.bytes - allocations_.bytes,
+                                       std::memory_order_relaxed);
+
+  std::uint64_t old = counters_->peak_bytes.load(std::memory_order_relaxed);
+  while (old < peak && !counters_->peak_bytes.compare_exchange_weak(
+                           old, peak, std::memory_order_relaxed)) {
+  }
+}
+
+std::uint64_t new_job_id() noexcept {
+  static std::atomic<std::uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+task_scope::task_scope(std::uint64_t job, std::size_t chunk) noexcept
+    : job_(job), chunk_(chunk), start_(std::chrono::steady_clock::now()) {}
+
+task_scope::~task_scope() {
+  if (!instrumentation::tracing()) return;
+
+  std::int64_t start = nanoseconds(start_);
+  record({"task", start,
+          nanoseconds(std::chrono::steady_clock::now()) - start, thread_id(),
+          true, job_, chunk_, {}, 0});
+}
+
+}  // namespace detail
+
+}  // namespace math
@@ -0,0 +1,257 @@
+#ifndef CPP_MATH_LIBRARY_MATH_INSTRUMENTATION_H_
+#define CPP_MATH_LIBRARY_MATH_INSTRUMENTATION_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "math_latency.h"
+#include "math_memory.h"
+
+// Operation counters and trace events are compiled in only when the library
+// is built with -DMATH_INSTRUMENTATION. Latency histograms (math_latency.h)
+// are compiled into every build: without the flag MATH_INSTRUMENT_OP only
+// records latency, which costs one relaxed atomic load while recording is
+// off. Its other arguments are not evaluated, snapshot() is always empty and
+// tracing never starts.
+
+namespace math {
+
+namespace instrumentation {
+
+// Returns true if the library is built with MATH_INSTRUMENTATION
+constexpr bool enabled() noexcept {
+#ifdef MATH_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Accumulated counters of one public operation. Every call made by the
+ * user is counted once: operations called by another operation on the same
+ * thread (operator+ through operator+=) add their work to the outer one only,
+ * trace events are still recorded for them. Allocations of library storage
+ * (matrices, vectors and kernel temporaries, see math_memory.h) and storage
+ * peaks are counted on the calling thread only; other builds measure peaks
+ * with memory_peak_scope.
+ *
+ */
+struct op_stats {
+  std::uint64_t calls = 0;
+  std::uint64_t flops = 0;            // estimated floating point operations
+  std::uint64_t bytes = 0;            // estimated compulsory memory traffic
+  std::uint64_t allocations = 0;      // library storage allocations
+  std::uint64_t allocated_bytes = 0;  // bytes of library storage allocated
+  std::uint64_t peak_bytes = 0;       // most library storage held by one call
+  std::uint64_t nanoseconds = 0;      // wall time
+};
+
+using snapshot_type = std::map<std::string, op_stats>;
+
+// Returns counters of all operations called at least once since reset()
+snapshot_type snapshot();
+
+// Zeroes all counters, including hardware ones
+void reset();
+
+// Writes snapshot as table, one operation per row
+void dump_text(std::ostream& out, const snapshot_type& stats);
+
+// Writes snapshot as JSON object keyed by operation names
+void dump_json(std::ostream& out, const snapshot_type& stats);
+
+// Default number of trace events kept in memory
+constexpr std::size_t kTraceCapacity = std::size_t(1) << 16;
+
+/**
+ * @brief Starts recording trace events of operations (with operand sizes) and
+ * of thread pool tasks (with job and chunk ids) into a ring buffer, the oldest
+ * events are overwritten when it is full. Restarting clears the buffer.
+ *
+ * @param capacity number of events kept, at least 1
+ */
+void start_tracing(std::size_t capacity = kTraceCapacity);
+
+/**
+ * @brief Starts recording trace events into file path in Chrome trace JSON
+ * array format. Events are buffered and appended to the file whenever the
+ * buffer is full and on stop_tracing(), so none are lost. Throws
+ * std::runtime_error if the file can not be opened
+ *
+ */
+void start_tracing(const std::string& path,
+                   std::size_t capacity = kTraceCapacity);
+
+// Stops recording, flushes and closes trace file if there is one
+void stop_tracing();
+
+// Returns true between start_tracing() and stop_tracing()
+bool tracing() noexcept;
+
+/**
+ * @brief Writes events held in the ring buffer as Chrome trace JSON object,
+ * loadable by chrome://tracing and Perfetto. Events are complete ("X") events
+ * with timestamps of std::chrono::steady_clock in microseconds and OS thread
+ * ids, so they line up with spans of other tracers of the process
+ *
+ */
+void write_trace(std::ostream& out);
+
+/**
+ * @brief Hardware counters accumulated over calls of one operation in one
+ * size bucket. Counters are read on the calling thread, work of thread pool
+ * workers is not included, so kernels are best measured with one thread.
+ * Values are scaled up if the kernel multiplexed counters with other events.
+ *
+ */
+struct hardware_stats {
+  std::uint64_t calls = 0;
+  std::uint64_t cycles = 0;
+  std::uint64_t instructions = 0;
+  std::uint64_t l1d_misses = 0;  // L1 data cache read misses
+  std::uint64_t llc_misses = 0;  // last level cache misses
+  std::uint64_t branch_misses = 0;
+};
+
+// Operation name and size bucket: the smallest power of two not less than the
+// largest operand size
+using hardware_key = std::pair<std::string, std::size_t>;
+
+using hardware_snapshot_type = std::map<hardware_key, hardware_stats>;
+
+/**
+ * @brief Starts reading Linux perf counters (cycles, instructions, L1 data
+ * and last level cache misses, branch misses) around every operation. Returns
+ * false if the library is built without MATH_INSTRUMENTATION or counters are
+ * unavailable, e.g. forbidden by kernel.perf_event_paranoid
+ *
+ */
+bool start_hardware_counters();
+
+// Stops reading hardware counters, accumulated values are kept
+void stop_hardware_counters();
+
+// Returns true between successful start_hardware_counters() and stop
+bool hardware_counters() noexcept;
+
+// Returns hardware counters of all operations and size buckets since reset()
+hardware_snapshot_type hardware_snapshot();
+
+// Writes hardware snapshot as table with IPC and misses per kilo-instruction
+void dump_hardware_text(std::ostream& out,
+                        const hardware_snapshot_type& stats);
+
+// Writes hardware snapshot as JSON array of entries
+void dump_hardware_json(std::ostream& out,
+                        const hardware_snapshot_type& stats);
+
+}  // namespace instrumentation
+
+namespace detail {
+
+// Hardware events read around operations, in order of hardware_stats fields
+enum hardware_event : std::size_t {
+  hardware_cycles,
+  hardware_instructions,
+  hardware_l1d_misses,
+  hardware_llc_misses,
+  hardware_branch_misses
+};
+
+constexpr std::size_t kHardwareEvents = 5;
+
+// Raw counter values with times the counters were enabled and running
+struct hardware_sample {
+  std::uint64_t values[kHardwareEvents];
+  std::uint64_t enabled;
+  std::uint64_t running;
+};
+
+struct op_counters;
+
+// Returns counters of operation with given name, creating them once. Counters
+// that are never reported if they can not be created, so operations marked
+// noexcept stay so in instrumented builds
+op_counters* register_op(const char* name) noexcept;
+
+// Maximum number of operand sizes kept in trace events
+constexpr std::size_t kTraceShape = 4;
+
+/**
+ * @brief Adds a call with its wall time and allocations to counters on
+ * destruction unless it is nested in another scope of the thread, and records
+ * trace event if tracing is on
+ *
+ */
+class op_scope {
+ public:
+  op_scope(op_counters* counters, double flops, double bytes,
+           std::initializer_list<std::size_t> shape) noexcept;
+  ~op_scope();
+
+  op_scope(const op_scope&) = delete;
+  op_scope& operator=(const op_scope&) = delete;
+
+ private:
+  // Adds time, allocations and storage peak of a call that is not nested
+  void add_call(std::chrono::steady_clock::duration elapsed,
+                std::uint64_t peak) noexcept;
+
+  op_counters* counters_;
+  std::chrono::steady_clock::time_point start_;
+  thread_allocation_stats allocations_;
+  storage_mark storage_;
+  std::size_t shape_[kTraceShape];
+  std::size_t rank_;
+  hardware_sample hardware_;
+  bool hardware_valid_;
+  bool nested_;
+};
+
+// Returns unique id of thread pool job
+std::uint64_t new_job_id() noexcept;
+
+// Records trace event of one chunk of thread pool job on destruction
+class task_scope {
+ public:
+  task_scope(std::uint64_t job, std::size_t chunk) noexcept;
+  ~task_scope();
+
+  task_scope(const task_scope&) = delete;
+  task_scope& operator=(const task_scope&) = delete;
+
+ private:
+  std::uint64_t job_;
+  std::size_t chunk_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace detail
+
+}  // namespace math
+
+// MATH_INSTRUMENT_OP(name, flops, bytes, sizes...) counts the enclosing
+// operation, sizes of its operands are shown in trace events
+#define MATH_LATENCY_OP(name)                               \
+  static ::math::detail::latency_op math_latency_op_(name); \
+  ::math::detail::latency_scope math_latency_scope_(math_latency_op_)
+
+#ifdef MATH_INSTRUMENTATION
+#define MATH_INSTRUMENT_OP(name, flops, bytes, ...)                         \
+  static ::math::detail::op_counters* const math_op_counters_ =             \
+      ::math::detail::register_op(name);                                    \
+  ::math::detail::op_scope math_op_scope_(math_op_counters_, double(flops), \
+                                          double(bytes), {__VA_ARGS__});    \
+  MATH_LATENCY_OP(name)
+#else
+#define MATH_INSTRUMENT_OP(name, flops, bytes, ...) MATH_LATENCY_OP(name)
+#endif
+
+#endif  // CPP_MATH_LIBRARY_MATH_INSTRUMENTATION_H_
@@ -0,0 +1,121 @@
+#include "math_inverse_update.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "math_instrumentation.h"
+#include "math_blas.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+void check_sizes(const matrix& inverse, matrix::size_type u_rows,
+                 matrix::size_type v_rows) {
+  if (inverse.rows() != inverse.columns()) {
+    MATH_THROW(std::logic_error("Matrix is not square"));
+  }
+  if (u_rows != inverse.rows() || v_rows != inverse.rows()) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: inverse.rows = " + std::to_string(inverse.rows()) +
+        ", u.rows = " + std::to_string(u_rows) +
+        ", v.rows = " + std::to_string(v_rows)));
+  }
+}
+
+}  // namespace
+
+void sherman_morrison_update(matrix& inverse, const vector& u,
+                             const vector& v) {
+  MATH_INSTRUMENT_OP("sherman_morrison_update",
+                     6.0 * inverse.rows() * inverse.columns(),
+                     32.0 * inverse.rows() * inverse.columns(), inverse.rows());
+  check_sizes(inverse, u.size(), v.size());
+
+  // (a + u v^T)^-1 = a^-1 - a^-1 u v^T a^-1 / (1 + v^T a^-1 u)
+  vector w(u.size()), z(v.size());
+  gemv(1, inverse, u, 0, w);
+  gemv(1, inverse, v, 0, z, true);
+
+  double denominator = 1 + dot(v, w);
+  if (denominator == 0 || !std::isfinite(denominator)) {
+    MATH_THROW(std::logic_error("Updated matrix is singular"));
+  }
+
+  ger(-1 / denominator, w, z, inverse);
+}
+
+void woodbury_update(matrix& inverse, const matrix& u, const matrix& v) {
+  MATH_INSTRUMENT_OP("woodbury_update",
+                     6.0 * inverse.rows() * inverse.columns() * u.columns(),
+                     32.0 * inverse.rows() * inverse.columns(), inverse.rows(),
+                     u.columns());
+  check_sizes(inverse, u.rows(), v.rows());
+  if (u.columns() != v.columns()) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: u.columns = " + std::to_string(u.columns()) +
+        ", v.columns = " + std::to_string(v.columns())));
+  }
+
+  // (a + u v^T)^-1 = a^-1 - a^-1 u (i + v^T a^-1 u)^-1 v^T a^-1
+  matrix v_transposed = v.transposed();
+  matrix w = inverse * u;
+  matrix capacitance = v_transposed * w;
+  for (matrix::size_type i = 0; i < capacitance.rows(); ++i) {
+    capacitance(i, i) += 1;
+  }
+
+  matrix correction;
+#if MATH_EXCEPTIONS
+  try {
+    correction = lu_factorization(capacitance).solve(v_transposed * inverse);
+  } catch (const std::logic_error&) {
+    throw std::logic_error("Updated matrix is singular");
+  }
+#else
+  correction = lu_factorization(capacitance).solve(v_transposed * inverse);
+#endif
+
+  rank_k_update(-1, w, correction.transposed(), inverse);
+}
+
+updatable_inverse::updatable_inverse(const matrix& a, double drift_tolerance)
+    : inverse_(lu_factorization(a).inverse()), monitor_(a, drift_tolerance) {}
+
+const matrix& updatable_inverse::inverse() const noexcept { return inverse_; }
+
+void updatable_inverse::update(const vector& u, const vector& v) {
+  sherman_morrison_update(inverse_, u, v);
+  monitor_.update(u, v);
+  check_drift();
+}
+
+void updatable_inverse::update(const matrix& u, const matrix& v) {
+  woodbury_update(inverse_, u, v);
+  monitor_.update(u, v);
+  check_drift();
+}
+
+double updatable_inverse::drift() const noexcept { return monitor_.drift(); }
+
+updatable_inverse::size_type updatable_inverse::refactorizations()
+    const noexcept {
+  return monitor_.refactorizations();
+}
+
+void updatable_inverse::check_drift() {
+  auto solve = [this](const vector& b) {
+    vector x(b.size());
+    gemv(1, inverse_, b, 0, x);
+    return x;
+  };
+
+  if (monitor_.exceeded(solve)) {
+    inverse_ = lu_factorization(monitor_.source()).inverse();
+    monitor_.refactorized();
+  }
+}
+
+}  // namespace math
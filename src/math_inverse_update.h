@@ -0,0 +1,72 @@
+#ifndef CPP_MATH_LIBRARY_MATH_INVERSE_UPDATE_H_
+#define CPP_MATH_LIBRARY_MATH_INVERSE_UPDATE_H_
+
+#include "math_factorization.h"
+#include "math_matrix.h"
+#include "math_vector.h"
+
+namespace math {
+
+/**
+ * @brief Sherman-Morrison formula: replaces inverse of a with inverse of
+ * a + u * v^T in O(n^2). Throws std::invalid_argument if sizes mismatch and
+ * std::logic_error if updated matrix is singular
+ *
+ * @param inverse inverse of square matrix a
+ */
+void sherman_morrison_update(matrix& inverse, const vector& u,
+                             const vector& v);
+
+/**
+ * @brief Woodbury formula: replaces inverse of a with inverse of a + u * v^T,
+ * where u and v have k columns, in O(n^2 * k). Throws std::invalid_argument if
+ * sizes mismatch and std::logic_error if updated matrix is singular
+ *
+ * @param inverse inverse of square matrix a
+ */
+void woodbury_update(matrix& inverse, const matrix& u, const matrix& v);
+
+/**
+ * @brief Explicit inverse of a matrix kept up to date under low-rank updates.
+ * If drift tolerance is not 0, backward error is checked after every update
+ * and the inverse is recomputed when it exceeds tolerance.
+ *
+ */
+class updatable_inverse {
+ public:
+  using size_type = matrix::size_type;
+
+  /**
+   * @brief Computes inverse of a through LU factorization. Throws
+   * std::logic_error if a is not square or is singular
+   *
+   * @param a matrix to invert
+   * @param drift_tolerance maximum backward error after updates, 0 disables
+   * monitoring
+   */
+  explicit updatable_inverse(const matrix& a, double drift_tolerance = 0);
+
+  const matrix& inverse() const noexcept;
+
+  // Updates inverse to inverse of a + u * v^T
+  void update(const vector& u, const vector& v);
+
+  // Updates inverse to inverse of a + u * v^T for u and v with k columns
+  void update(const matrix& u, const matrix& v);
+
+  // Backward error measured after the last update, 0 after inversion
+  double drift() const noexcept;
+
+  // Number of full inversions triggered by updates
+  size_type refactorizations() const noexcept;
+
+ private:
+  void check_drift();
+
+  matrix inverse_;
+  detail::drift_monitor monitor_;
+};
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_INVERSE_UPDATE_H_
@@ -0,0 +1,255 @@
+#include "math_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "math_parallel.h"
+#include "math_small_kernels.h"
+#include "math_strassen.h"
+#include "math_tuning.h"
+
+namespace math {
+
+namespace detail {
+
+namespace {
+
+// Pairwise sum of the accumulators, keeps rounding error independent of their
+// count growing
+double sum_accumulators(double* acc) noexcept {
+  for (std::size_t width = kAccumulators / 2; width; width /= 2) {
+    for (std::size_t j = 0; j < width; ++j) acc[j] += acc[j + width];
+  }
+  return acc[0];
+}
+
+// Error-free transformation: a * b == product + error exactly
+inline double two_product(double a, double b, double* error) noexcept {
+  double product = a * b;
+#ifdef FP_FAST_FMA
+  *error = std::fma(a, b, -product);
+#else
+  // Veltkamp splitting keeps the kernel vectorizable without hardware fma
+  constexpr double kSplitter = 134217729.0;  // 2^27 + 1
+  double a_big = kSplitter * a, b_big = kSplitter * b;
+  double a_high = a_big - (a_big - a), b_high = b_big - (b_big - b);
+  double a_low = a - a_high, b_low = b - b_high;
+  *error = ((a_high * b_high - product) + a_high * b_low + a_low * b_high) +
+           a_low * b_low;
+#endif
+  return product;
+}
+
+}  // namespace
+
+void axpy_kernel(std::size_t n, double alpha, const double* MATH_RESTRICT x,
+                 double* MATH_RESTRICT y) noexcept {
+  for (std::size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+}
+
+void scal_kernel(std::size_t n, double alpha, double* x) noexcept {
+  for (std::size_t i = 0; i < n; ++i) x[i] *= alpha;
+}
+
+double dot_kernel(std::size_t n, const double* x, const double* y) noexcept {
+  double acc[kAccumulators] = {};
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      acc[j] += x[i + j] * y[i + j];
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) acc[j] += x[i] * y[i];
+
+  return sum_accumulators(acc);
+}
+
+double compensated_dot_kernel(std::size_t n, const double* x, const double* y,
+                              double* error) noexcept {
+  double sums[kAccumulators] = {}, errors[kAccumulators] = {};
+
+  auto accumulate = [&sums, &errors](std::size_t j, double a, double b) {
+    double product_error, sum_error;
+    double product = two_product(a, b, &product_error);
+    sums[j] = two_sum(sums[j], product, &sum_error);
+    errors[j] += product_error + sum_error;
+  };
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      accumulate(j, x[i + j], y[i + j]);
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) accumulate(j, x[i], y[i]);
+
+  double sum = sums[0], sum_error = sum_accumulators(errors);
+  for (std::size_t j = 1; j < kAccumulators; ++j) {
+    double lane_error;
+    sum = two_sum(sum, sums[j], &lane_error);
+    sum_error += lane_error;
+  }
+
+  *error = sum_error;
+  return sum;
+}
+
+double asum_kernel(std::size_t n, const double* x) noexcept {
+  double acc[kAccumulators] = {};
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      acc[j] += std::fabs(x[i + j]);
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) acc[j] += std::fabs(x[i]);
+
+  return sum_accumulators(acc);
+}
+
+double amax_kernel(std::size_t n, const double* x) noexcept {
+  // sums in check[] are finite unless there is NaN, infinity or overflow,
+  // so the maximum needs no NaN test in the loop
+  double acc[kAccumulators] = {}, check[kAccumulators] = {};
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      double value = std::fabs(x[i + j]);
+      acc[j] = acc[j] < value ? value : acc[j];
+      check[j] += value;
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) {
+    double value = std::fabs(x[i]);
+    acc[j] = acc[j] < value ? value : acc[j];
+    check[j] += value;
+  }
+
+  for (std::size_t j = 1; j < kAccumulators; ++j) {
+    acc[0] = acc[0] < acc[j] ? acc[j] : acc[0];
+    check[0] += check[j];
+  }
+  if (std::isfinite(check[0])) return acc[0];
+
+  // rare: infinity or overflow is the maximum unless there is also NaN
+  for (i = 0; i < n; ++i) {
+    if (std::isnan(x[i])) return x[i];
+  }
+  return acc[0];
+}
+
+double scaled_sumsq_kernel(std::size_t n, const double* x,
+                           double scale) noexcept {
+  double acc[kAccumulators] = {};
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      double value = x[i + j] * scale;
+      acc[j] += value * value;
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) {
+    double value = x[i] * scale;
+    acc[j] += value * value;
+  }
+
+  return sum_accumulators(acc);
+}
+
+double relative_pow_sum_kernel(std::size_t n, const double* x, double max,
+                               double p) noexcept {
+  double acc[kAccumulators] = {};
+
+  std::size_t i = 0;
+  for (; i + kAccumulators <= n; i += kAccumulators) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      acc[j] += std::pow(std::fabs(x[i + j]) / max, p);
+    }
+  }
+  for (std::size_t j = 0; i < n; ++i, ++j) {
+    acc[j] += std::pow(std::fabs(x[i]) / max, p);
+  }
+
+  return sum_accumulators(acc);
+}
+
+void rot_kernel(std::size_t n, double* MATH_RESTRICT x, double* MATH_RESTRICT y,
+                double c, double s) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    double xi = x[i], yi = y[i];
+    x[i] = c * xi + s * yi;
+    y[i] = c * yi - s * xi;
+  }
+}
+
+void gemm_kernel(std::size_t m, std::size_t n, std::size_t k,
+                 const double* MATH_RESTRICT a, std::size_t lda,
+                 const double* MATH_RESTRICT b, std::size_t ldb,
+                 double* MATH_RESTRICT c, std::size_t ldc) noexcept {
+  // gemm_columns columns of four rows of c fit into L1, gemm_depth rows of
+  // that many columns of b fit into L2
+  tuning_parameters parameters = tuning();
+  std::size_t columns = parameters.gemm_columns;
+  std::size_t rows = parameters.gemm_depth;
+
+  for (std::size_t jj = 0; jj < n; jj += columns) {
+    std::size_t width = std::min(columns, n - jj);
+    for (std::size_t pp = 0; pp < k; pp += rows) {
+      std::size_t depth = std::min(rows, k - pp);
+      const double* panel = b + pp * ldb + jj;
+
+      std::size_t i = 0;
+      for (; i + 4 <= m; i += 4) {
+        const double* a0 = a + i * lda + pp;
+        double* MATH_RESTRICT c0 = c + i * ldc + jj;
+        double* MATH_RESTRICT c1 = c0 + ldc;
+        double* MATH_RESTRICT c2 = c1 + ldc;
+        double* MATH_RESTRICT c3 = c2 + ldc;
+        for (std::size_t p = 0; p < depth; ++p) {
+          const double* MATH_RESTRICT row = panel + p * ldb;
+          double s0 = a0[p], s1 = a0[lda + p];
+          double s2 = a0[2 * lda + p], s3 = a0[3 * lda + p];
+          for (std::size_t j = 0; j < width; ++j) {
+            c0[j] += s0 * row[j];
+            c1[j] += s1 * row[j];
+            c2[j] += s2 * row[j];
+            c3[j] += s3 * row[j];
+          }
+        }
+      }
+
+      for (; i < m; ++i) {
+        const double* a0 = a + i * lda + pp;
+        double* MATH_RESTRICT c0 = c + i * ldc + jj;
+        for (std::size_t p = 0; p < depth; ++p) {
+          axpy_kernel(width, a0[p], panel + p * ldb, c0);
+        }
+      }
+    }
+  }
+}
+
+void product(std::size_t m, std::size_t k, std::size_t n, const double* a,
+             const double* b, double* c) {
+  if (use_strassen(m, k, n)) {
+    strassen_multiply(n, a, b, c);
+  } else if (auto kernel = find_small_gemm(m, k, n)) {
+    kernel(m, a, b, c);
+  } else {
+    // every thread owns a range of rows of the result
+    parallel_for(m, tuning().gemm_rows_grain,
+                 [&](std::size_t first, std::size_t last) {
+                   std::fill(c + first * n, c + last * n, 0.0);
+                   gemm_kernel(last - first, n, k, a + first * k, k, b, n,
+                               c + first * n, n);
+                 });
+  }
+}
+
+}  // namespace detail
+
+}  // namespace math
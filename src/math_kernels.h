@@ -0,0 +1,104 @@
+#ifndef CPP_MATH_LIBRARY_MATH_KERNELS_H_
+#define CPP_MATH_LIBRARY_MATH_KERNELS_H_
+
+#include <cstddef>
+
+// Internal header with contiguous loop kernels shared by vector, matrix and
+// BLAS routines. Kernels are written with independent accumulators and
+// non-aliasing pointers so the compiler can keep them in SIMD registers.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define MATH_RESTRICT __restrict
+#else
+#define MATH_RESTRICT
+#endif
+
+namespace math {
+
+namespace detail {
+
+// Number of independent accumulators used by reduction kernels
+constexpr std::size_t kAccumulators = 8;
+
+// Number of elements processed by one thread of level-1 routines
+constexpr std::size_t kBlas1Grain = std::size_t(1) << 15;
+
+// y[i] += alpha * x[i]
+void axpy_kernel(std::size_t n, double alpha, const double* MATH_RESTRICT x,
+                 double* MATH_RESTRICT y) noexcept;
+
+// x[i] *= alpha
+void scal_kernel(std::size_t n, double alpha, double* x) noexcept;
+
+// Returns sum of x[i] * y[i]
+double dot_kernel(std::size_t n, const double* x, const double* y) noexcept;
+
+/**
+ * @brief Compensated (Ogita-Rump-Oishi Dot2) sum of x[i] * y[i]: returns
+ * floating point sum and stores accumulated rounding errors of products and
+ * additions into error, so sum + error is as accurate as if computed in twice
+ * the working precision
+ *
+ */
+double compensated_dot_kernel(std::size_t n, const double* x, const double* y,
+                              double* error) noexcept;
+
+// Error-free transformation: a + b == sum + error exactly
+inline double two_sum(double a, double b, double* error) noexcept {
+  double sum = a + b;
+  double z = sum - a;
+  *error = (a - (sum - z)) + (b - z);
+  return sum;
+}
+
+// Returns sum of |x[i]|
+double asum_kernel(std::size_t n, const double* x) noexcept;
+
+// Returns larger of acc and value, NaN once either is NaN
+inline double max_propagating_nan(double acc, double value) noexcept {
+  return value > acc || value != value ? value : acc;
+}
+
+// Returns max of |x[i]|, NaN if any x[i] is NaN, 0 for n == 0
+double amax_kernel(std::size_t n, const double* x) noexcept;
+
+// Returns sum of (x[i] * scale)^2
+double scaled_sumsq_kernel(std::size_t n, const double* x,
+                           double scale) noexcept;
+
+// Returns sum of (|x[i]| / max)^p
+double relative_pow_sum_kernel(std::size_t n, const double* x, double max,
+                               double p) noexcept;
+
+/**
+ * @brief c += a * b for row-major m x k matrix a, k x n matrix b and m x n
+ * matrix c with given leading dimensions (distances between rows). Blocked for
+ * cache: panels of b stay in L2 while four rows of c are updated at once.
+ * Panel sizes come from tuning(), they do not change the result.
+ *
+ */
+void gemm_kernel(std::size_t m, std::size_t n, std::size_t k,
+                 const double* MATH_RESTRICT a, std::size_t lda,
+                 const double* MATH_RESTRICT b, std::size_t ldb,
+                 double* MATH_RESTRICT c, std::size_t ldc) noexcept;
+
+/**
+ * @brief c = a * b for contiguous row-major m x k matrix a and k x n matrix b.
+ * Picks a small matrix kernel, Strassen-Winograd if enabled for the sizes, or
+ * gemm_kernel threaded over rows of c. Previous contents of c are ignored
+ *
+ */
+void product(std::size_t m, std::size_t k, std::size_t n, const double* a,
+             const double* b, double* c);
+
+// x[i], y[i] = c * x[i] + s * y[i], c * y[i] - s * x[i]
+void rot_kernel(std::size_t n, double* MATH_RESTRICT x, double* MATH_RESTRICT y,
+                double c, double s) noexcept;
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_KERNELS_H_
@@ -0,0 +1,376 @@
+#include "math_latency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <new>
+
+#include "math_status.h"
+
+namespace math {
+
+namespace latency {
+
+namespace {
+
+// log2(kSubBuckets)
+constexpr int kSubBucketBits = 5;
+
+// Operations with larger ids are not recorded
+constexpr std::size_t kMaxOps = 256;
+
+int floor_log2(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(value);
+#else
+  int result = 0;
+  while (value >>= 1) ++result;
+  return result;
+#endif
+}
+
+}  // namespace
+
+std::size_t histogram::bucket_index(std::uint64_t ns) noexcept {
+  ns = std::min(ns, kMaxNanoseconds - 1);
+  if (ns < 2 * kSubBuckets) return std::size_t(ns);
+
+  // ns >> shift is in [kSubBuckets, 2 * kSubBuckets)
+  int shift = floor_log2(ns) - kSubBucketBits;
+  return std::size_t(shift) * kSubBuckets + std::size_t(ns >> shift);
+}
+
+std::uint64_t histogram::bucket_lower_ns(std::size_t bucket) noexcept {
+  if (bucket < 2 * kSubBuckets) return bucket;
+
+  std::size_t shift = bucket / kSubBuckets - 1;
+  return std::uint64_t(bucket - shift * kSubBuckets) << shift;
+}
+
+std::uint64_t histogram::bucket_upper_ns(std::size_t bucket) noexcept {
+  if (bucket < 2 * kSubBuckets) return bucket;
+
+  std::size_t shift = bucket / kSubBuckets - 1;
+  return (std::uint64_t(bucket - shift * kSubBuckets + 1) << shift) - 1;
+}
+
+void histogram::record(std::uint64_t ns, std::uint64_t times) {
+  if (!times) return;
+  if (counts_.empty()) counts_.assign(kBuckets, 0);
+
+  counts_[bucket_index(ns)] += times;
+  min_ = count_ ? std::min(min_, ns) : ns;
+  max_ = std::max(max_, ns);
+  count_ += times;
+  sum_ += ns * times;
+}
+
+void histogram::merge(const histogram& other) {
+  if (!other.count_) return;
+  if (counts_.empty()) counts_.assign(kBuckets, 0);
+
+  for (std::size_t i = 0; i < kBuckets; ++i) counts_[i] += other.counts_[i];
+  min_ = count_ ? std::min(min_, other.min_) : other.min_;
+  max_ = std::max(max_, other.max_);
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+std::uint64_t histogram::count() const noexcept { return count_; }
+
+std::uint64_t histogram::sum_ns() const noexcept { return sum_; }
+
+std::uint64_t histogram::min_ns() const noexcept { return min_; }
+
+std::uint64_t histogram::max_ns() const noexcept { return max_; }
+
+double histogram::mean_ns() const noexcept {
+  return count_ ? double(sum_) / double(count_) : 0;
+}
+
+std::uint64_t histogram::percentile_ns(double q) const noexcept {
+  if (!count_) return 0;
+
+  q = std::min(1.0, std::max(0.0, q));
+  std::uint64_t rank = std::max<std::uint64_t>(
+      1, std::uint64_t(std::ceil(q * double(count_))));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(bucket_upper_ns(i), max_);
+  }
+  return max_;
+}
+
+std::uint64_t histogram::count_at_or_below(std::uint64_t ns) const noexcept {
+  std::uint64_t result = 0;
+  for (std::size_t i = 0; i < counts_.size() && bucket_upper_ns(i) <= ns;
+       ++i) {
+    result += counts_[i];
+  }
+  return result;
+}
+
+std::vector<std::pair<std::uint64_t, std::uint64_t>> histogram::buckets()
+    const {
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> result;
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i]) result.emplace_back(bucket_upper_ns(i), counts_[i]);
+  }
+  return result;
+}
+
+// Histogram of one operation written by its thread only, so updates are
+// relaxed loads and stores that snapshot() may read at any time; reset()
+// leaves clearing to the thread too
+struct thread_histogram {
+  std::atomic<std::uint64_t> counts[histogram::kBuckets] = {};
+  std::atomic<std::uint64_t> sum{0};
+  std::atomic<std::uint64_t> min{std::numeric_limits<std::uint64_t>::max()};
+  std::atomic<std::uint64_t> max{0};
+
+  void record(std::uint64_t ns) noexcept {
+    add(counts[histogram::bucket_index(ns)], 1);
+    add(sum, ns);
+    if (ns < min.load(std::memory_order_relaxed)) {
+      min.store(ns, std::memory_order_relaxed);
+    }
+    if (ns > max.load(std::memory_order_relaxed)) {
+      max.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  void add_to(histogram& target) const {
+    histogram h;
+    h.counts_.assign(histogram::kBuckets, 0);
+    for (std::size_t i = 0; i < histogram::kBuckets; ++i) {
+      h.counts_[i] = counts[i].load(std::memory_order_relaxed);
+      h.count_ += h.counts_[i];
+    }
+    if (!h.count_) return;
+
+    h.sum_ = sum.load(std::memory_order_relaxed);
+    h.min_ = min.load(std::memory_order_relaxed);
+    h.max_ = max.load(std::memory_order_relaxed);
+    target.merge(h);
+  }
+
+  void clear() noexcept {
+    for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    min.store(std::numeric_limits<std::uint64_t>::max(),
+              std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static void add(std::atomic<std::uint64_t>& counter,
+                  std::uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+};
+
+namespace {
+
+// Number of reset() calls, histograms of older generations are stale
+std::atomic<std::uint64_t> reset_epoch{0};
+
+// Histograms of all operations recorded by one thread, allocated on first use
+struct thread_histograms {
+  std::atomic<thread_histogram*> ops[kMaxOps] = {};
+  std::atomic<std::uint64_t> epoch{0};  // generation of ops, set by the thread
+};
+
+struct latency_registry {
+  std::mutex mutex;
+  std::deque<std::string> names;  // indexed by operation id
+  std::vector<thread_histograms*> threads;
+  std::map<std::size_t, histogram> exited;  // merged from exited threads
+};
+
+latency_registry& registry() {
+  static latency_registry instance;
+  return instance;
+}
+
+// Registers histograms of the calling thread and merges them into the ones of
+// exited threads when it exits. record_latency() is noexcept: a thread that
+// can not be registered records nothing, values that can not be merged are
+// dropped
+class thread_slot {
+ public:
+  thread_slot() noexcept {
+#if MATH_EXCEPTIONS
+    try {
+#endif
+      latency_registry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      histograms_.epoch.store(reset_epoch.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+      r.threads.push_back(&histograms_);
+      registered_ = true;
+#if MATH_EXCEPTIONS
+    } catch (...) {
+    }
+#endif
+  }
+
+  ~thread_slot() {
+    if (!registered_) return;
+
+    latency_registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.erase(
+        std::find(r.threads.begin(), r.threads.end(), &histograms_));
+    bool current = histograms_.epoch.load(std::memory_order_relaxed) ==
+                   reset_epoch.load(std::memory_order_relaxed);
+    for (std::size_t op = 0; op < kMaxOps; ++op) {
+      thread_histogram* h = histograms_.ops[op].load();
+      if (!h) continue;
+      if (current) merge_exited(r, op, *h);
+      delete h;
+    }
+  }
+
+  thread_slot(const thread_slot&) = delete;
+  thread_slot& operator=(const thread_slot&) = delete;
+
+  // Returns histogram of operation, nullptr if it can not be allocated.
+  // Clears histograms of the thread first if reset() was called since they
+  // were last used: only this thread writes them
+  thread_histogram* get(std::size_t op) noexcept {
+    if (!registered_) return nullptr;
+
+    std::uint64_t epoch = reset_epoch.load(std::memory_order_relaxed);
+    if (histograms_.epoch.load(std::memory_order_relaxed) != epoch) {
+      for (auto& ops : histograms_.ops) {
+        thread_histogram* stale = ops.load(std::memory_order_relaxed);
+        if (stale) stale->clear();
+      }
+      histograms_.epoch.store(epoch, std::memory_order_release);
+    }
+
+    thread_histogram* h = histograms_.ops[op].load(std::memory_order_relaxed);
+    if (!h) {
+      h = new (std::nothrow) thread_histogram;
+      histograms_.ops[op].store(h, std::memory_order_release);
+    }
+    return h;
+  }
+
+ private:
+  static void merge_exited(latency_registry& r, std::size_t op,
+                           const thread_histogram& h) noexcept {
+#if MATH_EXCEPTIONS
+    try {
+#endif
+      h.add_to(r.exited[op]);
+#if MATH_EXCEPTIONS
+    } catch (...) {
+    }
+#endif
+  }
+
+  thread_histograms histograms_;
+  bool registered_ = false;
+};
+
+}  // namespace
+
+void set_recording(bool on) noexcept {
+  detail::latency_recording.store(on, std::memory_order_relaxed);
+}
+
+snapshot_type snapshot() {
+  latency_registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  std::map<std::size_t, histogram> merged = r.exited;
+  std::uint64_t epoch = reset_epoch.load(std::memory_order_relaxed);
+  for (const thread_histograms* thread : r.threads) {
+    // threads that have not recorded since reset() still hold old values
+    if (thread->epoch.load(std::memory_order_acquire) != epoch) continue;
+    for (std::size_t op = 0; op < r.names.size() && op < kMaxOps; ++op) {
+      const thread_histogram* h =
+          thread->ops[op].load(std::memory_order_acquire);
+      if (h) h->add_to(merged[op]);
+    }
+  }
+
+  snapshot_type result;
+  for (const auto& [op, h] : merged) {
+    if (h.count()) result[r.names[op]].merge(h);
+  }
+  return result;
+}
+
+void reset() {
+  latency_registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.exited.clear();
+  reset_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+void dump_text(std::ostream& out, const snapshot_type& stats) {
+  out << std::left << std::setw(40) << "operation" << std::right
+      << std::setw(12) << "count" << std::setw(12) << "mean ns"
+      << std::setw(12) << "p50 ns" << std::setw(12) << "p90 ns"
+      << std::setw(12) << "p99 ns" << std::setw(12) << "p99.9 ns"
+      << std::setw(12) << "max ns" << '\n';
+  for (const auto& [name, h] : stats) {
+    out << std::left << std::setw(40) << name << std::right << std::setw(12)
+        << h.count() << std::setw(12) << std::uint64_t(h.mean_ns())
+        << std::setw(12) << h.percentile_ns(0.5) << std::setw(12)
+        << h.percentile_ns(0.9) << std::setw(12) << h.percentile_ns(0.99)
+        << std::setw(12) << h.percentile_ns(0.999) << std::setw(12)
+        << h.max_ns() << '\n';
+  }
+}
+
+}  // namespace latency
+
+namespace detail {
+
+std::size_t register_latency_op(const char* name) noexcept {
+#if MATH_EXCEPTIONS
+  try {
+#endif
+    latency::latency_registry& r = latency::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = std::find(r.names.begin(), r.names.end(), name);
+    if (it != r.names.end()) return std::size_t(it - r.names.begin());
+    r.names.emplace_back(name);
+    return r.names.size() - 1;
+#if MATH_EXCEPTIONS
+  } catch (...) {
+    return latency::kMaxOps;
+  }
+#endif
+}
+
+std::size_t latency_op::id() noexcept {
+  // threads registering concurrently get the same id for the same name
+  std::size_t id = id_.load(std::memory_order_relaxed);
+  if (id == kUnregistered) {
+    id = register_latency_op(name_);
+    id_.store(id, std::memory_order_relaxed);
+  }
+  return id;
+}
+
+void record_latency(std::size_t op, std::uint64_t ns) noexcept {
+  if (op >= latency::kMaxOps) return;
+
+  thread_local latency::thread_slot slot;
+  latency::thread_histogram* h = slot.get(op);
+  if (h) h->record(ns);
+}
+
+}  // namespace detail
+
+}  // namespace math
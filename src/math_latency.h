@@ -0,0 +1,186 @@
+#ifndef CPP_MATH_LIBRARY_MATH_LATENCY_H_
+#define CPP_MATH_LIBRARY_MATH_LATENCY_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Latency histograms of library operations for live services. Recording is
+// off by default and is compiled into every build: operations counted by
+// MATH_INSTRUMENT_OP then cost one relaxed atomic load. When on, every thread
+// records into its own histograms without locks, they are merged on read.
+
+namespace math {
+
+namespace detail {
+
+// Read inline by every operation, see latency::recording()
+inline std::atomic<bool> latency_recording{false};
+
+}  // namespace detail
+
+namespace latency {
+
+// Sub-buckets of every power of two, values are kept within 1/32 of them
+constexpr std::size_t kSubBuckets = 32;
+
+// Longer latencies (about 18 minutes) are recorded as this maximum
+constexpr std::uint64_t kMaxNanoseconds = std::uint64_t(1) << 40;
+
+// Per-thread storage of histograms, see math_latency.cc
+struct thread_histogram;
+
+/**
+ * @brief Log-linear (HDR-style) histogram of latencies in nanoseconds: values
+ * below 64 ns are exact, larger ones fall into buckets of relative width
+ * 1/32 at most.
+ *
+ */
+class histogram {
+ public:
+  // Number of buckets covering [0, kMaxNanoseconds)
+  static constexpr std::size_t kBuckets = 36 * kSubBuckets;
+
+  // Returns bucket of value, values above the range go to the last one
+  static std::size_t bucket_index(std::uint64_t ns) noexcept;
+
+  // Returns the smallest value of bucket
+  static std::uint64_t bucket_lower_ns(std::size_t bucket) noexcept;
+
+  // Returns the largest value of bucket
+  static std::uint64_t bucket_upper_ns(std::size_t bucket) noexcept;
+
+  void record(std::uint64_t ns, std::uint64_t times = 1);
+
+  // Adds all values of other
+  void merge(const histogram& other);
+
+  std::uint64_t count() const noexcept;
+  std::uint64_t sum_ns() const noexcept;
+  std::uint64_t min_ns() const noexcept;  // 0 if empty
+  std::uint64_t max_ns() const noexcept;
+  double mean_ns() const noexcept;
+
+  /**
+   * @brief Returns the largest value of the bucket holding the value at
+   * quantile q of [0, 1] (0.99 for p99), capped by max_ns(). 0 if empty
+   *
+   */
+  std::uint64_t percentile_ns(double q) const noexcept;
+
+  // Returns number of values in buckets with bucket_upper_ns() <= ns
+  std::uint64_t count_at_or_below(std::uint64_t ns) const noexcept;
+
+  // Returns (bucket_upper_ns, count) of non-empty buckets in ascending order
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets() const;
+
+ private:
+  friend struct thread_histogram;  // per-thread storage of math_latency.cc
+
+  std::vector<std::uint64_t> counts_;  // allocated by the first record
+  std::uint64_t count_ = 0;
+  std::uint64_t sum_ = 0;
+  std::uint64_t min_ = 0;
+  std::uint64_t max_ = 0;
+};
+
+using snapshot_type = std::map<std::string, histogram>;
+
+// Starts or stops recording of latencies
+void set_recording(bool on) noexcept;
+
+// Returns true while latencies are recorded
+inline bool recording() noexcept {
+  return detail::latency_recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns histograms of all operations recorded since reset(), merged
+ * over all threads including exited ones. Safe to poll while operations run;
+ * values recorded during the call may be missing from the result.
+ *
+ */
+snapshot_type snapshot();
+
+/**
+ * @brief Clears all histograms. Safe to call while operations run: every
+ * thread clears its own histograms when it records next, values recorded
+ * during the call may be dropped.
+ *
+ */
+void reset();
+
+// Writes count, mean, p50, p90, p99, p99.9 and max of every operation
+void dump_text(std::ostream& out, const snapshot_type& stats);
+
+}  // namespace latency
+
+namespace detail {
+
+// Returns id of operation with given name for latency recording, an id
+// record_latency() ignores if it can not be registered
+std::size_t register_latency_op(const char* name) noexcept;
+
+// Adds latency of one call of operation to histograms of the calling thread
+void record_latency(std::size_t op, std::uint64_t ns) noexcept;
+
+/**
+ * @brief Operation of MATH_LATENCY_OP. Constant-initialized, so its static
+ * needs no guard, and registered when it is first recorded.
+ *
+ */
+class latency_op {
+ public:
+  constexpr explicit latency_op(const char* name) noexcept
+      : name_(name), id_(kUnregistered) {}
+
+  // Returns id of the operation, registers it on the first call
+  std::size_t id() noexcept;
+
+ private:
+  static constexpr std::size_t kUnregistered = ~std::size_t(0);
+
+  const char* name_;
+  std::atomic<std::size_t> id_;
+};
+
+// Records wall time of its lifetime if recording is on at construction
+class latency_scope {
+ public:
+  explicit latency_scope(latency_op& op) noexcept
+      : op_(0), recorded_(latency::recording()) {
+    if (recorded_) {
+      op_ = op.id();
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~latency_scope() {
+    if (!recorded_) return;
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    record_latency(
+        op_, std::uint64_t(
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                     .count()));
+  }
+
+  latency_scope(const latency_scope&) = delete;
+  latency_scope& operator=(const latency_scope&) = delete;
+
+ private:
+  std::size_t op_;
+  bool recorded_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_LATENCY_H_
@@ -1,8 +1,19 @@
 #include "math_matrix.h"
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
-
+#include <utility>
+#include <vector>
+
+#include "math_cross_check.h"
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_parallel.h"
+#include "math_small_kernels.h"
+#include "math_status.h"
+#include "math_strassen.h"
+#include "math_tuning.h"
 #include "math_vector.h"
 
 namespace math {
@@ -11,14 +22,14 @@ matrix::matrix(const_reference diag) : matrix(3, diag) {}
 
 matrix::matrix(size_type size, const_reference diag) : matrix(size, size) {
   for (size_type i = 0; i < rows_; ++i) {
-    get_element(i, i) = diag;
+    unchecked(i, i) = diag;
   }
 }
 
 matrix::matrix(size_type rows, size_type columns)
     : rows_(rows), columns_(columns) {
   if (!rows_ || !columns_) {
-    throw std::invalid_argument("Matrix dimensions can not be 0");
+    MATH_THROW(std::invalid_argument("Matrix dimensions can not be 0"));
   }
 
   data_ = data_type(rows_ * columns_, value_type());
@@ -28,19 +39,19 @@ matrix::matrix(
     const std::initializer_list<std::initializer_list<value_type>> &items)
     : rows_(items.size()) {
   if (!rows_) {
-    throw std::invalid_argument("Matrix sizes can not be 0");
+    MATH_THROW(std::invalid_argument("Matrix sizes can not be 0"));
   }
 
   columns_ = (*(items.begin())).size();
   if (!columns_) {
-    throw std::invalid_argument("Matrix sizes can not be 0");
+    MATH_THROW(std::invalid_argument("Matrix sizes can not be 0"));
   }
 
   data_.reserve(rows_ * columns_);
   for (const auto &row : items) {
     if (row.size() != columns_) {
-      throw std::invalid_argument(
-          "Initializer list columns has different sizes");
+      MATH_THROW(std::invalid_argument(
+          "Initializer list columns has different sizes"));
     }
 
     for (const auto &el : row) {
@@ -52,63 +63,10 @@ matrix::matrix(
 matrix::matrix(const vector &v, bool is_column)
     : matrix(is_column ? v.size() : 1, is_column ? 1 : v.size()) {
   for (size_type i = 0; i < std::max(rows_, columns_); ++i) {
-    get_element(is_column ? i : 0, is_column ? 0 : i) = v[i];
+    unchecked(is_column ? i : 0, is_column ? 0 : i) = v[i];
   }
 }
 
-matrix::size_type matrix::rows() const noexcept { return rows_; }
-
-matrix::size_type matrix::columns() const noexcept { return columns_; }
-
-matrix::reference matrix::operator()(size_type row, size_type column) {
-  bounds_check(row, column);
-  return get_element(row, column);
-}
-
-matrix::const_reference matrix::operator()(size_type row,
-                                           size_type column) const {
-  bounds_check(row, column);
-  return get_element(row, column);
-}
-
-// Returns read-write iterator to the beginning
-matrix::iterator matrix::begin() noexcept { return data_.begin(); }
-
-// Returns read-only iterator to the beginning
-matrix::const_iterator matrix::begin() const noexcept { return data_.begin(); }
-
-// Returns read-write iterator to the end
-matrix::iterator matrix::end() noexcept { return data_.end(); }
-
-// Returns read-only iterator to the end
-matrix::const_iterator matrix::end() const noexcept { return data_.end(); }
-
-matrix::const_iterator matrix::cbegin() const noexcept {
-  return data_.cbegin();
-}
-
-matrix::const_iterator matrix::cend() const noexcept { return data_.cend(); }
-
-matrix::reverse_iterator matrix::rbegin() noexcept { return data_.rbegin(); }
-
-matrix::reverse_iterator matrix::rend() noexcept { return data_.rend(); }
-
-matrix::const_reverse_iterator matrix::rbegin() const noexcept {
-  return data_.rbegin();
-}
-
-matrix::const_reverse_iterator matrix::rend() const noexcept {
-  return data_.rend();
-}
-
-matrix::const_reverse_iterator matrix::crbegin() const noexcept {
-  return data_.crbegin();
-}
-
-matrix::const_reverse_iterator matrix::crend() const noexcept {
-  return data_.crend();
-}
-
 std::ostream &operator<<(std::ostream &out, const matrix &m) {
   using size_type = matrix::size_type;
 
@@ -127,7 +85,7 @@ std::ostream &operator<<(std::ostream &out, const matrix &m) {
       }
       comma = true;
 
-      out << m.get_element(i, j);
+      out << m.unchecked(i, j);
     }
 
     out << ']';
@@ -142,6 +100,8 @@ std::istream &operator>>(std::istream &in, matrix &m) {
 }
 
 bool operator==(const matrix &l, const matrix &r) noexcept {
+  MATH_INSTRUMENT_OP("matrix::operator==", 0, 16.0 * l.rows() * l.columns(),
+                     l.rows(), l.columns());
   if (l.rows() != r.rows() || l.columns() != r.columns()) {
     return false;
   }
@@ -152,35 +112,71 @@ bool operator==(const matrix &l, const matrix &r) noexcept {
 bool operator!=(const matrix &l, const matrix &r) noexcept { return !(l == r); }
 
 matrix &matrix::operator+=(const matrix &other) {
-  is_sizes_equal(other);
+  // try_add checks sizes, the mismatch is reported here
+  if (try_add(other) != status::ok) is_sizes_equal(other);
+  return *this;
+}
+
+matrix &matrix::operator-=(const matrix &other) {
+  // try_subtract checks sizes, the mismatch is reported here
+  if (try_subtract(other) != status::ok) is_sizes_equal(other);
+  return *this;
+}
+
+matrix &matrix::operator*=(const matrix &other) {
+  // try_multiply checks sizes, the mismatch is reported here
+  if (try_multiply(other) != status::ok) is_inner_sizes_equal(other);
+  return *this;
+}
+
+status matrix::try_add(const matrix &other) noexcept {
+  MATH_INSTRUMENT_OP("matrix::operator+=", double(rows_) * columns_,
+                     24.0 * rows_ * columns_, rows_, columns_);
+  if (rows_ != other.rows_ || columns_ != other.columns_) {
+    return status::size_mismatch;
+  }
 
   std::transform(begin(), end(), other.begin(), begin(),
                  std::plus<value_type>());
-  return *this;
+  return status::ok;
 }
 
-matrix &matrix::operator-=(const matrix &other) {
-  is_sizes_equal(other);
+status matrix::try_subtract(const matrix &other) noexcept {
+  MATH_INSTRUMENT_OP("matrix::operator-=", double(rows_) * columns_,
+                     24.0 * rows_ * columns_, rows_, columns_);
+  if (rows_ != other.rows_ || columns_ != other.columns_) {
+    return status::size_mismatch;
+  }
 
   std::transform(begin(), end(), other.begin(), begin(),
                  std::minus<value_type>());
-  return *this;
+  return status::ok;
 }
 
-matrix &matrix::operator*=(const matrix &other) {
-  is_inner_sizes_equal(other);
+status matrix::try_multiply(const matrix &other) {
+  MATH_INSTRUMENT_OP("matrix::operator*=(matrix)",
+                     2.0 * rows_ * columns_ * other.columns_,
+                     8.0 * (rows_ * columns_ + other.rows_ * other.columns_ +
+                            rows_ * other.columns_),
+                     rows_, columns_, other.columns_);
+  if (columns_ != other.rows_) return status::size_mismatch;
 
   matrix result(rows_, other.columns_);
-  for (size_type i = 0; i < result.rows_; ++i)
-    for (size_type j = 0; j < result.columns_; ++j)
-      for (size_type k = 0; k < columns_; ++k)
-        result.get_element(i, j) += get_element(i, k) * other.get_element(k, j);
+  detail::product(rows_, columns_, other.columns_, data(), other.data(),
+                  result.data());
+  // Strassen-Winograd rounds differently from the reference by design
+  if (!detail::use_strassen(rows_, columns_, other.columns_) &&
+      detail::cross_check_sampled()) {
+    detail::check_product(*this, other, result);
+  }
 
   *this = std::move(result);
-  return *this;
+  return status::ok;
 }
 
 matrix &matrix::operator*=(const value_type &value) noexcept {
+  MATH_INSTRUMENT_OP("matrix::operator*=(scalar)", double(rows_) * columns_,
+                     16.0 * rows_ * columns_, rows_, columns_);
   std::transform(begin(), end(), begin(),
                  [&value](const_reference v) { return v * value; });
   return *this;
@@ -191,24 +187,36 @@ matrix &matrix::operator/=(const value_type &value) noexcept {
 }
 
 matrix operator+(const matrix &l, const matrix &r) {
+  MATH_INSTRUMENT_OP("matrix::operator+", double(l.rows()) * l.columns(),
+                     24.0 * l.rows() * l.columns(), l.rows(), l.columns());
   matrix result(l);
   result += r;
   return result;
 }
 
 matrix operator-(const matrix &l, const matrix &r) {
+  MATH_INSTRUMENT_OP("matrix::operator-", double(l.rows()) * l.columns(),
+                     24.0 * l.rows() * l.columns(), l.rows(), l.columns());
   matrix result(l);
   result -= r;
   return result;
 }
 
 matrix operator*(const matrix &l, const matrix &r) {
+  MATH_INSTRUMENT_OP("matrix::operator*(matrix)",
+                     2.0 * l.rows() * l.columns() * r.columns(),
+                     8.0 * (l.rows() * l.columns() + r.rows() * r.columns() +
+                            l.rows() * r.columns()),
+                     l.rows(), l.columns(), r.columns());
   matrix result(l);
   result *= r;
   return result;
 }
 
 matrix operator*(const matrix &m, matrix::const_reference value) {
+  MATH_INSTRUMENT_OP("matrix::operator*(scalar)",
+                     double(m.rows()) * m.columns(),
+                     16.0 * m.rows() * m.columns(), m.rows(), m.columns());
   matrix result(m);
   result *= value;
   return result;
@@ -219,25 +227,47 @@ matrix operator*(matrix::const_reference &value, const matrix &matrix) {
 }
 
 matrix operator/(const matrix &m, matrix::const_reference &value) {
+  MATH_INSTRUMENT_OP("matrix::operator/", double(m.rows()) * m.columns(),
+                     16.0 * m.rows() * m.columns(), m.rows(), m.columns());
   matrix result(m);
   result /= value;
   return result;
 }
 
 matrix matrix::transposed() const {
+  MATH_INSTRUMENT_OP("matrix::transposed", 0, 16.0 * rows_ * columns_, rows_,
+                     columns_);
   matrix result(columns_, rows_);
-  for (size_type i = 0; i < result.rows_; ++i) {
-    for (size_type j = 0; j < result.columns_; ++j) {
-      result.get_element(i, j) = get_element(j, i);
+  const double* source = data();
+  double* target = result.data();
+
+  if (auto kernel = detail::find_small_transpose(rows_, columns_)) {
+    kernel(source, target);
+  } else {
+    // square tiles keep both the rows read and the rows written in cache
+    size_type block = tuning().transpose_block;
+    for (size_type ii = 0; ii < rows_; ii += block) {
+      size_type i_end = std::min(rows_, ii + block);
+      for (size_type jj = 0; jj < columns_; jj += block) {
+        size_type j_end = std::min(columns_, jj + block);
+        for (size_type i = ii; i < i_end; ++i) {
+          for (size_type j = jj; j < j_end; ++j) {
+            target[j * rows_ + i] = source[i * columns_ + j];
+          }
+        }
+      }
     }
   }
+  if (detail::cross_check_sampled()) detail::check_transpose(*this, result);
 
   return result;
 }
 
 matrix matrix::minor_matrix(size_type row, size_type column) const {
+  MATH_INSTRUMENT_OP("matrix::minor_matrix", 0, 16.0 * rows_ * columns_, rows_,
+                     columns_);
   if (rows_ == 1 || columns_ == 1) {
-    throw std::logic_error("Minor matrix of matrix 1x1 is not exist");
+    MATH_THROW(std::logic_error("Minor matrix of matrix 1x1 is not exist"));
   }
   bounds_check(row, column);
 
@@ -252,7 +282,7 @@ matrix matrix::minor_matrix(size_type row, size_type column) const {
         continue;
       }
 
-      result.get_element(im, jm++) = get_element(i, j);
+      result.unchecked(im, jm++) = unchecked(i, j);
     }
     ++im;
   }
@@ -260,7 +290,97 @@ matrix matrix::minor_matrix(size_type row, size_type column) const {
   return result;
 }
 
+matrix matrix::block(size_type row, size_type column, size_type rows,
+                     size_type columns) const {
+  MATH_INSTRUMENT_OP("matrix::block", 0, 16.0 * rows * columns, rows,
+                     columns);
+  block_check(row, column, rows, columns);
+
+  matrix result(rows, columns);
+  for (size_type i = 0; i < rows; ++i) {
+    const_pointer source = row_data(row + i) + column;
+    std::copy(source, source + columns, result.row_data(i));
+  }
+  return result;
+}
+
+void matrix::set_block(size_type row, size_type column,
+                       const matrix &source) {
+  MATH_INSTRUMENT_OP("matrix::set_block", 0,
+                     16.0 * source.rows_ * source.columns_, source.rows_,
+                     source.columns_);
+  block_check(row, column, source.rows_, source.columns_);
+
+  for (size_type i = 0; i < source.rows_; ++i) {
+    std::copy(source.row_data(i), source.row_data(i) + source.columns_,
+              row_data(row + i) + column);
+  }
+}
+
+void matrix::swap_rows(size_type first, size_type second) {
+  bounds_check(std::max(first, second), 0);
+  if (first == second) return;
+
+  std::swap_ranges(row_data(first), row_data(first) + columns_,
+                   row_data(second));
+}
+
+void matrix::swap_columns(size_type first, size_type second) {
+  bounds_check(0, std::max(first, second));
+  if (first == second) return;
+
+  for (size_type i = 0; i < rows_; ++i) {
+    std::swap(unchecked(i, first), unchecked(i, second));
+  }
+}
+
+void matrix::permute_rows(const std::vector<size_type> &permutation) {
+  MATH_INSTRUMENT_OP("matrix::permute_rows", 0, 16.0 * rows_ * columns_,
+                     rows_, columns_);
+  permutation_check(permutation, rows_);
+
+  // every cycle i -> permutation[i] -> ... shifts its rows by one
+  std::vector<bool> moved(rows_);
+  detail::buffer<value_type> saved(columns_);
+  for (size_type start = 0; start < rows_; ++start) {
+    if (moved[start] || permutation[start] == start) continue;
+
+    std::copy(row_data(start), row_data(start) + columns_, saved.begin());
+    size_type i = start;
+    for (; permutation[i] != start; i = permutation[i]) {
+      const_pointer source = row_data(permutation[i]);
+      std::copy(source, source + columns_, row_data(i));
+      moved[i] = true;
+    }
+    std::copy(saved.begin(), saved.end(), row_data(i));
+    moved[i] = true;
+  }
+}
+
+void matrix::permute_columns(const std::vector<size_type> &permutation) {
+  MATH_INSTRUMENT_OP("matrix::permute_columns", 0, 16.0 * rows_ * columns_,
+                     rows_, columns_);
+  permutation_check(permutation, columns_);
+
+  // a row is gathered while it is in L1, one buffer per chunk of rows
+  detail::parallel_for(
+      rows_, std::max<size_type>(1, detail::kBlas1Grain / columns_),
+      [&](size_type first, size_type last) {
+        detail::buffer<value_type> gathered(columns_);
+        for (size_type i = first; i < last; ++i) {
+          pointer row = row_data(i);
+          for (size_type j = 0; j < columns_; ++j) {
+            gathered[j] = row[permutation[j]];
+          }
+          std::copy(gathered.begin(), gathered.end(), row);
+        }
+      });
+}
+
 matrix matrix::upper_triangle_matrix() const {
+  MATH_INSTRUMENT_OP("matrix::upper_triangle_matrix",
+                     2.0 * rows_ * columns_ * std::min(rows_, columns_) / 3,
+                     16.0 * rows_ * columns_, rows_, columns_);
   matrix result(*this);
 
   for (size_type j = 0; j < result.columns_ - 1; ++j) {
@@ -271,16 +391,16 @@ matrix matrix::upper_triangle_matrix() const {
 
     if (non_zero_row != j) {
       for (size_type i = 0; i < result.columns_; ++i) {
-        result.get_element(j, i) += result.get_element(non_zero_row, i);
+        result.unchecked(j, i) += result.unchecked(non_zero_row, i);
       }
     }
 
     for (size_type i = j + 1; i < result.rows_; ++i) {
-      if (result.get_element(i, j)) {
+      if (result.unchecked(i, j)) {
         value_type multiplier =
-            result.get_element(i, j) / result.get_element(j, j);
+            result.unchecked(i, j) / result.unchecked(j, j);
         for (size_type k = 0; k < result.columns_; ++k) {
-          result.get_element(i, k) -= result.get_element(j, k) * multiplier;
+          result.unchecked(i, k) -= result.unchecked(j, k) * multiplier;
         }
       }
     }
@@ -291,23 +411,38 @@ matrix matrix::upper_triangle_matrix() const {
 
 matrix::value_type matrix::determinant() const {
   square_check();
+  return *try_determinant();
+}
+
+expected<matrix::value_type> matrix::try_determinant() const {
+  MATH_INSTRUMENT_OP("matrix::determinant", 2.0 * rows_ * rows_ * rows_ / 3,
+                     16.0 * rows_ * columns_, rows_, columns_);
+  if (rows_ != columns_) return status::not_square;
+  if (auto kernel = detail::find_small_determinant(rows_)) {
+    return kernel(data());
+  }
 
   matrix triangle = upper_triangle_matrix();
   value_type result = 1;
 
   for (size_type i = 0; i < triangle.rows_; ++i) {
-    result *= triangle.get_element(i, i);
+    result *= triangle.unchecked(i, i);
   }
   return result;
 }
 
 matrix matrix::complements_matrix() const {
+  // rows_ * columns_ determinants of minors
+  MATH_INSTRUMENT_OP(
+      "matrix::complements_matrix",
+      2.0 * rows_ * columns_ * (rows_ - 1) * (rows_ - 1) * (rows_ - 1) / 3,
+      16.0 * rows_ * columns_ * (rows_ - 1) * (columns_ - 1), rows_, columns_);
   square_check();
 
   matrix result(rows_, columns_);
   for (size_type i = 0; i < result.rows_; ++i) {
     for (size_type j = 0; j < result.columns_; ++j) {
-      result.get_element(i, j) =
+      result.unchecked(i, j) =
           minor_matrix(i, j).determinant() * ((i + j) % 2 ? -1 : 1);
     }
   }
@@ -316,12 +451,26 @@ matrix matrix::complements_matrix() const {
 }
 
 matrix matrix::inverse() const {
-  if (value_type det = determinant(); det != 0) {
-    return complements_matrix().transposed() / det;
+  square_check();
+  expected<matrix> result = try_inverse();
+  if (!result) {
+    MATH_THROW(std::logic_error(
+        "Inverse matrix can not be calculated from matrix with det = 0"));
   }
+  return std::move(*result);
+}
+
+expected<matrix> matrix::try_inverse() const {
+  MATH_INSTRUMENT_OP(
+      "matrix::inverse",
+      2.0 * rows_ * columns_ * (rows_ - 1) * (rows_ - 1) * (rows_ - 1) / 3,
+      16.0 * rows_ * columns_ * (rows_ - 1) * (columns_ - 1), rows_, columns_);
+  if (rows_ != columns_) return status::not_square;
 
-  throw std::logic_error(
-      "Inverse matrix can not be calculated from matrix with det = 0");
+  if (value_type det = *try_determinant(); det != 0) {
+    return complements_matrix().transposed() / det;
+  }
+  return status::singular;
 }
 
 matrix matrix::operator!() const { return transposed(); }
@@ -335,81 +484,129 @@ matrix matrix::operator-() const { return *this * -1; }
 matrix matrix::operator+() const { return matrix(*this); }
 
 void matrix::set_rows(size_type rows) {
+  MATH_INSTRUMENT_OP("matrix::set_rows", 0, 8.0 * rows * columns_, rows,
+                     columns_);
   if (!rows) {
-    throw std::invalid_argument("Matrix sizes can not be 0");
-  }
-
-  matrix new_matrix(rows, columns_);
-  for (size_type i = 0; i < std::min(rows, rows_); ++i) {
-    for (size_type j = 0; j < columns_; ++j) {
-      new_matrix.get_element(i, j) = get_element(i, j);
-    }
+    MATH_THROW(std::invalid_argument("Matrix sizes can not be 0"));
   }
 
-  *this = std::move(new_matrix);
+  // rows are stored one after another, so they are kept or dropped at the
+  // end of storage, which keeps its capacity
+  data_.resize(rows * columns_, value_type());
+  rows_ = rows;
 }
 
 void matrix::set_columns(size_type columns) {
+  MATH_INSTRUMENT_OP("matrix::set_columns", 0, 16.0 * rows_ * columns, rows_,
+                     columns);
   if (!columns) {
-    throw std::invalid_argument("Matrix sizes can not be 0");
+    MATH_THROW(std::invalid_argument("Matrix sizes can not be 0"));
   }
-
-  matrix new_matrix(rows_, columns);
-  for (size_type i = 0; i < rows_; ++i) {
-    for (size_type j = 0; j < std::min(columns, columns_); ++j) {
-      new_matrix.get_element(i, j) = get_element(i, j);
+  if (columns == columns_) return;
+
+  // row i moves from i * columns_ to i * columns: forward when shrinking,
+  // backward when growing, so no row is overwritten before it is moved
+  size_type kept = std::min(columns, columns_);
+  if (columns < columns_) {
+    for (size_type i = 1; i < rows_; ++i) {
+      std::memmove(data() + i * columns, data() + i * columns_,
+                   kept * sizeof(value_type));
+    }
+    data_.resize(rows_ * columns);
+  } else {
+    data_.resize(rows_ * columns);
+    for (size_type i = rows_; i-- > 0;) {
+      pointer row = data() + i * columns;
+      std::memmove(row, data() + i * columns_, kept * sizeof(value_type));
+      std::fill(row + kept, row + columns, value_type());
     }
   }
+  columns_ = columns;
+}
 
-  *this = std::move(new_matrix);
+void matrix::reshape(size_type rows, size_type columns) {
+  // rows * columns could wrap around to the number of elements
+  if (!rows || !columns || data_.size() % columns ||
+      rows != data_.size() / columns) {
+    MATH_THROW(std::invalid_argument(
+        "Can not reshape " + std::to_string(rows_) + "x" +
+        std::to_string(columns_) + " matrix into " + std::to_string(rows) +
+        "x" + std::to_string(columns)));
+  }
+  rows_ = rows;
+  columns_ = columns;
 }
 
-matrix::reference matrix::get_element(size_type row,
-                                      size_type column) noexcept {
-  return data_[columns_ * row + column];
+void matrix::reserve(size_type elements) { data_.reserve(elements); }
+
+matrix::size_type matrix::capacity() const noexcept {
+  return data_.capacity();
 }
 
-matrix::const_reference matrix::get_element(size_type row,
-                                            size_type column) const noexcept {
-  return data_[columns_ * row + column];
+void matrix::shrink_to_fit() { data_.shrink_to_fit(); }
+
+void matrix::throw_out_of_range(size_type row, size_type column) const {
+  MATH_THROW(std::out_of_range(
+      "Out of range: rows_ = " + std::to_string(rows_) +
+      ", row = " + std::to_string(row) +
+      ", columns_ = " + std::to_string(columns_) +
+      ", column = " + std::to_string(column)));
+}
+
+void matrix::block_check(size_type row, size_type column, size_type rows,
+                         size_type columns) const {
+  if (row > rows_ || rows > rows_ - row || column > columns_ ||
+      columns > columns_ - column) {
+    MATH_THROW(std::out_of_range(
+        "Block out of range: rows_ = " + std::to_string(rows_) +
+        ", row = " + std::to_string(row) + ", rows = " + std::to_string(rows) +
+        ", columns_ = " + std::to_string(columns_) +
+        ", column = " + std::to_string(column) +
+        ", columns = " + std::to_string(columns)));
+  }
 }
 
-void matrix::bounds_check(size_type row, size_type column) const {
-  if (row >= rows_ || column >= columns_) {
-    throw std::out_of_range("Out of range: rows_ = " + std::to_string(rows_) +
-                            ", row = " + std::to_string(row) +
-                            ", columns_ = " + std::to_string(columns_) +
-                            ", column = " + std::to_string(column));
+void matrix::permutation_check(const std::vector<size_type> &permutation,
+                               size_type size) const {
+  bool valid = permutation.size() == size;
+  std::vector<bool> seen(valid ? size : 0);
+  for (size_type i = 0; valid && i < size; ++i) {
+    valid = permutation[i] < size && !seen[permutation[i]];
+    if (valid) seen[permutation[i]] = true;
+  }
+  if (!valid) {
+    MATH_THROW(std::invalid_argument(
+        "Not a permutation of " + std::to_string(size) + " indices"));
   }
 }
 
 void matrix::is_sizes_equal(const matrix &other) const {
   if (rows_ != other.rows_ || columns_ != other.columns_) {
-    throw std::invalid_argument(
+    MATH_THROW(std::invalid_argument(
         "Sizes mismatch: rows_ = " + std::to_string(rows_) +
         ", other.rows_ = " + std::to_string(other.rows_) +
         ", columns_ = " + std::to_string(columns_) +
-        ", other.columns_ = " + std::to_string(other.columns_));
+        ", other.columns_ = " + std::to_string(other.columns_)));
   }
 }
 
 void matrix::is_inner_sizes_equal(const matrix &other) const {
   if (columns_ != other.rows_) {
-    throw std::invalid_argument(
+    MATH_THROW(std::invalid_argument(
         "Inner sizes mismatch: columns_ = " + std::to_string(columns_) +
-            ", other.rows_" = std::to_string(other.rows_));
+        ", other.rows_ = " + std::to_string(other.rows_)));
   }
 }
 
 void matrix::square_check() const {
   if (rows_ != columns_) {
-    throw std::logic_error("Matrix is not square");
+    MATH_THROW(std::logic_error("Matrix is not square"));
   }
 }
 
 matrix::size_type matrix::find_not_zero_row(size_type from_row,
                                             size_type column) const noexcept {
-  while (!get_element(from_row, column) && from_row < rows_) {
+  while (!unchecked(from_row, column) && from_row < rows_) {
     ++from_row;
   }
 
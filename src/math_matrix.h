@@ -5,6 +5,8 @@
 #include <ostream>
 #include <vector>
 
+#include "math_memory.h"
+#include "math_status.h"
 #include "math_vector.h"
 
 namespace math {
@@ -16,9 +18,10 @@ namespace math {
 class matrix {
  public:
   using value_type = double;
-  using data_type = std::vector<value_type>;
+  using data_type = std::vector<value_type, allocator<value_type>>;
   using reference = typename data_type::reference;
   using const_reference = typename data_type::const_reference;
+  using pointer = typename data_type::pointer;
   using const_pointer = typename data_type::const_pointer;
   using size_type = typename data_type::size_type;
   using iterator = typename data_type::iterator;
@@ -86,6 +89,27 @@ class matrix {
    */
   const_reference operator()(size_type row, size_type column) const;
 
+  // Returns element by position, or status::out_of_range
+  expected<value_type> try_at(size_type row, size_type column) const noexcept;
+
+  // Get element by position without bounds checking
+  reference unchecked(size_type row, size_type column) noexcept;
+
+  // Get element by position without bounds checking, read-only
+  const_reference unchecked(size_type row, size_type column) const noexcept;
+
+  // Returns pointer to the first of columns_ elements of row, unchecked
+  pointer row_data(size_type row) noexcept;
+
+  // Returns read-only pointer to the first element of row, unchecked
+  const_pointer row_data(size_type row) const noexcept;
+
+  // Returns pointer to the row-major storage of rows_ * columns_ elements
+  pointer data() noexcept;
+
+  // Returns read-only pointer to the row-major storage
+  const_pointer data() const noexcept;
+
   // Returns read-write iterator to the beginning
   iterator begin() noexcept;
 
@@ -168,6 +192,28 @@ class matrix {
    */
   matrix &operator/=(const value_type &value) noexcept;
 
+  /**
+   * @brief Non-throwing operator+=, returns status::size_mismatch and leaves
+   * this unchanged if sizes are not equal
+   *
+   */
+  status try_add(const matrix &other) noexcept;
+
+  /**
+   * @brief Non-throwing operator-=, returns status::size_mismatch and leaves
+   * this unchanged if sizes are not equal
+   *
+   */
+  status try_subtract(const matrix &other) noexcept;
+
+  /**
+   * @brief operator*=(matrix) without size exceptions, returns
+   * status::size_mismatch and leaves this unchanged if inner sizes are not
+   * equal. Throws std::bad_alloc if the product can not be allocated
+   *
+   */
+  status try_multiply(const matrix &other);
+
   /**
    * @brief Sum of two matrices into a new matrix. Throws std::invalid_argument
    * if matrix sizes are not equal
@@ -221,6 +267,52 @@ class matrix {
    */
   matrix minor_matrix(size_type row, size_type column) const;
 
+  /**
+   * @brief Returns rows x columns block starting at (row, column). Throws
+   * std::out_of_range if the block does not fit into the matrix
+   *
+   */
+  matrix block(size_type row, size_type column, size_type rows,
+               size_type columns) const;
+
+  /**
+   * @brief Copies source into block starting at (row, column) row by row.
+   * Throws std::out_of_range if source does not fit into the matrix
+   *
+   */
+  void set_block(size_type row, size_type column, const matrix &source);
+
+  /**
+   * @brief Swaps two rows. Throws std::out_of_range if a row is >= rows_
+   *
+   */
+  void swap_rows(size_type first, size_type second);
+
+  /**
+   * @brief Swaps two columns. Throws std::out_of_range if a column is >=
+   * columns_
+   *
+   */
+  void swap_columns(size_type first, size_type second);
+
+  /**
+   * @brief Reorders rows in place, row i becomes row permutation[i] of the
+   * matrix. Rows are moved whole along cycles of the permutation with one row
+   * of extra storage. Throws std::invalid_argument if permutation is not a
+   * permutation of rows
+   *
+   */
+  void permute_rows(const std::vector<size_type> &permutation);
+
+  /**
+   * @brief Reorders columns, column j becomes column permutation[j] of the
+   * matrix. Every row is gathered into a buffer and copied back, rows are
+   * split between threads. Throws std::invalid_argument if permutation is not
+   * a permutation of columns
+   *
+   */
+  void permute_columns(const std::vector<size_type> &permutation);
+
   // Returns upper triangle matrix with zeroes under main diagonal
   matrix upper_triangle_matrix() const;
 
@@ -231,6 +323,10 @@ class matrix {
    */
   value_type determinant() const;
 
+  // Returns determinant, or status::not_square. Throws std::bad_alloc if
+  // temporaries can not be allocated
+  expected<value_type> try_determinant() const;
+
   /**
    * @brief Returns matrix of algebraic complements. Throws std::logic_error
    * if matrix is not square
@@ -245,6 +341,10 @@ class matrix {
    */
   matrix inverse() const;
 
+  // Returns inverse matrix, or status::not_square or status::singular. Throws
+  // std::bad_alloc if the result can not be allocated
+  expected<matrix> try_inverse() const;
+
   /**
    * @brief Returns transposed matrix.
    *
@@ -279,23 +379,44 @@ class matrix {
   matrix operator+() const;
 
   /**
-   * @brief Set new rows count. If rows == 0 then throws std::invalid_argument
+   * @brief Set new rows count, storage is resized in place and new rows are
+   * zero. If rows == 0 then throws std::invalid_argument
    *
    */
   void set_rows(size_type rows);
 
   /**
-   * @brief Set new columns count. If columns == 0 then throws
+   * @brief Set new columns count. Rows are moved inside storage (from the
+   * last one when growing), new columns are zero. If columns == 0 then throws
    * std::invalid_argument
    *
    */
   void set_columns(size_type columns);
 
- private:
-  reference get_element(size_type row, size_type column) noexcept;
-  const_reference get_element(size_type row, size_type column) const noexcept;
+  /**
+   * @brief Reinterprets row-major storage as rows x columns matrix in O(1),
+   * elements keep their order. Throws std::invalid_argument if rows * columns
+   * differs from the number of elements
+   *
+   */
+  void reshape(size_type rows, size_type columns);
 
+  // Reserves storage for elements, so sizes up to it do not reallocate
+  void reserve(size_type elements);
+
+  // Returns number of elements storage can hold without reallocation
+  size_type capacity() const noexcept;
+
+  // Releases storage not used by elements
+  void shrink_to_fit();
+
+ private:
   void bounds_check(size_type row, size_type column) const;
+  [[noreturn]] void throw_out_of_range(size_type row, size_type column) const;
+  void block_check(size_type row, size_type column, size_type rows,
+                   size_type columns) const;
+  void permutation_check(const std::vector<size_type> &permutation,
+                         size_type size) const;
   void is_sizes_equal(const matrix &other) const;
   void is_inner_sizes_equal(const matrix &other) const;
   void square_check() const;
@@ -308,6 +429,102 @@ class matrix {
   data_type data_;
 };
 
+// Element access and other trivial members are defined here to be inlined
+// into loops of callers
+
+inline matrix::size_type matrix::rows() const noexcept { return rows_; }
+
+inline matrix::size_type matrix::columns() const noexcept { return columns_; }
+
+inline matrix::reference matrix::operator()(size_type row, size_type column) {
+  bounds_check(row, column);
+  return unchecked(row, column);
+}
+
+inline matrix::const_reference matrix::operator()(size_type row,
+                                                  size_type column) const {
+  bounds_check(row, column);
+  return unchecked(row, column);
+}
+
+inline expected<matrix::value_type> matrix::try_at(
+    size_type row, size_type column) const noexcept {
+  if (row >= rows_ || column >= columns_) return status::out_of_range;
+  return unchecked(row, column);
+}
+
+inline matrix::reference matrix::unchecked(size_type row,
+                                           size_type column) noexcept {
+  return data_[columns_ * row + column];
+}
+
+inline matrix::const_reference matrix::unchecked(
+    size_type row, size_type column) const noexcept {
+  return data_[columns_ * row + column];
+}
+
+inline matrix::pointer matrix::row_data(size_type row) noexcept {
+  return data_.data() + columns_ * row;
+}
+
+inline matrix::const_pointer matrix::row_data(size_type row) const noexcept {
+  return data_.data() + columns_ * row;
+}
+
+inline matrix::pointer matrix::data() noexcept { return data_.data(); }
+
+inline matrix::const_pointer matrix::data() const noexcept {
+  return data_.data();
+}
+
+inline matrix::iterator matrix::begin() noexcept { return data_.begin(); }
+
+inline matrix::const_iterator matrix::begin() const noexcept {
+  return data_.begin();
+}
+
+inline matrix::iterator matrix::end() noexcept { return data_.end(); }
+
+inline matrix::const_iterator matrix::end() const noexcept {
+  return data_.end();
+}
+
+inline matrix::const_iterator matrix::cbegin() const noexcept {
+  return data_.cbegin();
+}
+
+inline matrix::const_iterator matrix::cend() const noexcept {
+  return data_.cend();
+}
+
+inline matrix::reverse_iterator matrix::rbegin() noexcept {
+  return data_.rbegin();
+}
+
+inline matrix::reverse_iterator matrix::rend() noexcept {
+  return data_.rend();
+}
+
+inline matrix::const_reverse_iterator matrix::rbegin() const noexcept {
+  return data_.rbegin();
+}
+
+inline matrix::const_reverse_iterator matrix::rend() const noexcept {
+  return data_.rend();
+}
+
+inline matrix::const_reverse_iterator matrix::crbegin() const noexcept {
+  return data_.crbegin();
+}
+
+inline matrix::const_reverse_iterator matrix::crend() const noexcept {
+  return data_.crend();
+}
+
+inline void matrix::bounds_check(size_type row, size_type column) const {
+  if (row >= rows_ || column >= columns_) throw_out_of_range(row, column);
+}
+
 }  // namespace math
 
 #endif  // CPP_MATH_LIBRARY_MATH_MATRIX_H_
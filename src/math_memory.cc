@@ -0,0 +1,161 @@
+#include "math_memory.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+std::atomic<allocation_hooks*> current_hooks{nullptr};
+std::atomic<std::size_t> budget_bytes{0};
+
+std::atomic<std::size_t> current_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+std::atomic<std::uint64_t> allocations{0};
+
+// Storage allocated minus released by the calling thread, negative if it
+// released storage of other threads, and its highest value in the innermost
+// measured operation
+thread_local std::int64_t thread_bytes = 0;
+thread_local std::int64_t thread_high = 0;
+thread_local detail::thread_allocation_stats thread_allocated{0, 0};
+
+void raise_peak(std::size_t bytes) noexcept {
+  std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (peak < bytes && !peak_bytes.compare_exchange_weak(
+                             peak, bytes, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+memory_budget_exceeded::memory_budget_exceeded(std::size_t requested,
+                                               std::size_t in_use,
+                                               std::size_t budget)
+    : requested_(requested),
+      in_use_(in_use),
+      budget_(budget),
+      message_("Memory budget exceeded: requested " +
+               std::to_string(requested) + " bytes, in use " +
+               std::to_string(in_use) + " of " + std::to_string(budget)) {}
+
+const char* memory_budget_exceeded::what() const noexcept {
+  return message_.c_str();
+}
+
+std::size_t memory_budget_exceeded::requested() const noexcept {
+  return requested_;
+}
+
+std::size_t memory_budget_exceeded::in_use() const noexcept { return in_use_; }
+
+std::size_t memory_budget_exceeded::budget() const noexcept { return budget_; }
+
+void set_allocation_hooks(allocation_hooks* hooks) noexcept {
+  current_hooks.store(hooks);
+}
+
+allocation_hooks* get_allocation_hooks() noexcept {
+  return current_hooks.load(std::memory_order_relaxed);
+}
+
+memory_usage_stats memory_usage() noexcept {
+  memory_usage_stats stats;
+  stats.current_bytes = current_bytes.load(std::memory_order_relaxed);
+  stats.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+  stats.allocations = allocations.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void reset_peak_memory() noexcept {
+  peak_bytes.store(current_bytes.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+}
+
+void set_memory_budget(std::size_t bytes) noexcept {
+  budget_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+std::size_t memory_budget() noexcept {
+  return budget_bytes.load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void* allocate_storage(std::size_t bytes, allocation_hooks* hooks) {
+  // reserve first so concurrent allocations can not overshoot the budget
+  std::size_t before =
+      current_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  std::size_t budget = budget_bytes.load(std::memory_order_relaxed);
+  if (budget && before + bytes > budget) {
+    current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    MATH_THROW(memory_budget_exceeded(bytes, before, budget));
+  }
+
+  void* p = nullptr;
+#if MATH_EXCEPTIONS
+  try {
+    p = hooks ? hooks->allocate(bytes) : ::operator new(bytes);
+  } catch (...) {
+    current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    throw;
+  }
+#else
+  p = hooks ? hooks->allocate(bytes) : ::operator new(bytes);
+#endif
+
+  raise_peak(before + bytes);
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  thread_bytes += std::int64_t(bytes);
+  thread_high = std::max(thread_high, thread_bytes);
+  ++thread_allocated.allocations;
+  thread_allocated.bytes += bytes;
+  return p;
+}
+
+void deallocate_storage(void* p, std::size_t bytes,
+                        allocation_hooks* hooks) noexcept {
+  if (hooks) {
+    hooks->deallocate(p, bytes);
+  } else {
+    ::operator delete(p);
+  }
+  current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  thread_bytes -= std::int64_t(bytes);
+}
+
+thread_allocation_stats thread_allocations() noexcept {
+  return thread_allocated;
+}
+
+storage_mark push_storage_mark() noexcept {
+  storage_mark mark{thread_bytes, thread_high};
+  thread_high = thread_bytes;
+  return mark;
+}
+
+std::uint64_t storage_peak(const storage_mark& mark) noexcept {
+  return std::uint64_t(std::max<std::int64_t>(0, thread_high - mark.start));
+}
+
+std::uint64_t pop_storage_mark(const storage_mark& mark) noexcept {
+  std::uint64_t peak = storage_peak(mark);
+  thread_high = std::max(thread_high, mark.outer_high);
+  return peak;
+}
+
+}  // namespace detail
+
+memory_peak_scope::memory_peak_scope() noexcept
+    : mark_(detail::push_storage_mark()) {}
+
+memory_peak_scope::~memory_peak_scope() { detail::pop_storage_mark(mark_); }
+
+std::size_t memory_peak_scope::peak_bytes() const noexcept {
+  return std::size_t(detail::storage_peak(mark_));
+}
+
+}  // namespace math
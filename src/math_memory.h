@@ -0,0 +1,214 @@
+#ifndef CPP_MATH_LIBRARY_MATH_MEMORY_H_
+#define CPP_MATH_LIBRARY_MATH_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "math_status.h"
+
+// Storage of matrices, vectors and large temporaries of kernels is allocated
+// through math::allocator, so it is counted, limited by the memory budget and
+// can be redirected to user hooks.
+
+namespace math {
+
+/**
+ * @brief Thrown instead of allocating storage that would take the library
+ * over its memory budget. Derives from std::bad_alloc, so code that handles
+ * out of memory handles it too.
+ *
+ */
+class memory_budget_exceeded : public std::bad_alloc {
+ public:
+  memory_budget_exceeded(std::size_t requested, std::size_t in_use,
+                         std::size_t budget);
+
+  const char* what() const noexcept override;
+
+  // Bytes of the rejected allocation
+  std::size_t requested() const noexcept;
+
+  // Bytes of storage allocated when the allocation was rejected
+  std::size_t in_use() const noexcept;
+
+  std::size_t budget() const noexcept;
+
+ private:
+  std::size_t requested_;
+  std::size_t in_use_;
+  std::size_t budget_;
+  std::string message_;
+};
+
+/**
+ * @brief Interface to take over storage allocation, e.g. to place matrices in
+ * an arena or in huge pages. Memory is released through the hooks it was
+ * allocated with, so they must outlive all storage allocated by them.
+ *
+ */
+class allocation_hooks {
+ public:
+  virtual ~allocation_hooks() = default;
+
+  // Returns at least bytes of memory aligned for double, throws on failure
+  virtual void* allocate(std::size_t bytes) = 0;
+
+  // Releases memory returned by allocate(bytes)
+  virtual void deallocate(void* p, std::size_t bytes) noexcept = 0;
+};
+
+// Sets hooks used by storage allocated from now on, nullptr - operator new
+void set_allocation_hooks(allocation_hooks* hooks) noexcept;
+
+// Returns hooks used by new storage, nullptr if it uses operator new
+allocation_hooks* get_allocation_hooks() noexcept;
+
+// Storage allocated by the library, counted over all threads
+struct memory_usage_stats {
+  std::size_t current_bytes = 0;  // allocated and not released yet
+  std::size_t peak_bytes = 0;     // maximum of current_bytes
+  std::uint64_t allocations = 0;  // successful allocations
+};
+
+// Returns current storage usage
+memory_usage_stats memory_usage() noexcept;
+
+// Lowers peak_bytes to current_bytes
+void reset_peak_memory() noexcept;
+
+/**
+ * @brief Limits storage allocated by the library at any moment: allocations
+ * that would exceed bytes throw memory_budget_exceeded. Storage allocated
+ * before is kept even if it exceeds the new budget. 0 removes the limit.
+ *
+ */
+void set_memory_budget(std::size_t bytes) noexcept;
+
+// Returns memory budget, 0 if unlimited
+std::size_t memory_budget() noexcept;
+
+namespace detail {
+
+// Counts bytes, checks the budget and allocates them with hooks
+void* allocate_storage(std::size_t bytes, allocation_hooks* hooks);
+
+void deallocate_storage(void* p, std::size_t bytes,
+                        allocation_hooks* hooks) noexcept;
+
+// Storage allocations made by the calling thread since it started
+struct thread_allocation_stats {
+  std::uint64_t allocations;
+  std::uint64_t bytes;
+};
+
+thread_allocation_stats thread_allocations() noexcept;
+
+// Position of per-operation storage accounting of the calling thread
+struct storage_mark {
+  std::int64_t start;
+  std::int64_t outer_high;
+};
+
+// Starts measuring the highest storage usage of the calling thread
+storage_mark push_storage_mark() noexcept;
+
+// Returns the highest storage usage above the mark so far, while no mark
+// pushed after it is active
+std::uint64_t storage_peak(const storage_mark& mark) noexcept;
+
+// Returns the highest storage usage above the mark since push_storage_mark()
+std::uint64_t pop_storage_mark(const storage_mark& mark) noexcept;
+
+}  // namespace detail
+
+/**
+ * @brief Measures the most library storage held by the calling thread while
+ * the scope is alive, above what the thread held when it started: the peak of
+ * one operation or of a block of them. Available in every build, operation
+ * counters of MATH_INSTRUMENTATION builds (op_stats::peak_bytes) come from
+ * the same accounting. Storage allocated by thread pool workers is not
+ * included. Scopes nest; peak_bytes() of an outer scope is exact while no
+ * inner scope is alive.
+ *
+ */
+class memory_peak_scope {
+ public:
+  memory_peak_scope() noexcept;
+  ~memory_peak_scope();
+
+  memory_peak_scope(const memory_peak_scope&) = delete;
+  memory_peak_scope& operator=(const memory_peak_scope&) = delete;
+
+  // Returns the highest storage usage above the start of the scope so far
+  std::size_t peak_bytes() const noexcept;
+
+ private:
+  detail::storage_mark mark_;
+};
+
+/**
+ * @brief Standard allocator over the library storage accounting. Remembers
+ * hooks set when it was constructed, containers copied later pick the hooks
+ * set at that time.
+ *
+ */
+template <class T>
+class allocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  allocator() noexcept : hooks_(get_allocation_hooks()) {}
+
+  template <class U>
+  allocator(const allocator<U>& other) noexcept : hooks_(other.hooks()) {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      MATH_THROW(std::bad_array_new_length());
+    }
+    return static_cast<T*>(detail::allocate_storage(n * sizeof(T), hooks_));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    detail::deallocate_storage(p, n * sizeof(T), hooks_);
+  }
+
+  allocator select_on_container_copy_construction() const noexcept {
+    return allocator();
+  }
+
+  allocation_hooks* hooks() const noexcept { return hooks_; }
+
+  template <class U>
+  friend bool operator==(const allocator& l, const allocator<U>& r) noexcept {
+    return l.hooks() == r.hooks();
+  }
+
+  template <class U>
+  friend bool operator!=(const allocator& l, const allocator<U>& r) noexcept {
+    return l.hooks() != r.hooks();
+  }
+
+ private:
+  allocation_hooks* hooks_;
+};
+
+namespace detail {
+
+// Contiguous temporary counted as library storage
+template <class T>
+using buffer = std::vector<T, allocator<T>>;
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_MEMORY_H_
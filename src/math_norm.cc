@@ -0,0 +1,210 @@
+#include "math_norm.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "math_cross_check.h"
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_parallel.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+bool is_contiguous(const const_vector_view& x) noexcept {
+  return x.stride() == 1;
+}
+
+// Returns power of 2 that brings max into [0.5, 1), so scaling is exact and
+// squares can not overflow. Subnormal max is brought to at least 2^-52
+double scale_for(double max) noexcept {
+  return std::ldexp(1.0, std::min(1022, -std::ilogb(max) - 1));
+}
+
+// Returns largest element, NaN if there is one
+double max_of(const std::vector<double>& values) noexcept {
+  double result = 0;
+  for (double value : values) {
+    result = detail::max_propagating_nan(result, value);
+  }
+  return result;
+}
+
+double scaled_sumsq(const_vector_view x, double scale) {
+  if (is_contiguous(x)) {
+    return detail::parallel_sum(x.size(), detail::kBlas1Grain,
+                                [&](std::size_t first, std::size_t last) {
+                                  return detail::scaled_sumsq_kernel(
+                                      last - first, x.data() + first, scale);
+                                });
+  }
+
+  double result = 0;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    double value = x[i] * scale;
+    result += value * value;
+  }
+  return result;
+}
+
+double fast_norm2(const_vector_view x) {
+  // fast path: one pass without scaling
+  double sumsq = scaled_sumsq(x, 1.0);
+
+  // squares of elements lost to underflow can not change such a sum
+  if (std::isfinite(sumsq) &&
+      sumsq >= double(x.size()) * (DBL_MIN / DBL_EPSILON)) {
+    return std::sqrt(sumsq);
+  }
+  if (std::isnan(sumsq)) return sumsq;
+
+  double max = norm_inf(x);
+  if (max == 0 || std::isinf(max)) return max;
+
+  double scale = scale_for(max);
+  return std::sqrt(scaled_sumsq(x, scale)) / scale;
+}
+
+double fast_norm_inf(const_vector_view x) {
+  if (!is_contiguous(x)) {
+    double result = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      result = detail::max_propagating_nan(result, std::fabs(x[i]));
+    }
+    return result;
+  }
+  if (x.size() <= detail::kBlas1Grain) {
+    return detail::amax_kernel(x.size(), x.data());
+  }
+
+  std::vector<double> partials(
+      detail::chunks_count(x.size(), detail::kBlas1Grain));
+  detail::parallel_for(x.size(), detail::kBlas1Grain,
+                       [&](std::size_t first, std::size_t last) {
+                         partials[first / detail::kBlas1Grain] =
+                             detail::amax_kernel(last - first,
+                                                 x.data() + first);
+                       });
+
+  return max_of(partials);
+}
+
+double fast_norm_p(const_vector_view x, double p) {
+  double max = norm_inf(x);
+  if (max == 0 || std::isinf(max)) return max;
+
+  // every term is divided by max, not multiplied by a power of 2 near 1 / max:
+  // terms stay at most 1 for any p, and 1 / max overflows for subnormal max
+  double sum = 0;
+  if (is_contiguous(x)) {
+    sum = detail::parallel_sum(x.size(), detail::kBlas1Grain,
+                               [&](std::size_t first, std::size_t last) {
+                                 return detail::relative_pow_sum_kernel(
+                                     last - first, x.data() + first, max, p);
+                               });
+  } else {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      sum += std::pow(std::fabs(x[i]) / max, p);
+    }
+  }
+
+  return max * std::pow(sum, 1 / p);
+}
+
+}  // namespace
+
+double norm1(const_vector_view x) {
+  double result = asum(x);
+  if (detail::cross_check_sampled()) detail::check_norm("norm1", x, 1, result);
+  return result;
+}
+
+double norm2(const_vector_view x) {
+  MATH_INSTRUMENT_OP("norm2", 2.0 * x.size(), 8.0 * x.size(), x.size());
+  double result = fast_norm2(x);
+  if (detail::cross_check_sampled()) detail::check_norm("norm2", x, 2, result);
+  return result;
+}
+
+double norm_inf(const_vector_view x) {
+  MATH_INSTRUMENT_OP("norm_inf", x.size(), 8.0 * x.size(), x.size());
+  double result = fast_norm_inf(x);
+  if (detail::cross_check_sampled()) {
+    detail::check_norm("norm_inf", x, HUGE_VAL, result);
+  }
+  return result;
+}
+
+double norm(const_vector_view x, double p) {
+  MATH_INSTRUMENT_OP("norm", 3.0 * x.size(), 16.0 * x.size(), x.size());
+  if (std::isnan(p) || p < 1) {
+    MATH_THROW(std::invalid_argument("p-norm is defined for p >= 1, p = " +
+                                     std::to_string(p)));
+  }
+
+  if (p == 1) return norm1(x);
+  if (p == 2) return norm2(x);
+  if (std::isinf(p)) return norm_inf(x);
+
+  double result = fast_norm_p(x, p);
+  if (detail::cross_check_sampled()) detail::check_norm("norm", x, p, result);
+  return result;
+}
+
+double norm_frobenius(const matrix& m) {
+  return norm2(const_vector_view(m.data(), m.rows() * m.columns()));
+}
+
+double norm1(const matrix& m) {
+  MATH_INSTRUMENT_OP("norm1(matrix)", double(m.rows()) * m.columns(),
+                     8.0 * m.rows() * m.columns(), m.rows(), m.columns());
+  // rows are streamed once, every thread accumulates its own columns
+  std::vector<double> sums(m.columns());
+  std::size_t grain = std::max<std::size_t>(1, detail::kBlas1Grain / m.rows());
+
+  detail::parallel_for(m.columns(), grain,
+                       [&](std::size_t first, std::size_t last) {
+                         for (std::size_t i = 0; i < m.rows(); ++i) {
+                           const double* row = m.data() + i * m.columns();
+                           for (std::size_t j = first; j < last; ++j) {
+                             sums[j] += std::fabs(row[j]);
+                           }
+                         }
+                       });
+
+  double result = max_of(sums);
+  if (detail::cross_check_sampled()) {
+    detail::check_matrix_norm("norm1(matrix)", m, 1, result);
+  }
+  return result;
+}
+
+double norm_inf(const matrix& m) {
+  MATH_INSTRUMENT_OP("norm_inf(matrix)", double(m.rows()) * m.columns(),
+                     8.0 * m.rows() * m.columns(), m.rows(), m.columns());
+  std::vector<double> sums(m.rows());
+  std::size_t grain =
+      std::max<std::size_t>(1, detail::kBlas1Grain / m.columns());
+
+  detail::parallel_for(m.rows(), grain,
+                       [&](std::size_t first, std::size_t last) {
+                         for (std::size_t i = first; i < last; ++i) {
+                           sums[i] = detail::asum_kernel(
+                               m.columns(), m.data() + i * m.columns());
+                         }
+                       });
+
+  double result = max_of(sums);
+  if (detail::cross_check_sampled()) {
+    detail::check_matrix_norm("norm_inf(matrix)", m, HUGE_VAL, result);
+  }
+  return result;
+}
+
+}  // namespace math
@@ -0,0 +1,46 @@
+#ifndef CPP_MATH_LIBRARY_MATH_NORM_H_
+#define CPP_MATH_LIBRARY_MATH_NORM_H_
+
+#include "math_blas.h"
+#include "math_matrix.h"
+
+namespace math {
+
+// Vector norms. Long contiguous vectors are processed by several threads.
+
+// Returns sum of absolute values
+double norm1(const_vector_view x);
+
+/**
+ * @brief Returns euclidean norm. Sum of squares is rescaled when it overflows
+ * or loses small elements to underflow, so the result is accurate for any
+ * finite elements
+ *
+ */
+double norm2(const_vector_view x);
+
+// Returns maximum of absolute values
+double norm_inf(const_vector_view x);
+
+/**
+ * @brief Returns p-norm (sum |x[i]|^p)^(1 / p) scaled by the maximum absolute
+ * value to avoid overflow. p may be infinity. Throws std::invalid_argument if
+ * p < 1
+ *
+ */
+double norm(const_vector_view x, double p);
+
+// Matrix norms
+
+// Returns square root of sum of squares of all elements
+double norm_frobenius(const matrix& m);
+
+// Returns maximum of column sums of absolute values
+double norm1(const matrix& m);
+
+// Returns maximum of row sums of absolute values
+double norm_inf(const matrix& m);
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_NORM_H_
@@ -0,0 +1,204 @@
+#include "math_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "math_instrumentation.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+thread_local bool in_parallel_region = false;
+
+std::size_t hardware_threads() noexcept {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// State of one parallel_for call shared between the caller and the workers
+struct job {
+  job(std::size_t elements, std::size_t chunk_size,
+      const std::function<void(std::size_t, std::size_t)>& function)
+      : count(elements),
+        grain(chunk_size),
+        chunks(detail::chunks_count(elements, chunk_size)),
+        body(function) {}
+
+  // Takes chunks until there are none left
+  void work() {
+    in_parallel_region = true;
+    for (std::size_t chunk = next.fetch_add(1); chunk < chunks;
+         chunk = next.fetch_add(1)) {
+      if (failed.load()) continue;
+
+#if MATH_EXCEPTIONS
+      try {
+        run_chunk(chunk);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+        failed.store(true);
+      }
+#else
+      run_chunk(chunk);
+#endif
+    }
+    in_parallel_region = false;
+  }
+
+  void run_chunk(std::size_t chunk) {
+#ifdef MATH_INSTRUMENTATION
+    detail::task_scope trace(id, chunk);
+#endif
+    std::size_t first = chunk * grain;
+    body(first, std::min(count, first + grain));
+  }
+
+  const std::size_t count;
+  const std::size_t grain;
+  const std::size_t chunks;
+  const std::function<void(std::size_t, std::size_t)>& body;
+#ifdef MATH_INSTRUMENTATION
+  const std::uint64_t id = detail::new_job_id();
+#endif
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+
+  std::mutex mutex;
+  std::condition_variable done;
+  std::size_t helpers_left = 0;
+};
+
+class thread_pool {
+ public:
+  static thread_pool& instance() {
+    static thread_pool pool;
+    return pool;
+  }
+
+  ~thread_pool() { stop_workers(); }
+
+  void set_threads(std::size_t threads) {
+    std::lock_guard<std::mutex> lock(resize_mutex_);
+    stop_workers();
+    threads_.store(threads ? threads : hardware_threads());
+  }
+
+  std::size_t threads() const noexcept { return threads_.load(); }
+
+  void run(const std::shared_ptr<job>& j, std::size_t helpers) {
+    {
+      std::lock_guard<std::mutex> lock(resize_mutex_);
+      start_workers();
+      helpers = std::min(helpers, workers_.size());
+      j->helpers_left = helpers;
+
+      std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+      for (std::size_t i = 0; i < helpers; ++i) queue_.push_back(j);
+    }
+    queue_cv_.notify_all();
+
+    j->work();
+
+    std::unique_lock<std::mutex> lock(j->mutex);
+    j->done.wait(lock, [&j] { return j->helpers_left == 0; });
+  }
+
+ private:
+  thread_pool() : threads_(hardware_threads()) {}
+
+  void start_workers() {
+    if (!workers_.empty() || threads_.load() < 2) return;
+
+    stopping_ = false;
+    for (std::size_t i = 1; i < threads_.load(); ++i) {
+      workers_.emplace_back([this] { worker_loop(); });
+    }
+  }
+
+  void stop_workers() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+  }
+
+  void worker_loop() {
+    while (true) {
+      std::shared_ptr<job> j;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+
+        j = std::move(queue_.front());
+        queue_.pop_front();
+      }
+
+      j->work();
+
+      std::lock_guard<std::mutex> lock(j->mutex);
+      if (--j->helpers_left == 0) j->done.notify_one();
+    }
+  }
+
+  std::atomic<std::size_t> threads_;
+
+  std::mutex resize_mutex_;
+  std::vector<std::thread> workers_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<std::shared_ptr<job>> queue_;
+  bool stopping_ = false;
+};
+
+}  // namespace
+
+void set_num_threads(std::size_t threads) {
+  thread_pool::instance().set_threads(threads);
+}
+
+std::size_t num_threads() noexcept {
+  return thread_pool::instance().threads();
+}
+
+namespace detail {
+
+void parallel_for(std::size_t count, std::size_t grain,
+                  const std::function<void(std::size_t, std::size_t)>& body) {
+  if (!count) return;
+
+  std::size_t chunks = chunks_count(count, grain);
+  std::size_t threads = num_threads();
+  if (chunks == 1 || threads == 1 || in_parallel_region) {
+    for (std::size_t first = 0; first < count; first += grain) {
+      body(first, std::min(count, first + grain));
+    }
+    return;
+  }
+
+  auto j = std::make_shared<job>(count, grain, body);
+  thread_pool::instance().run(j, std::min(threads, chunks) - 1);
+
+#if MATH_EXCEPTIONS
+  if (j->error) std::rethrow_exception(j->error);
+#endif
+}
+
+}  // namespace detail
+
+}  // namespace math
@@ -0,0 +1,66 @@
+#ifndef CPP_MATH_LIBRARY_MATH_PARALLEL_H_
+#define CPP_MATH_LIBRARY_MATH_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace math {
+
+/**
+ * @brief Set number of threads used by parallel kernels, including the calling
+ * thread. 0 means std::thread::hardware_concurrency(), 1 disables threading
+ *
+ * @param threads new threads count
+ */
+void set_num_threads(std::size_t threads);
+
+// Returns number of threads used by parallel kernels
+std::size_t num_threads() noexcept;
+
+namespace detail {
+
+/**
+ * @brief Splits [0, count) into chunks of grain elements (the last one can be
+ * smaller) and calls body(first, last) for every chunk. Chunk boundaries depend
+ * only on count and grain, so reductions over chunks are reproducible for any
+ * threads count. Runs serially if there is only one chunk, only one thread or
+ * if called from inside of another parallel region. Rethrows the first
+ * exception thrown by body.
+ *
+ * @param count number of elements
+ * @param grain chunk size, must be greater than 0
+ * @param body function to call for every chunk
+ */
+void parallel_for(std::size_t count, std::size_t grain,
+                  const std::function<void(std::size_t, std::size_t)>& body);
+
+// Returns number of chunks parallel_for splits count elements into
+inline std::size_t chunks_count(std::size_t count, std::size_t grain) noexcept {
+  return (count + grain - 1) / grain;
+}
+
+/**
+ * @brief Sums chunk(first, last) results over chunks of parallel_for in
+ * order, so the result does not depend on threads count
+ *
+ */
+template <class Chunk>
+double parallel_sum(std::size_t count, std::size_t grain, Chunk chunk) {
+  if (count <= grain) return count ? chunk(0, count) : 0;
+
+  std::vector<double> partials(chunks_count(count, grain));
+  parallel_for(count, grain, [&](std::size_t first, std::size_t last) {
+    partials[first / grain] = chunk(first, last);
+  });
+
+  double result = 0;
+  for (double partial : partials) result += partial;
+  return result;
+}
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_PARALLEL_H_
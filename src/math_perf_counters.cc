@@ -0,0 +1,106 @@
+#include "math_perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace math {
+
+namespace detail {
+
+#if defined(__linux__)
+
+namespace {
+
+// Event group of one thread: cycles lead and are read together with members
+class perf_group {
+ public:
+  perf_group() noexcept {
+    leader_ = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (leader_ < 0) return;
+
+    slots_[hardware_cycles] = 0;
+    std::size_t next = 1;
+    auto add = [&](std::size_t event, std::uint32_t type,
+                   std::uint64_t config) {
+      int fd = open(type, config, leader_);
+      if (fd < 0) return;
+      members_[event] = fd;
+      slots_[event] = int(next++);
+    };
+
+    add(hardware_instructions, PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_INSTRUCTIONS);
+    add(hardware_l1d_misses, PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    add(hardware_llc_misses, PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_CACHE_MISSES);
+    add(hardware_branch_misses, PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_BRANCH_MISSES);
+  }
+
+  ~perf_group() {
+    for (int fd : members_) {
+      if (fd >= 0) close(fd);
+    }
+    if (leader_ >= 0) close(leader_);
+  }
+
+  perf_group(const perf_group&) = delete;
+  perf_group& operator=(const perf_group&) = delete;
+
+  bool read_into(hardware_sample* sample) const noexcept {
+    if (leader_ < 0) return false;
+
+    // nr, time_enabled, time_running, values of the group in opening order
+    std::uint64_t buffer[3 + kHardwareEvents] = {};
+    if (::read(leader_, buffer, sizeof(buffer)) <= 0) return false;
+
+    sample->enabled = buffer[1];
+    sample->running = buffer[2];
+    for (std::size_t i = 0; i < kHardwareEvents; ++i) {
+      sample->values[i] = slots_[i] < 0 ? 0 : buffer[3 + slots_[i]];
+    }
+    return true;
+  }
+
+ private:
+  static int open(std::uint32_t type, std::uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+  }
+
+  int leader_ = -1;
+  int members_[kHardwareEvents] = {-1, -1, -1, -1, -1};
+  int slots_[kHardwareEvents] = {-1, -1, -1, -1, -1};
+};
+
+}  // namespace
+
+bool read_hardware_counters(hardware_sample* sample) noexcept {
+  thread_local perf_group group;
+  return group.read_into(sample);
+}
+
+#else
+
+bool read_hardware_counters(hardware_sample*) noexcept { return false; }
+
+#endif
+
+}  // namespace detail
+
+}  // namespace math
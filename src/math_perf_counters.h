@@ -0,0 +1,26 @@
+#ifndef CPP_MATH_LIBRARY_MATH_PERF_COUNTERS_H_
+#define CPP_MATH_LIBRARY_MATH_PERF_COUNTERS_H_
+
+#include "math_instrumentation.h"
+
+// Internal header: hardware counters of the calling thread read through Linux
+// perf_event_open. On other systems counters are never available.
+
+namespace math {
+
+namespace detail {
+
+/**
+ * @brief Reads hardware counters of the calling thread, opening them on the
+ * first call of the thread. Returns false if counters can not be opened, e.g.
+ * forbidden by kernel.perf_event_paranoid or missing in a virtual machine.
+ * Events unsupported by the CPU read as 0.
+ *
+ */
+bool read_hardware_counters(hardware_sample* sample) noexcept;
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_PERF_COUNTERS_H_
@@ -0,0 +1,155 @@
+#include "math_small_kernels.h"
+
+#include <array>
+#include <utility>
+
+#include "math_kernels.h"
+
+#if defined(__clang__)
+#define MATH_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define MATH_UNROLL _Pragma("GCC unroll 16")
+#else
+#define MATH_UNROLL
+#endif
+
+namespace math {
+
+namespace detail {
+
+namespace {
+
+constexpr std::size_t kSmallSizes = kSmallMax - kSmallMin + 1;
+
+bool is_small(std::size_t size) noexcept {
+  return size >= kSmallMin && size <= kSmallMax;
+}
+
+// Rows are not unrolled: K x N kernels cover every row count with 225
+// instead of 3375 instantiations. Every element sums its products in the
+// order of gemm_kernel.
+template <std::size_t K, std::size_t N>
+void small_gemm(std::size_t m, const double* MATH_RESTRICT a,
+                const double* MATH_RESTRICT b,
+                double* MATH_RESTRICT c) noexcept {
+  for (std::size_t i = 0; i < m; ++i) {
+    double row[N] = {};
+    MATH_UNROLL
+    for (std::size_t p = 0; p < K; ++p) {
+      double s = a[i * K + p];
+      MATH_UNROLL
+      for (std::size_t j = 0; j < N; ++j) row[j] += s * b[p * N + j];
+    }
+    MATH_UNROLL
+    for (std::size_t j = 0; j < N; ++j) c[i * N + j] = row[j];
+  }
+}
+
+template <std::size_t Rows, std::size_t Columns>
+void small_transpose(const double* MATH_RESTRICT a,
+                     double* MATH_RESTRICT b) noexcept {
+  MATH_UNROLL
+  for (std::size_t i = 0; i < Rows; ++i) {
+    MATH_UNROLL
+    for (std::size_t j = 0; j < Columns; ++j) {
+      b[j * Rows + i] = a[i * Columns + j];
+    }
+  }
+}
+
+// Elimination of matrix::upper_triangle_matrix: a zero pivot gets the first
+// row below with a non-zero element added, no rows are swapped
+template <std::size_t N>
+double small_determinant(const double* a) noexcept {
+  double t[N * N];
+  MATH_UNROLL
+  for (std::size_t i = 0; i < N * N; ++i) t[i] = a[i];
+
+  for (std::size_t j = 0; j + 1 < N; ++j) {
+    std::size_t pivot = j;
+    while (pivot < N && !t[pivot * N + j]) ++pivot;
+    if (pivot == N) continue;
+
+    if (pivot != j) {
+      MATH_UNROLL
+      for (std::size_t k = 0; k < N; ++k) t[j * N + k] += t[pivot * N + k];
+    }
+    for (std::size_t i = j + 1; i < N; ++i) {
+      if (!t[i * N + j]) continue;
+
+      double multiplier = t[i * N + j] / t[j * N + j];
+      MATH_UNROLL
+      for (std::size_t k = 0; k < N; ++k) {
+        t[i * N + k] -= t[j * N + k] * multiplier;
+      }
+    }
+  }
+
+  double result = 1;
+  MATH_UNROLL
+  for (std::size_t i = 0; i < N; ++i) result *= t[i * N + i];
+  return result;
+}
+
+template <std::size_t K, std::size_t... N>
+constexpr std::array<small_gemm_kernel, kSmallSizes> gemm_row(
+    std::index_sequence<N...>) {
+  return {{&small_gemm<K, N + kSmallMin>...}};
+}
+
+template <std::size_t... K>
+constexpr std::array<std::array<small_gemm_kernel, kSmallSizes>, kSmallSizes>
+gemm_table(std::index_sequence<K...>) {
+  return {
+      {gemm_row<K + kSmallMin>(std::make_index_sequence<kSmallSizes>())...}};
+}
+
+template <std::size_t Rows, std::size_t... Columns>
+constexpr std::array<small_transpose_kernel, kSmallSizes> transpose_row(
+    std::index_sequence<Columns...>) {
+  return {{&small_transpose<Rows, Columns + kSmallMin>...}};
+}
+
+template <std::size_t... Rows>
+constexpr std::array<std::array<small_transpose_kernel, kSmallSizes>,
+                     kSmallSizes>
+transpose_table(std::index_sequence<Rows...>) {
+  return {{transpose_row<Rows + kSmallMin>(
+      std::make_index_sequence<kSmallSizes>())...}};
+}
+
+template <std::size_t... N>
+constexpr std::array<small_determinant_kernel, kSmallSizes>
+determinant_table(std::index_sequence<N...>) {
+  return {{&small_determinant<N + kSmallMin>...}};
+}
+
+constexpr auto kGemmKernels =
+    gemm_table(std::make_index_sequence<kSmallSizes>());
+constexpr auto kTransposeKernels =
+    transpose_table(std::make_index_sequence<kSmallSizes>());
+constexpr auto kDeterminantKernels =
+    determinant_table(std::make_index_sequence<kSmallSizes>());
+
+}  // namespace
+
+small_gemm_kernel find_small_gemm(std::size_t m, std::size_t k,
+                                  std::size_t n) noexcept {
+  if (!is_small(m) || !is_small(k) || !is_small(n)) return nullptr;
+  return kGemmKernels[k - kSmallMin][n - kSmallMin];
+}
+
+small_transpose_kernel find_small_transpose(std::size_t rows,
+                                            std::size_t columns) noexcept {
+  if (!is_small(rows) || !is_small(columns)) return nullptr;
+  return kTransposeKernels[rows - kSmallMin][columns - kSmallMin];
+}
+
+small_determinant_kernel find_small_determinant(std::size_t n) noexcept {
+  if (!is_small(n)) return nullptr;
+  return kDeterminantKernels[n - kSmallMin];
+}
+
+}  // namespace detail
+
+}  // namespace math
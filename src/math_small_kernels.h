@@ -0,0 +1,44 @@
+#ifndef CPP_MATH_LIBRARY_MATH_SMALL_KERNELS_H_
+#define CPP_MATH_LIBRARY_MATH_SMALL_KERNELS_H_
+
+#include <cstddef>
+
+// Internal header with kernels for small matrices. Every kernel is generated
+// for sizes fixed at compile time, so its loops are fully unrolled and kept
+// in registers; dynamic matrices pick one from a table by their sizes. They
+// compute in the same order as the general kernels, so results are the same.
+
+namespace math {
+
+namespace detail {
+
+// Smallest and largest size of small matrix kernels
+constexpr std::size_t kSmallMin = 2;
+constexpr std::size_t kSmallMax = 16;
+
+// c = a * b for row-major m x k matrix a and k x n matrix b
+using small_gemm_kernel = void (*)(std::size_t m, const double* a,
+                                   const double* b, double* c) noexcept;
+
+// b = a^T for row-major rows x columns matrix a
+using small_transpose_kernel = void (*)(const double* a, double* b) noexcept;
+
+// Returns determinant of row-major n x n matrix a
+using small_determinant_kernel = double (*)(const double* a) noexcept;
+
+// Returns kernel for m x k by k x n product, nullptr if a size is not small
+small_gemm_kernel find_small_gemm(std::size_t m, std::size_t k,
+                                  std::size_t n) noexcept;
+
+// Returns kernel for rows x columns matrix, nullptr if a size is not small
+small_transpose_kernel find_small_transpose(std::size_t rows,
+                                            std::size_t columns) noexcept;
+
+// Returns kernel for n x n matrix, nullptr if n is not small
+small_determinant_kernel find_small_determinant(std::size_t n) noexcept;
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_SMALL_KERNELS_H_
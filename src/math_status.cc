@@ -0,0 +1,40 @@
+#include "math_status.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace math {
+
+const char* to_string(status s) noexcept {
+  switch (s) {
+    case status::ok:
+      return "ok";
+    case status::out_of_range:
+      return "out of range";
+    case status::size_mismatch:
+      return "sizes mismatch";
+    case status::not_square:
+      return "matrix is not square";
+    case status::singular:
+      return "matrix is singular";
+  }
+  return "unknown status";
+}
+
+namespace detail {
+
+void fail(const std::exception& error) noexcept {
+  std::cerr << "math: " << error.what() << std::endl;
+  std::abort();
+}
+
+void throw_bad_expected_access(status s) {
+  MATH_THROW(std::logic_error(std::string("Expected value is missing: ") +
+                              to_string(s)));
+}
+
+}  // namespace detail
+
+}  // namespace math
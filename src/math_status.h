@@ -0,0 +1,115 @@
+#ifndef CPP_MATH_LIBRARY_MATH_STATUS_H_
+#define CPP_MATH_LIBRARY_MATH_STATUS_H_
+
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Errors of checked operations are thrown as standard exceptions. For code
+// that can not afford them every hot checked operation has a try_ version
+// that returns a status instead and builds no message. try_ versions that
+// allocate storage (try_multiply, try_determinant, try_inverse, try_dot) still
+// throw std::bad_alloc, memory_budget_exceeded included, when it can not be
+// allocated, and pass on exceptions of cross-check handlers; try_at, try_add
+// and try_subtract are noexcept. The library also builds with -fno-exceptions
+// (make NO_EXCEPTIONS=1): errors of throwing operations then write their
+// message to std::cerr and abort, so such programs use only try_ versions
+// where errors are expected.
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define MATH_EXCEPTIONS 1
+#else
+#define MATH_EXCEPTIONS 0
+#endif
+
+namespace math {
+
+// Result of a non-throwing operation
+enum class status {
+  ok,
+  out_of_range,   // position outside of the matrix or vector
+  size_mismatch,  // sizes of operands do not match
+  not_square,     // operation needs a square matrix
+  singular,       // matrix is singular
+};
+
+// Returns static description of s
+const char* to_string(status s) noexcept;
+
+namespace detail {
+
+// Writes what() of error to std::cerr and aborts
+[[noreturn]] void fail(const std::exception& error) noexcept;
+
+// Thrown by expected::value() without a value
+[[noreturn]] void throw_bad_expected_access(status s);
+
+}  // namespace detail
+
+/**
+ * @brief Value of type T or the status of the failure that prevented it,
+ * a small subset of C++23 std::expected.
+ *
+ */
+template <class T>
+class expected {
+ public:
+  expected(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : value_(std::move(value)) {}
+
+  // s must not be status::ok
+  expected(status s) noexcept : status_(s) {}
+
+  bool has_value() const noexcept { return status_ == status::ok; }
+
+  explicit operator bool() const noexcept { return has_value(); }
+
+  // Returns status::ok if there is a value
+  status error() const noexcept { return status_; }
+
+  /**
+   * @brief Returns the value. Throws std::logic_error (aborts without
+   * exceptions) if there is none
+   *
+   */
+  T& value() & {
+    if (!has_value()) detail::throw_bad_expected_access(status_);
+    return *value_;
+  }
+
+  const T& value() const& {
+    if (!has_value()) detail::throw_bad_expected_access(status_);
+    return *value_;
+  }
+
+  T&& value() && {
+    if (!has_value()) detail::throw_bad_expected_access(status_);
+    return std::move(*value_);
+  }
+
+  // Returns the value, or fallback if there is none
+  T value_or(T fallback) const& { return has_value() ? *value_ : fallback; }
+
+  // Unchecked access to the value
+  T& operator*() & noexcept { return *value_; }
+  const T& operator*() const& noexcept { return *value_; }
+  T&& operator*() && noexcept { return std::move(*value_); }
+  T* operator->() noexcept { return &*value_; }
+  const T* operator->() const noexcept { return &*value_; }
+
+ private:
+  std::optional<T> value_;
+  status status_ = status::ok;
+};
+
+}  // namespace math
+
+// Throws exception, or passes it to math::detail::fail without exceptions
+#if MATH_EXCEPTIONS
+#define MATH_THROW(exception) throw exception
+#else
+#define MATH_THROW(exception) ::math::detail::fail(exception)
+#endif
+
+#endif  // CPP_MATH_LIBRARY_MATH_STATUS_H_
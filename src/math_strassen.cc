@@ -0,0 +1,259 @@
+#include "math_strassen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "math_kernels.h"
+#include "math_memory.h"
+#include "math_parallel.h"
+#include "math_status.h"
+#include "math_tuning.h"
+
+namespace math {
+
+namespace {
+
+std::atomic<bool> enabled{false};
+std::atomic<std::size_t> crossover{strassen_options().crossover};
+std::atomic<std::size_t> memory_limit{0};
+std::atomic<bool> parallel{true};
+
+// Strided square block of a row-major matrix
+struct block {
+  double* data;
+  std::size_t ld;
+
+  double* operator()(std::size_t i, std::size_t j) const noexcept {
+    return data + i * ld + j;
+  }
+};
+
+struct const_block {
+  const double* data;
+  std::size_t ld;
+
+  const_block(const double* d, std::size_t l) noexcept : data(d), ld(l) {}
+  const_block(const block& b) noexcept : data(b.data), ld(b.ld) {}
+
+  const double* operator()(std::size_t i, std::size_t j) const noexcept {
+    return data + i * ld + j;
+  }
+};
+
+// z = x + y elementwise, z may be x or y
+void add(std::size_t n, const_block x, const_block y, block z) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double* xi = x(i, 0);
+    const double* yi = y(i, 0);
+    double* zi = z(i, 0);
+    for (std::size_t j = 0; j < n; ++j) zi[j] = xi[j] + yi[j];
+  }
+}
+
+// z = x - y elementwise, z may be x or y
+void subtract(std::size_t n, const_block x, const_block y, block z) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double* xi = x(i, 0);
+    const double* yi = y(i, 0);
+    double* zi = z(i, 0);
+    for (std::size_t j = 0; j < n; ++j) zi[j] = xi[j] - yi[j];
+  }
+}
+
+// c = a * b by the blocked classical kernel, threaded over rows of c
+void classical(std::size_t n, const_block a, const_block b, block c) {
+  detail::parallel_for(
+      n, tuning().gemm_rows_grain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          std::fill(c(i, 0), c(i, 0) + n, 0.0);
+        }
+        detail::gemm_kernel(last - first, n, n, a(first, 0), a.ld, b.data,
+                            b.ld, c(first, 0), c.ld);
+      });
+}
+
+// Elements of temporaries of the sequential schedule for size n
+std::size_t sequential_elements(std::size_t n, std::size_t cutoff) noexcept {
+  std::size_t elements = 0;
+  for (; n >= cutoff; n /= 2) elements += 2 * (n / 2) * (n / 2);
+  return elements;
+}
+
+// Completes c = a * b for odd n when c holds the product of the leading
+// (n - 1) x (n - 1) blocks
+void peel(std::size_t n, const_block a, const_block b, block c) noexcept {
+  std::size_t m = n - 1;
+  for (std::size_t i = 0; i < m; ++i) {
+    detail::axpy_kernel(m, *a(i, m), b(m, 0), c(i, 0));
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    double sum = 0;
+    for (std::size_t p = 0; p < n; ++p) sum += *a(i, p) * *b(p, m);
+    *c(i, m) = sum;
+  }
+  std::fill(c(m, 0), c(m, 0) + m, 0.0);
+  for (std::size_t p = 0; p < n; ++p) {
+    detail::axpy_kernel(m, *a(m, p), b(p, 0), c(m, 0));
+  }
+}
+
+// c = a * b with the schedule of Douglas et al. (GEMMW) that keeps the seven
+// products in quadrants of c and two temporaries x and y of every level
+void sequential(std::size_t n, const_block a, const_block b, block c,
+                std::size_t cutoff) {
+  if (n < cutoff) {
+    classical(n, a, b, c);
+    return;
+  }
+  if (n % 2) {
+    sequential(n - 1, a, b, c, cutoff);
+    peel(n, a, b, c);
+    return;
+  }
+
+  std::size_t h = n / 2;
+  const_block a11(a(0, 0), a.ld), a12(a(0, h), a.ld);
+  const_block a21(a(h, 0), a.ld), a22(a(h, h), a.ld);
+  const_block b11(b(0, 0), b.ld), b12(b(0, h), b.ld);
+  const_block b21(b(h, 0), b.ld), b22(b(h, h), b.ld);
+  block c11{c(0, 0), c.ld}, c12{c(0, h), c.ld};
+  block c21{c(h, 0), c.ld}, c22{c(h, h), c.ld};
+
+  detail::buffer<double> x_storage(h * h), y_storage(h * h);
+  block x{x_storage.data(), h}, y{y_storage.data(), h};
+
+  subtract(h, a11, a21, x);              // s3
+  subtract(h, b22, b12, y);              // t3
+  sequential(h, x, y, c21, cutoff);      // p7 = s3 t3
+  add(h, a21, a22, x);                   // s1
+  subtract(h, b12, b11, y);              // t1
+  sequential(h, x, y, c22, cutoff);      // p5 = s1 t1
+  subtract(h, x, a11, x);                // s2
+  subtract(h, b22, y, y);                // t2
+  sequential(h, x, y, c12, cutoff);      // p6 = s2 t2
+  subtract(h, a12, x, x);                // s4
+  sequential(h, x, b22, c11, cutoff);    // p3 = s4 b22
+  sequential(h, a11, b11, x, cutoff);    // p1
+  add(h, x, c12, c12);                   // u2 = p1 + p6
+  add(h, c12, c21, c21);                 // u3 = u2 + p7
+  add(h, c12, c22, c12);                 // u4 = u2 + p5
+  add(h, c21, c22, c22);                 // u7 = u3 + p5, c22
+  add(h, c12, c11, c12);                 // u5 = u4 + p3, c12
+  subtract(h, y, b21, y);                // t4
+  sequential(h, a22, y, c11, cutoff);    // p4 = a22 t4
+  subtract(h, c21, c11, c21);            // u6 = u3 - p4, c21
+  sequential(h, a12, b21, c11, cutoff);  // p2
+  add(h, x, c11, c11);                   // u1 = p1 + p2, c11
+}
+
+// Top level with the seven products computed concurrently, n is even
+void concurrent(std::size_t n, const_block a, const_block b, block c,
+                std::size_t cutoff) {
+  std::size_t h = n / 2, size = h * h;
+  const_block a11(a(0, 0), a.ld), a12(a(0, h), a.ld);
+  const_block a21(a(h, 0), a.ld), a22(a(h, h), a.ld);
+  const_block b11(b(0, 0), b.ld), b12(b(0, h), b.ld);
+  const_block b21(b(h, 0), b.ld), b22(b(h, h), b.ld);
+
+  // s1..s4, t1..t4 and p1..p7
+  detail::buffer<double> storage(15 * size);
+  auto temporary = [&](std::size_t k) {
+    return block{storage.data() + k * size, h};
+  };
+  block s1 = temporary(0), s2 = temporary(1), s3 = temporary(2);
+  block s4 = temporary(3), t1 = temporary(4), t2 = temporary(5);
+  block t3 = temporary(6), t4 = temporary(7);
+  add(h, a21, a22, s1);
+  subtract(h, s1, a11, s2);
+  subtract(h, a11, a21, s3);
+  subtract(h, a12, s2, s4);
+  subtract(h, b12, b11, t1);
+  subtract(h, b22, t1, t2);
+  subtract(h, b22, b12, t3);
+  subtract(h, t2, b21, t4);
+
+  const const_block left[7] = {a11, a12, s4, a22, s1, s2, s3};
+  const const_block right[7] = {b11, b21, b22, t4, t1, t2, t3};
+  detail::parallel_for(7, 1, [&](std::size_t first, std::size_t last) {
+    for (std::size_t k = first; k < last; ++k) {
+      sequential(h, left[k], right[k], temporary(8 + k), cutoff);
+    }
+  });
+
+  block p1 = temporary(8), p2 = temporary(9), p3 = temporary(10);
+  block p4 = temporary(11), p5 = temporary(12), p6 = temporary(13);
+  block p7 = temporary(14);
+  block c11{c(0, 0), c.ld}, c12{c(0, h), c.ld};
+  block c21{c(h, 0), c.ld}, c22{c(h, h), c.ld};
+  add(h, p1, p2, c11);       // u1
+  add(h, p1, p6, p6);        // u2
+  add(h, p6, p7, p7);        // u3
+  add(h, p6, p5, p6);        // u4
+  add(h, p6, p3, c12);       // u5
+  subtract(h, p7, p4, c21);  // u6
+  add(h, p7, p5, c22);       // u7
+}
+
+}  // namespace
+
+void set_strassen_options(const strassen_options& options) {
+  if (options.crossover < 2) {
+    MATH_THROW(
+        std::invalid_argument("Strassen crossover can not be less than 2"));
+  }
+  crossover.store(options.crossover, std::memory_order_relaxed);
+  memory_limit.store(options.memory_limit, std::memory_order_relaxed);
+  parallel.store(options.parallel, std::memory_order_relaxed);
+  enabled.store(options.enabled, std::memory_order_relaxed);
+}
+
+strassen_options get_strassen_options() noexcept {
+  strassen_options options;
+  options.enabled = enabled.load(std::memory_order_relaxed);
+  options.crossover = crossover.load(std::memory_order_relaxed);
+  options.memory_limit = memory_limit.load(std::memory_order_relaxed);
+  options.parallel = parallel.load(std::memory_order_relaxed);
+  return options;
+}
+
+namespace detail {
+
+bool use_strassen(std::size_t m, std::size_t k, std::size_t n) noexcept {
+  return enabled.load(std::memory_order_relaxed) && m == k && k == n &&
+         n >= crossover.load(std::memory_order_relaxed);
+}
+
+void strassen_multiply(std::size_t n, const double* a, const double* b,
+                       double* c) {
+  strassen_options options = get_strassen_options();
+  const_block left(a, n), right(b, n);
+  block result{c, n};
+
+  // temporaries have to fit the limit and what is left of the budget
+  std::size_t limit = options.memory_limit ? options.memory_limit : SIZE_MAX;
+  if (std::size_t budget = memory_budget()) {
+    std::size_t in_use = memory_usage().current_bytes;
+    limit = std::min(limit, budget > in_use ? budget - in_use : 0);
+  }
+  auto fits = [limit](std::size_t elements) {
+    return elements <= limit / sizeof(double);
+  };
+
+  std::size_t h = n / 2;
+  std::size_t concurrent_elements =
+      15 * h * h + 7 * sequential_elements(h, options.crossover);
+  if (options.parallel && num_threads() > 1 && n % 2 == 0 &&
+      fits(concurrent_elements)) {
+    concurrent(n, left, right, result, options.crossover);
+  } else if (fits(sequential_elements(n, options.crossover))) {
+    sequential(n, left, right, result, options.crossover);
+  } else {
+    classical(n, left, right, result);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace math
@@ -0,0 +1,58 @@
+#ifndef CPP_MATH_LIBRARY_MATH_STRASSEN_H_
+#define CPP_MATH_LIBRARY_MATH_STRASSEN_H_
+
+#include <cstddef>
+
+// Strassen-Winograd multiplication of large square matrices. It does 7
+// instead of 8 half-size products per level (15 additions), so n x n products
+// take O(n^2.81) operations, and is opt-in because it is less accurate: the
+// error of the classical product is bounded by n u |a| |b| elementwise, the
+// error of Strassen-Winograd only normwise and by about
+// (n / crossover)^2.58 crossover u ||a|| ||b||. Small elements of the result
+// can lose all their digits when a and b have elements of very different
+// magnitudes; scale such matrices first or keep Strassen-Winograd disabled.
+
+namespace math {
+
+/**
+ * @brief Options of Strassen-Winograd multiplication used by
+ * matrix::operator*= for square products.
+ *
+ */
+struct strassen_options {
+  bool enabled = false;          // accuracy trade-off, see above
+  std::size_t crossover = 4096;  // smaller halves use the classical product
+  std::size_t memory_limit = 0;  // bytes of temporaries, 0 for no limit
+  bool parallel = true;          // run the top seven products concurrently
+};
+
+/**
+ * @brief Replaces options of Strassen-Winograd multiplication. Throws
+ * std::invalid_argument if crossover < 2
+ *
+ */
+void set_strassen_options(const strassen_options& options);
+
+strassen_options get_strassen_options() noexcept;
+
+namespace detail {
+
+// Returns true if m x k by k x n product uses Strassen-Winograd
+bool use_strassen(std::size_t m, std::size_t k, std::size_t n) noexcept;
+
+/**
+ * @brief c = a * b for row-major n x n matrices. Temporaries are scheduled
+ * to fit into memory_limit and the memory budget: the top level runs its
+ * seven products concurrently only if their temporaries fit, otherwise
+ * products run one after another with two temporaries per level (2/3 n^2
+ * elements in total); the classical product is used if even they do not fit
+ *
+ */
+void strassen_multiply(std::size_t n, const double* a, const double* b,
+                       double* c);
+
+}  // namespace detail
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_STRASSEN_H_
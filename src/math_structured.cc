@@ -0,0 +1,209 @@
+#include "math_structured.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "math_instrumentation.h"
+#include "math_kernels.h"
+#include "math_memory.h"
+#include "math_parallel.h"
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+using size_type = matrix::size_type;
+
+void check_sizes(const matrix& a, const matrix& b) {
+  if (a.rows() != b.rows() || a.columns() != b.columns()) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: a.rows = " + std::to_string(a.rows()) +
+        ", b.rows = " + std::to_string(b.rows()) +
+        ", a.columns = " + std::to_string(a.columns()) +
+        ", b.columns = " + std::to_string(b.columns())));
+  }
+}
+
+void check_count(std::size_t count) {
+  if (!count) MATH_THROW(std::invalid_argument("No blocks to stack"));
+}
+
+// Rows per thread when every row has width elements
+std::size_t rows_grain(std::size_t width) noexcept {
+  return std::max<std::size_t>(1, detail::kBlas1Grain / width);
+}
+
+std::vector<const matrix*> pointers(const std::vector<matrix>& blocks) {
+  std::vector<const matrix*> result(blocks.size());
+  for (std::size_t i = 0; i < blocks.size(); ++i) result[i] = &blocks[i];
+  return result;
+}
+
+// z[i] = op(x[i], y[i]) for all elements, by several threads if large
+template <class Op>
+matrix elementwise(const matrix& a, const matrix& b, Op op) {
+  check_sizes(a, b);
+  matrix result(a.rows(), a.columns());
+  detail::parallel_for(
+      a.rows() * a.columns(), detail::kBlas1Grain,
+      [&](std::size_t first, std::size_t last) {
+        const double* MATH_RESTRICT x = a.data() + first;
+        const double* MATH_RESTRICT y = b.data() + first;
+        double* MATH_RESTRICT z = result.data() + first;
+        for (std::size_t i = 0; i < last - first; ++i) z[i] = op(x[i], y[i]);
+      });
+  return result;
+}
+
+}  // namespace
+
+matrix kron(const matrix& a, const matrix& b) {
+  size_type rows = a.rows() * b.rows(), columns = a.columns() * b.columns();
+  MATH_INSTRUMENT_OP("kron", double(rows) * columns,
+                     8.0 * rows * columns, rows, columns);
+  matrix result(rows, columns);
+
+  // row i * b.rows() + k of the result is row k of b scaled by every element
+  // of row i of a in turn
+  size_type q = b.columns();
+  detail::parallel_for(
+      rows, rows_grain(columns), [&](std::size_t first, std::size_t last) {
+        for (size_type r = first; r < last; ++r) {
+          const double* a_row = a.row_data(r / b.rows());
+          const double* MATH_RESTRICT b_row = b.row_data(r % b.rows());
+          double* MATH_RESTRICT out = result.row_data(r);
+          for (size_type j = 0; j < a.columns(); ++j, out += q) {
+            double alpha = a_row[j];
+            for (size_type l = 0; l < q; ++l) out[l] = alpha * b_row[l];
+          }
+        }
+      });
+  return result;
+}
+
+vector kron_multiply(const matrix& a, const matrix& b, const vector& x) {
+  size_type m = a.rows(), n = a.columns(), p = b.rows(), q = b.columns();
+  if (x.size() != n * q) {
+    MATH_THROW(std::invalid_argument(
+        "Sizes mismatch: x.size = " + std::to_string(x.size()) +
+        ", expected = " + std::to_string(n * q)));
+  }
+  // a * (X * b^T) or (a * X) * b^T, whichever takes fewer operations
+  double right_first = double(n) * q * p + double(m) * n * p;
+  double left_first = double(m) * n * q + double(m) * q * p;
+  MATH_INSTRUMENT_OP("kron_multiply", 2 * std::min(right_first, left_first),
+                     8.0 * (m * n + p * q + n * q + m * p), m, n, p, q);
+
+  matrix bt = b.transposed();
+  vector result(m * p);
+  if (right_first <= left_first) {
+    detail::buffer<double> t(n * p);
+    detail::product(n, q, p, x.data(), bt.data(), t.data());
+    detail::product(m, n, p, a.data(), t.data(), result.data());
+  } else {
+    detail::buffer<double> s(m * q);
+    detail::product(m, n, q, a.data(), x.data(), s.data());
+    detail::product(m, q, p, s.data(), bt.data(), result.data());
+  }
+  return result;
+}
+
+matrix hadamard_product(const matrix& a, const matrix& b) {
+  MATH_INSTRUMENT_OP("hadamard_product", double(a.rows()) * a.columns(),
+                     24.0 * a.rows() * a.columns(), a.rows(), a.columns());
+  return elementwise(a, b, [](double x, double y) { return x * y; });
+}
+
+matrix hadamard_division(const matrix& a, const matrix& b) {
+  MATH_INSTRUMENT_OP("hadamard_division", double(a.rows()) * a.columns(),
+                     24.0 * a.rows() * a.columns(), a.rows(), a.columns());
+  return elementwise(a, b, [](double x, double y) { return x / y; });
+}
+
+matrix hstack(const std::vector<matrix>& blocks) {
+  return detail::hstack(pointers(blocks).data(), blocks.size());
+}
+
+matrix vstack(const std::vector<matrix>& blocks) {
+  return detail::vstack(pointers(blocks).data(), blocks.size());
+}
+
+matrix block_diag(const std::vector<matrix>& blocks) {
+  return detail::block_diag(pointers(blocks).data(), blocks.size());
+}
+
+namespace detail {
+
+matrix hstack(const matrix* const* blocks, std::size_t count) {
+  check_count(count);
+  size_type rows = blocks[0]->rows(), columns = 0;
+  for (std::size_t b = 0; b < count; ++b) {
+    if (blocks[b]->rows() != rows) {
+      MATH_THROW(std::invalid_argument(
+          "Rows mismatch: rows = " + std::to_string(rows) + ", block " +
+          std::to_string(b) + " rows = " + std::to_string(blocks[b]->rows())));
+    }
+    columns += blocks[b]->columns();
+  }
+  MATH_INSTRUMENT_OP("hstack", 0, 16.0 * rows * columns, rows, columns);
+
+  matrix result(rows, columns);
+  parallel_for(rows, rows_grain(columns),
+               [&](std::size_t first, std::size_t last) {
+                 for (size_type i = first; i < last; ++i) {
+                   double* out = result.row_data(i);
+                   for (std::size_t b = 0; b < count; ++b) {
+                     const double* row = blocks[b]->row_data(i);
+                     out = std::copy(row, row + blocks[b]->columns(), out);
+                   }
+                 }
+               });
+  return result;
+}
+
+matrix vstack(const matrix* const* blocks, std::size_t count) {
+  check_count(count);
+  size_type rows = 0, columns = blocks[0]->columns();
+  for (std::size_t b = 0; b < count; ++b) {
+    if (blocks[b]->columns() != columns) {
+      MATH_THROW(std::invalid_argument(
+          "Columns mismatch: columns = " + std::to_string(columns) +
+          ", block " + std::to_string(b) +
+          " columns = " + std::to_string(blocks[b]->columns())));
+    }
+    rows += blocks[b]->rows();
+  }
+  MATH_INSTRUMENT_OP("vstack", 0, 16.0 * rows * columns, rows, columns);
+
+  // every block is one contiguous range of the result
+  matrix result(rows, columns);
+  double* out = result.data();
+  for (std::size_t b = 0; b < count; ++b) {
+    out = std::copy(blocks[b]->begin(), blocks[b]->end(), out);
+  }
+  return result;
+}
+
+matrix block_diag(const matrix* const* blocks, std::size_t count) {
+  check_count(count);
+  size_type rows = 0, columns = 0;
+  for (std::size_t b = 0; b < count; ++b) {
+    rows += blocks[b]->rows();
+    columns += blocks[b]->columns();
+  }
+  MATH_INSTRUMENT_OP("block_diag", 0, 16.0 * rows * columns, rows, columns);
+
+  matrix result(rows, columns);
+  for (std::size_t b = 0, row = 0, column = 0; b < count; ++b) {
+    result.set_block(row, column, *blocks[b]);
+    row += blocks[b]->rows();
+    column += blocks[b]->columns();
+  }
+  return result;
+}
+
+}  // namespace detail
+
+}  // namespace math
@@ -0,0 +1,93 @@
+#ifndef CPP_MATH_LIBRARY_MATH_STRUCTURED_H_
+#define CPP_MATH_LIBRARY_MATH_STRUCTURED_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "math_matrix.h"
+#include "math_vector.h"
+
+namespace math {
+
+// Structured matrices: Kronecker and elementwise products, block stacking.
+// Results are built with whole-row copies and vectorized loops, large ones
+// by several threads.
+
+// Returns Kronecker product, block (i, j) of the result is a(i, j) * b
+matrix kron(const matrix& a, const matrix& b);
+
+/**
+ * @brief Returns kron(a, b) * x without forming the Kronecker product: x is
+ * taken as row-major a.columns() x b.columns() matrix X and the result is
+ * a * X * b^T read row by row, which takes O(n^3) instead of O(n^4)
+ * operations for n x n a and b. Throws std::invalid_argument if
+ * x.size() != a.columns() * b.columns()
+ *
+ */
+vector kron_multiply(const matrix& a, const matrix& b, const vector& x);
+
+/**
+ * @brief Returns elementwise (Hadamard) product. Throws std::invalid_argument
+ * if sizes of a and b differ
+ *
+ */
+matrix hadamard_product(const matrix& a, const matrix& b);
+
+/**
+ * @brief Returns elementwise quotient a(i, j) / b(i, j). Throws
+ * std::invalid_argument if sizes of a and b differ
+ *
+ */
+matrix hadamard_division(const matrix& a, const matrix& b);
+
+/**
+ * @brief Returns blocks placed side by side. Throws std::invalid_argument if
+ * there are no blocks or their rows differ
+ *
+ */
+matrix hstack(const std::vector<matrix>& blocks);
+
+/**
+ * @brief Returns blocks placed one under another. Throws
+ * std::invalid_argument if there are no blocks or their columns differ
+ *
+ */
+matrix vstack(const std::vector<matrix>& blocks);
+
+/**
+ * @brief Returns block diagonal matrix with blocks on the diagonal and zeroes
+ * elsewhere. Throws std::invalid_argument if there are no blocks
+ *
+ */
+matrix block_diag(const std::vector<matrix>& blocks);
+
+namespace detail {
+
+matrix hstack(const matrix* const* blocks, std::size_t count);
+matrix vstack(const matrix* const* blocks, std::size_t count);
+matrix block_diag(const matrix* const* blocks, std::size_t count);
+
+}  // namespace detail
+
+// Stacks matrices given as arguments without copying them into a vector
+template <class... Matrices>
+matrix hstack(const matrix& first, const Matrices&... rest) {
+  const matrix* blocks[] = {&first, &rest...};
+  return detail::hstack(blocks, 1 + sizeof...(rest));
+}
+
+template <class... Matrices>
+matrix vstack(const matrix& first, const Matrices&... rest) {
+  const matrix* blocks[] = {&first, &rest...};
+  return detail::vstack(blocks, 1 + sizeof...(rest));
+}
+
+template <class... Matrices>
+matrix block_diag(const matrix& first, const Matrices&... rest) {
+  const matrix* blocks[] = {&first, &rest...};
+  return detail::block_diag(blocks, 1 + sizeof...(rest));
+}
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_STRUCTURED_H_
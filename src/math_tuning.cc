@@ -0,0 +1,236 @@
+#include "math_tuning.h"
+
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "math_status.h"
+
+namespace math {
+
+namespace {
+
+// Profile keys with parameters they set
+struct parameter_key {
+  const char* name;
+  std::size_t tuning_parameters::*member;
+};
+
+const parameter_key kKeys[] = {
+    {"gemm_columns", &tuning_parameters::gemm_columns},
+    {"gemm_depth", &tuning_parameters::gemm_depth},
+    {"gemm_rows_grain", &tuning_parameters::gemm_rows_grain},
+    {"transpose_block", &tuning_parameters::transpose_block},
+    {"lu_block", &tuning_parameters::lu_block},
+    {"lu_grain", &tuning_parameters::lu_grain},
+};
+
+constexpr std::size_t kParameters = sizeof(kKeys) / sizeof(kKeys[0]);
+
+std::string trim(const std::string& text) {
+  std::size_t first = 0, last = text.size();
+  while (first < last &&
+         std::isspace(static_cast<unsigned char>(text[first]))) {
+    ++first;
+  }
+  while (last > first &&
+         std::isspace(static_cast<unsigned char>(text[last - 1]))) {
+    --last;
+  }
+  return text.substr(first, last - first);
+}
+
+bool is_section(const std::string& line) {
+  return line.size() >= 2 && line.front() == '[' && line.back() == ']';
+}
+
+// Returns value of a parameter, 0 if text is not a positive integer
+std::size_t parse_value(const std::string& text) {
+  if (text.empty() || text.find_first_not_of("0123456789") != text.npos) {
+    return 0;
+  }
+  return std::size_t(std::strtoull(text.c_str(), nullptr, 10));
+}
+
+/**
+ * @brief Reads parameters of cpu from the profile at path into *parameters.
+ * Returns false if the file or the entry is missing, or if the file is
+ * malformed, then *error describes the problem and *parameters is unchanged
+ *
+ */
+bool parse_profile(const std::string& path, const std::string& cpu,
+                   tuning_parameters* parameters, std::string* error) {
+  std::ifstream in(path);
+  if (!in) return false;
+
+  tuning_parameters result = *parameters;
+  bool found = false, inside = false;
+  std::string line;
+  for (std::size_t number = 1; std::getline(in, line); ++number) {
+    line = trim(line);
+    if (line.empty() || line.front() == '#') continue;
+
+    if (is_section(line)) {
+      inside = trim(line.substr(1, line.size() - 2)) == cpu;
+      found = found || inside;
+      continue;
+    }
+
+    std::size_t equals = line.find('=');
+    if (equals == line.npos) {
+      *error = std::to_string(number) + ": expected key = value";
+      return false;
+    }
+    if (!inside) continue;
+
+    // unknown keys are skipped, they may come from a newer library
+    std::string name = trim(line.substr(0, equals));
+    for (const auto& key : kKeys) {
+      if (name != key.name) continue;
+
+      result.*key.member = parse_value(trim(line.substr(equals + 1)));
+      if (!(result.*key.member)) {
+        *error = std::to_string(number) + ": expected positive integer";
+        return false;
+      }
+    }
+  }
+
+  if (found) *parameters = result;
+  return found;
+}
+
+// Parameters are read by kernels of all threads, every one is atomic so
+// set_tuning() never races with them
+class tuning_state {
+ public:
+  // tuning() is noexcept: defaults stay if the profile is malformed or can
+  // not be read for any reason
+  tuning_state() noexcept {
+    tuning_parameters parameters;
+#if MATH_EXCEPTIONS
+    try {
+#endif
+      std::string path = default_tuning_profile(), error;
+      if (!path.empty()) parse_profile(path, cpu_model(), &parameters, &error);
+#if MATH_EXCEPTIONS
+    } catch (...) {
+      // parse_profile() sets parameters only after reading the whole entry
+    }
+#endif
+    store(parameters);
+  }
+
+  static tuning_state& instance() {
+    static tuning_state state;
+    return state;
+  }
+
+  tuning_parameters load() const noexcept {
+    tuning_parameters parameters;
+    for (std::size_t i = 0; i < kParameters; ++i) {
+      parameters.*kKeys[i].member = values_[i].load(std::memory_order_relaxed);
+    }
+    return parameters;
+  }
+
+  void store(const tuning_parameters& parameters) noexcept {
+    for (std::size_t i = 0; i < kParameters; ++i) {
+      values_[i].store(parameters.*kKeys[i].member, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  std::atomic<std::size_t> values_[kParameters];
+};
+
+}  // namespace
+
+tuning_parameters tuning() noexcept { return tuning_state::instance().load(); }
+
+void set_tuning(const tuning_parameters& parameters) {
+  for (const auto& key : kKeys) {
+    if (!(parameters.*key.member)) {
+      MATH_THROW(std::invalid_argument(std::string("Tuning parameter ") +
+                                       key.name + " is 0"));
+    }
+  }
+  tuning_state::instance().store(parameters);
+}
+
+std::string cpu_model() {
+  std::ifstream in("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(in, line)) {
+    std::size_t colon = line.find(':');
+    if (colon != line.npos && trim(line.substr(0, colon)) == "model name") {
+      std::string model = trim(line.substr(colon + 1));
+      if (!model.empty()) return model;
+    }
+  }
+  return "unknown";
+}
+
+std::string default_tuning_profile() {
+  if (const char* path = std::getenv("MATH_TUNING_PROFILE")) return path;
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.config/cpp_math_library/tuning.profile";
+  }
+  return std::string();
+}
+
+bool read_tuning_profile(const std::string& path, const std::string& cpu,
+                         tuning_parameters* parameters) {
+  std::string error;
+  bool found = parse_profile(path, cpu, parameters, &error);
+  if (!error.empty()) {
+    MATH_THROW(std::runtime_error("Malformed tuning profile " + path + ":" +
+                                  error));
+  }
+  return found;
+}
+
+void write_tuning_profile(const std::string& path, const std::string& cpu,
+                          const tuning_parameters& parameters) {
+  // keep lines of other CPUs as they are
+  std::vector<std::string> kept;
+  {
+    std::ifstream in(path);
+    bool inside = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::string trimmed = trim(line);
+      if (is_section(trimmed)) {
+        inside = trim(trimmed.substr(1, trimmed.size() - 2)) == cpu;
+      }
+      if (!inside) kept.push_back(line);
+    }
+  }
+
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  std::error_code error;
+  if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    MATH_THROW(std::runtime_error("Can not write tuning profile " + path));
+  }
+
+  if (kept.empty()) out << "# cpp-math-library tuning profile\n";
+  for (const auto& line : kept) out << line << '\n';
+  if (!kept.empty() && !trim(kept.back()).empty()) out << '\n';
+
+  out << '[' << cpu << "]\n";
+  for (const auto& key : kKeys) {
+    out << key.name << " = " << parameters.*key.member << '\n';
+  }
+  if (!out) {
+    MATH_THROW(std::runtime_error("Can not write tuning profile " + path));
+  }
+}
+
+}  // namespace math
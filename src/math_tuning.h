@@ -0,0 +1,72 @@
+#ifndef CPP_MATH_LIBRARY_MATH_TUNING_H_
+#define CPP_MATH_LIBRARY_MATH_TUNING_H_
+
+#include <cstddef>
+#include <string>
+
+namespace math {
+
+/**
+ * @brief Blocking parameters and thread thresholds of kernels. Best values
+ * depend on cache sizes, so they are searched by `make tune` and stored in a
+ * profile keyed by CPU model. Defaults suit common desktop and server CPUs.
+ *
+ */
+struct tuning_parameters {
+  std::size_t gemm_columns = 256;     // columns of b panel in matrix product
+  std::size_t gemm_depth = 128;       // rows of b panel in matrix product
+  std::size_t gemm_rows_grain = 32;   // rows of product per thread
+  std::size_t transpose_block = 32;   // side of tiles copied by transposed()
+  std::size_t lu_block = 64;          // columns of LU factorization panels
+  std::size_t lu_grain = 1 << 15;     // elements of LU update per thread
+};
+
+/**
+ * @brief Returns parameters used by kernels. On the first call they are read
+ * from the profile at default_tuning_profile() for cpu_model(); built-in
+ * defaults are used if the profile is missing, malformed or has no entry for
+ * this CPU
+ *
+ */
+tuning_parameters tuning() noexcept;
+
+/**
+ * @brief Replaces parameters used by kernels. Throws std::invalid_argument if
+ * any of them is 0
+ *
+ */
+void set_tuning(const tuning_parameters& parameters);
+
+// Returns CPU model name as reported by the OS, "unknown" if not available
+std::string cpu_model();
+
+/**
+ * @brief Returns path of the profile: MATH_TUNING_PROFILE environment
+ * variable if set, otherwise ~/.config/cpp_math_library/tuning.profile, empty
+ * if HOME is not set either
+ *
+ */
+std::string default_tuning_profile();
+
+/**
+ * @brief Reads parameters of cpu from profile at path into parameters, keys
+ * missing in the profile keep their values. Returns false if the file does not
+ * exist or has no entry for cpu. Throws std::runtime_error if the file is
+ * malformed
+ *
+ */
+bool read_tuning_profile(const std::string& path, const std::string& cpu,
+                         tuning_parameters* parameters);
+
+/**
+ * @brief Writes parameters of cpu into profile at path, keeping entries of
+ * other CPUs and creating missing directories. Throws std::runtime_error if
+ * the file can not be written
+ *
+ */
+void write_tuning_profile(const std::string& path, const std::string& cpu,
+                          const tuning_parameters& parameters);
+
+}  // namespace math
+
+#endif  // CPP_MATH_LIBRARY_MATH_TUNING_H_
@@ -1,8 +1,10 @@
 #include "math_vector.h"
 
 #include <algorithm>
-#include <cmath>
-#include <numeric>
+
+#include "math_instrumentation.h"
+#include "math_norm.h"
+#include "math_status.h"
 
 namespace math {
 
@@ -10,7 +12,7 @@ vector::vector() noexcept : vector(3UL, value_type()) {}
 
 vector::vector(size_type size, value_type value) {
   if (!size) {
-    throw std::invalid_argument("Vector size can not be 0");
+    MATH_THROW(std::invalid_argument("Vector size can not be 0"));
   }
 
   data_ = data_type(size, value);
@@ -24,66 +26,6 @@ vector::vector(value_type x1, value_type x2) noexcept : vector{x1, x2} {}
 vector::vector(value_type x1, value_type x2, value_type x3) noexcept
     : vector{x1, x2, x3} {}
 
-vector::size_type vector::size() const noexcept { return data_.size(); }
-
-vector::reference vector::operator[](size_type pos) noexcept {
-  return data_[pos];
-}
-
-vector::const_reference vector::operator[](size_type pos) const noexcept {
-  return data_[pos];
-}
-
-vector::reference vector::at(size_type pos) {
-  check_size_for_getter(pos);
-  return data_[pos];
-}
-
-vector::const_reference vector::at(size_type pos) const {
-  check_size_for_getter(pos);
-  return data_[pos];
-}
-
-vector::reference vector::operator()(size_type pos) { return at(pos); }
-
-vector::const_reference vector::operator()(size_type pos) const {
-  return at(pos);
-}
-
-vector::iterator vector::begin() noexcept { return data_.begin(); }
-
-vector::const_iterator vector::begin() const noexcept { return data_.begin(); }
-
-vector::iterator vector::end() noexcept { return data_.end(); }
-
-vector::const_iterator vector::end() const noexcept { return data_.end(); }
-
-vector::const_iterator vector::cbegin() const noexcept {
-  return data_.cbegin();
-}
-
-vector::const_iterator vector::cend() const noexcept { return data_.cend(); }
-
-vector::reverse_iterator vector::rbegin() noexcept { return data_.rbegin(); }
-
-vector::reverse_iterator vector::rend() noexcept { return data_.rend(); }
-
-vector::const_reverse_iterator vector::rbegin() const noexcept {
-  return data_.rbegin();
-}
-
-vector::const_reverse_iterator vector::rend() const noexcept {
-  return data_.rend();
-}
-
-vector::const_reverse_iterator vector::crbegin() const noexcept {
-  return data_.crbegin();
-}
-
-vector::const_reverse_iterator vector::crend() const noexcept {
-  return data_.crend();
-}
-
 std::ostream& operator<<(std::ostream& out, const vector& v) {
   out << '[';
   bool comma = false;
@@ -107,12 +49,15 @@ std::istream& operator>>(std::istream& in, vector& v) {
 }
 
 bool operator==(const vector& l, const vector& r) noexcept {
+  MATH_INSTRUMENT_OP("vector::operator==", 0, 16.0 * l.size(), l.size());
   return std::equal(l.begin(), l.end(), r.begin(), r.end());
 }
 
 bool operator!=(const vector& l, const vector& r) noexcept { return !(l == r); }
 
 vector& vector::operator+=(const vector& other) {
+  MATH_INSTRUMENT_OP("vector::operator+=", other.size(), 24.0 * other.size(),
+                     other.size());
   extend(other.size());
   std::transform(begin(), end(), other.begin(), begin(),
                  std::plus<value_type>());
@@ -120,6 +65,8 @@ vector& vector::operator+=(const vector& other) {
 }
 
 vector& vector::operator-=(const vector& other) {
+  MATH_INSTRUMENT_OP("vector::operator-=", other.size(), 24.0 * other.size(),
+                     other.size());
   extend(other.size());
   std::transform(begin(), end(), other.begin(), begin(),
                  std::minus<value_type>());
@@ -127,6 +74,7 @@ vector& vector::operator-=(const vector& other) {
 }
 
 vector& vector::operator*=(const_reference value) noexcept {
+  MATH_INSTRUMENT_OP("vector::operator*=", size(), 16.0 * size(), size());
   std::transform(begin(), end(), begin(),
                  [&value](const_reference v) { return v * value; });
   return *this;
@@ -134,30 +82,36 @@ vector& vector::operator*=(const_reference value) noexcept {
 
 // Divide vector values bu value
 vector& vector::operator/=(const_reference value) noexcept {
+  MATH_INSTRUMENT_OP("vector::operator/=", size(), 16.0 * size(), size());
   std::transform(begin(), end(), begin(),
                  [&value](const_reference v) { return v / value; });
   return *this;
 }
 
 vector operator+(const vector& l, const vector& r) {
+  MATH_INSTRUMENT_OP("vector::operator+", r.size(), 24.0 * r.size(), r.size());
   vector result(l);
   result += r;
   return result;
 }
 
 vector operator-(const vector& l, const vector& r) {
+  MATH_INSTRUMENT_OP("vector::operator-", r.size(), 24.0 * r.size(), r.size());
   vector result(l);
   result -= r;
   return result;
 }
 
 vector operator*(const vector& v, vector::const_reference value) {
+  MATH_INSTRUMENT_OP("vector::operator*(scalar)", v.size(), 16.0 * v.size(),
+                     v.size());
   vector result(v);
   result *= value;
   return result;
 }
 
 vector operator/(const vector& v, vector::const_reference value) {
+  MATH_INSTRUMENT_OP("vector::operator/", v.size(), 16.0 * v.size(), v.size());
   vector result(v);
   result /= value;
   return result;
@@ -169,50 +123,44 @@ vector operator*(vector::const_reference value, const vector& v) {
 
 vector::value_type operator*(const vector& l, const vector& r) {
   l.check_size_for_operation(r);
+  return dot(l, r);
+}
 
-  vector::value_type result = 0;
-  auto i1 = l.begin(), i2 = r.begin();
-  while (i1 != l.end()) {
-    result += *(i1++) * *(i2++);
-  }
-
-  return result;
+expected<vector::value_type> try_dot(const vector& l, const vector& r) {
+  if (l.size() != r.size()) return status::size_mismatch;
+  return dot(l, r);
 }
 
 void vector::resize(size_type new_size, const_reference value) {
-  if (!new_size) throw std::invalid_argument("Vector size can not be 0");
+  MATH_INSTRUMENT_OP("vector::resize", 0, 8.0 * new_size, new_size);
+  if (!new_size) MATH_THROW(std::invalid_argument("Vector size can not be 0"));
   data_.resize(new_size, value);
 }
 
 void vector::extend(size_type new_size, const value_type& value) {
+  MATH_INSTRUMENT_OP("vector::extend", 0, 8.0 * new_size, new_size);
   if (new_size > size()) data_.resize(new_size, value);
 }
 
-vector::value_type vector::abs() const noexcept {
-  value_type result = 0;
-  return sqrt(std::accumulate(
-      begin(), end(), 0,
-      [](const_reference l, const_reference r) { return l + r * r; }));
-}
+vector::value_type vector::abs() const { return norm2(*this); }
 
-void vector::check_size_for_getter(size_type pos) const {
-  if (pos >= size())
-    throw std::out_of_range(std::string("pos >= size, pos = ") +
-                            std::to_string(pos) +
-                            ", size = " + std::to_string(size()));
+void vector::throw_out_of_range(size_type pos) const {
+  MATH_THROW(std::out_of_range(std::string("pos >= size, pos = ") +
+                               std::to_string(pos) +
+                               ", size = " + std::to_string(size())));
 }
 
 void vector::check_size_for_operation(const vector& other) const {
   if (size() != other.size())
-    throw std::invalid_argument(
+    MATH_THROW(std::invalid_argument(
         "size != other.size, size = " + std::to_string(size()) +
-        ", other.size = " + std::to_string(other.size()));
+        ", other.size = " + std::to_string(other.size())));
 }
 
 }  // namespace math
 
 namespace std {
 
-math::vector::value_type abs(const math::vector& v) noexcept { return v.abs(); }
+math::vector::value_type abs(const math::vector& v) { return v.abs(); }
 
 }  // namespace std
@@ -5,6 +5,9 @@
 #include <ostream>
 #include <vector>
 
+#include "math_memory.h"
+#include "math_status.h"
+
 namespace math {
 
 /**
@@ -15,9 +18,11 @@ namespace math {
 class vector {
  public:
   using value_type = double;
-  using data_type = std::vector<value_type>;
+  using data_type = std::vector<value_type, allocator<value_type>>;
   using reference = typename data_type::reference;
   using const_reference = typename data_type::const_reference;
+  using pointer = typename data_type::pointer;
+  using const_pointer = typename data_type::const_pointer;
   using size_type = typename data_type::size_type;
   using iterator = typename data_type::iterator;
   using const_iterator = typename data_type::const_iterator;
@@ -72,7 +77,7 @@ class vector {
   template <class Iterator>
   vector(Iterator first, Iterator last) : data_() {
     if (std::distance(first, last) == 0) {
-      throw std::invalid_argument("Vector size can not be 0");
+      MATH_THROW(std::invalid_argument("Vector size can not be 0"));
     }
 
     data_.assign(first, last);
@@ -128,6 +133,15 @@ class vector {
    */
   const_reference operator()(size_type pos) const;
 
+  // Returns element by position, or status::out_of_range
+  expected<value_type> try_at(size_type pos) const noexcept;
+
+  // Returns pointer to the underlying contiguous storage
+  pointer data() noexcept;
+
+  // Returns read-only pointer to the underlying contiguous storage
+  const_pointer data() const noexcept;
+
   // Returns writable iterator to the beginning of the vector
   iterator begin() noexcept;
 
@@ -209,12 +223,17 @@ class vector {
   friend vector operator*(const_reference value, const vector& v);
 
   /**
-   * @brief Calculates cross product of two vectors. If vectors have different
-   * sizes - throws std::invalid_argument
+   * @brief Calculates dot product of two vectors. If vectors have different
+   * sizes - throws std::invalid_argument. See math::compensated_dot for a more
+   * accurate version
    *
    */
   friend value_type operator*(const vector& l, const vector& r);
 
+  // Dot product without size exceptions, returns status::size_mismatch if
+  // sizes differ. Throws std::bad_alloc if partial sums can not be allocated
+  friend expected<value_type> try_dot(const vector& l, const vector& r);
+
   /**
    * @brief Change size of vector. If new size greater than size - fill with
    * value (defaults to 0), else - discard other values
@@ -232,23 +251,114 @@ class vector {
    */
   void extend(size_type new_size, const value_type& value = value_type());
 
-  // Calculates vector absolute value
-  value_type abs() const noexcept;
+  // Calculates vector absolute value (euclidean norm), see math::norm2
+  value_type abs() const;
 
  private:
   void check_size_for_getter(size_type pos) const;
+  [[noreturn]] void throw_out_of_range(size_type pos) const;
   void check_size_for_operation(const vector& other) const;
 
   data_type data_;
 };
 
+// Element access and other trivial members are defined here to be inlined
+// into loops of callers
+
+inline vector::size_type vector::size() const noexcept { return data_.size(); }
+
+inline vector::reference vector::operator[](size_type pos) noexcept {
+  return data_[pos];
+}
+
+inline vector::const_reference vector::operator[](
+    size_type pos) const noexcept {
+  return data_[pos];
+}
+
+inline vector::reference vector::at(size_type pos) {
+  check_size_for_getter(pos);
+  return data_[pos];
+}
+
+inline vector::const_reference vector::at(size_type pos) const {
+  check_size_for_getter(pos);
+  return data_[pos];
+}
+
+inline vector::reference vector::operator()(size_type pos) { return at(pos); }
+
+inline vector::const_reference vector::operator()(size_type pos) const {
+  return at(pos);
+}
+
+inline vector::pointer vector::data() noexcept { return data_.data(); }
+
+inline vector::const_pointer vector::data() const noexcept {
+  return data_.data();
+}
+
+inline vector::iterator vector::begin() noexcept { return data_.begin(); }
+
+inline vector::const_iterator vector::begin() const noexcept {
+  return data_.begin();
+}
+
+inline vector::iterator vector::end() noexcept { return data_.end(); }
+
+inline vector::const_iterator vector::end() const noexcept {
+  return data_.end();
+}
+
+inline vector::const_iterator vector::cbegin() const noexcept {
+  return data_.cbegin();
+}
+
+inline vector::const_iterator vector::cend() const noexcept {
+  return data_.cend();
+}
+
+inline vector::reverse_iterator vector::rbegin() noexcept {
+  return data_.rbegin();
+}
+
+inline vector::reverse_iterator vector::rend() noexcept {
+  return data_.rend();
+}
+
+inline vector::const_reverse_iterator vector::rbegin() const noexcept {
+  return data_.rbegin();
+}
+
+inline vector::const_reverse_iterator vector::rend() const noexcept {
+  return data_.rend();
+}
+
+inline vector::const_reverse_iterator vector::crbegin() const noexcept {
+  return data_.crbegin();
+}
+
+inline vector::const_reverse_iterator vector::crend() const noexcept {
+  return data_.crend();
+}
+
+inline expected<vector::value_type> vector::try_at(
+    size_type pos) const noexcept {
+  if (pos >= size()) return status::out_of_range;
+  return data_[pos];
+}
+
+inline void vector::check_size_for_getter(size_type pos) const {
+  if (pos >= size()) throw_out_of_range(pos);
+}
+
 }  // namespace math
 
 // overrides of std methods
 
 namespace std {
 
-math::vector::value_type abs(const math::vector& v) noexcept;
+math::vector::value_type abs(const math::vector& v);
 
 }  // namespace std
 
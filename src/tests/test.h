@@ -0,0 +1,91 @@
+#ifndef CPP_MATH_LIBRARY_TESTS_TEST_H_
+#define CPP_MATH_LIBRARY_TESTS_TEST_H_
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../math_matrix.h"
+#include "../math_vector.h"
+
+// Minimal test runner: TEST(name) { ... } registers a test, CHECK macros
+// report failures with their location and let the test continue.
+
+namespace tests {
+
+struct test_case {
+  std::string name;
+  std::function<void()> body;
+};
+
+std::vector<test_case>& registry();
+
+struct registrar {
+  registrar(const char* name, void (*body)());
+};
+
+// Records a failure of the running test
+void fail(const char* file, int line, const std::string& message);
+
+math::vector random_vector(std::size_t n, unsigned seed);
+
+math::matrix random_matrix(std::size_t rows, std::size_t columns,
+                           unsigned seed);
+
+// Diagonally dominant, so it is far from singular
+math::matrix well_conditioned(std::size_t n, unsigned seed);
+
+math::matrix symmetric_positive_definite(std::size_t n, unsigned seed);
+
+// Formats value with all significant digits
+std::string format(double value);
+
+// Returns max |a - b| / max |b|, infinity if sizes differ
+double relative_difference(const math::matrix& a, const math::matrix& b);
+
+}  // namespace tests
+
+#define MATH_TEST_CONCAT2(a, b) a##b
+#define MATH_TEST_CONCAT(a, b) MATH_TEST_CONCAT2(a, b)
+
+#define TEST(name)                                                            \
+  static void name();                                                         \
+  static const ::tests::registrar MATH_TEST_CONCAT(name, _registrar)(         \
+      #name, &name);                                                          \
+  static void name()
+
+#define CHECK(condition)                                                      \
+  do {                                                                        \
+    if (!(condition)) {                                                       \
+      ::tests::fail(__FILE__, __LINE__, "CHECK(" #condition ")");             \
+    }                                                                         \
+  } while (0)
+
+// Checks that actual is within tolerance of expected
+#define CHECK_NEAR(actual, expected, tolerance)                               \
+  do {                                                                        \
+    double check_actual_ = (actual), check_expected_ = (expected);            \
+    if (!(std::fabs(check_actual_ - check_expected_) <= (tolerance))) {       \
+      ::tests::fail(__FILE__, __LINE__,                                       \
+                    #actual " = " + ::tests::format(check_actual_) +          \
+                        ", expected " + ::tests::format(check_expected_));    \
+    }                                                                         \
+  } while (0)
+
+#define CHECK_THROWS(expression, exception)                                   \
+  do {                                                                        \
+    bool check_thrown_ = false;                                               \
+    try {                                                                     \
+      (void)(expression);                                                     \
+    } catch (const exception&) {                                              \
+      check_thrown_ = true;                                                   \
+    }                                                                         \
+    if (!check_thrown_) {                                                     \
+      ::tests::fail(__FILE__, __LINE__,                                       \
+                    #expression " does not throw " #exception);               \
+    }                                                                         \
+  } while (0)
+
+#endif  // CPP_MATH_LIBRARY_TESTS_TEST_H_
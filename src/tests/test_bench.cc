@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../bench/bench.h"
+#include "../math_parallel.h"
+#include "test.h"
+
+namespace {
+
+// Parses arguments given without the program name
+bench::options parse(std::vector<std::string> args) {
+  args.insert(args.begin(), "bench.out");
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(&arg[0]);
+  return bench::parse_options(int(argv.size()), argv.data());
+}
+
+}  // namespace
+
+TEST(result_statistics_use_nearest_rank) {
+  bench::result r;
+  r.samples_ns = {5, 1, 4, 2, 3};
+  r.flops = 6;
+  r.bytes = 12;
+  CHECK(r.median_ns() == 3);
+  CHECK(r.min_ns() == 1);
+  CHECK(r.p99_ns() == 5);
+  CHECK(r.mean_ns() == 3);
+  CHECK(r.gflops() == 2);
+  CHECK(r.gbps() == 4);
+
+  bench::result empty;
+  CHECK(empty.median_ns() == 0);
+  CHECK(empty.gflops() == 0);
+}
+
+TEST(parse_options_reads_sizes_and_rejects_bad_arguments) {
+  bench::options opts = parse({"--min-size", "8", "--max-size", "64"});
+  CHECK((opts.sizes == std::vector<std::size_t>{8, 16, 32, 64}));
+
+  opts = parse({"--filter", "gemm", "--repetitions", "0", "--threshold",
+                "0.1"});
+  CHECK(opts.filter == "gemm");
+  CHECK(opts.repetitions == 1);
+  CHECK(opts.threshold == 0.1);
+
+  CHECK_THROWS(parse({"--unknown"}), std::invalid_argument);
+  CHECK_THROWS(parse({"--warmup"}), std::invalid_argument);
+  CHECK_THROWS(parse({"--warmup", "2x"}), std::invalid_argument);
+  CHECK_THROWS(parse({"--roofline", "--baseline", "a.json"}),
+               std::invalid_argument);
+}
+
+TEST(measure_warms_up_and_batches_operations) {
+  std::size_t calls = 0;
+  bench::benchmark b{"count", [&](std::size_t) {
+                       return bench::workload{[&] { ++calls; }, 1, 8};
+                     }};
+  bench::options opts;
+  opts.warmup = 3;
+  opts.repetitions = 4;
+  opts.min_sample_seconds = 1e-4;
+
+  bench::result r = bench::measure(b, 16, opts);
+  CHECK(r.name == "count");
+  CHECK(r.size == 16);
+  CHECK(r.samples_ns.size() == 4);
+  CHECK(r.batch >= 1);
+  CHECK(calls == opts.warmup + r.batch * opts.repetitions);
+}
+
+TEST(run_skips_larger_sizes_of_slow_benchmarks) {
+  std::vector<bench::benchmark> list{
+      {"slow", [](std::size_t) { return bench::workload{[] {}, 0, 0}; }},
+      {"other", [](std::size_t) { return bench::workload{[] {}, 0, 0}; }}};
+  bench::options opts;
+  opts.sizes = {2, 4, 8};
+  opts.filter = "slow";
+  opts.max_op_seconds = 0;  // every operation is too slow
+
+  std::ostringstream out;
+  auto results = bench::run(list, opts, out);
+  CHECK(results.size() == 3);
+  CHECK(!results[0].skipped && results[0].samples_ns.size() == 1);
+  CHECK(results[1].skipped && results[2].skipped);
+  CHECK(results[1].reason == "smaller size exceeded --max-op-time");
+}
+
+TEST(every_benchmark_runs_at_smallest_size) {
+  std::vector<bench::benchmark> list;
+  bench::register_benchmarks(list);
+  CHECK(!list.empty());
+  for (const auto& b : list) {
+    bench::workload w = b.setup(2);
+    w.op();
+    if (!(w.flops >= 0 && w.bytes >= 0)) {
+      tests::fail(__FILE__, __LINE__, b.name + ": negative work estimate");
+    }
+  }
+}
+
+TEST(parallel_sum_evaluates_one_grain_directly) {
+  std::size_t chunks = 0;
+  auto count = [&](std::size_t first, std::size_t last) {
+    ++chunks;
+    return double(last - first);
+  };
+  CHECK(math::detail::parallel_sum(0, 16, count) == 0);
+  CHECK(chunks == 0);
+  CHECK(math::detail::parallel_sum(16, 16, count) == 16);
+  CHECK(chunks == 1);
+  CHECK(math::detail::parallel_sum(100, 16, count) == 100);
+}
@@ -0,0 +1,53 @@
+#include "../math_blas.h"
+#include "../math_parallel.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::vector;
+
+// a + alpha * x * y^T from copies of x and y
+matrix reference_ger(double alpha, const vector& x, const vector& y,
+                     const matrix& a) {
+  matrix result = a;
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < a.columns(); ++j) {
+      result(i, j) += alpha * x[i] * y[j];
+    }
+  }
+  return result;
+}
+
+vector copy(math::const_vector_view v) {
+  vector result(v.size());
+  for (std::size_t i = 0; i < v.size(); ++i) result[i] = v[i];
+  return result;
+}
+
+}  // namespace
+
+TEST(ger_with_vectors_of_the_updated_matrix) {
+  std::size_t threads = math::num_threads();
+  math::set_num_threads(4);
+  for (std::size_t n : {5, 300}) {
+    matrix a = tests::random_matrix(n, n, unsigned(n));
+    for (std::size_t k : {std::size_t(0), n / 2, n - 1}) {
+      vector row = copy(math::row_view(a, k));
+      vector column = copy(math::column_view(a, k));
+
+      matrix updated = a;
+      math::ger(0.5, math::column_view(updated, k),
+                math::row_view(updated, k), updated);
+      CHECK(tests::relative_difference(
+                updated, reference_ger(0.5, column, row, a)) < 1e-15);
+
+      updated = a;
+      math::ger(-2, math::row_view(updated, k), math::column_view(updated, k),
+                updated);
+      CHECK(tests::relative_difference(
+                updated, reference_ger(-2, row, column, a)) < 1e-15);
+    }
+  }
+  math::set_num_threads(threads);
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "../math_blas.h"
+#include "../math_parallel.h"
+#include "test.h"
+
+namespace {
+
+using math::vector;
+
+// Restores the thread count changed by a test
+struct threads_scope {
+  std::size_t saved = math::num_threads();
+
+  explicit threads_scope(std::size_t threads) {
+    math::set_num_threads(threads);
+  }
+  ~threads_scope() { math::set_num_threads(saved); }
+};
+
+}  // namespace
+
+TEST(axpy_scal_and_rot_match_elementwise_loops) {
+  threads_scope threads(4);
+  for (std::size_t n : {1, 7, 100000}) {
+    vector x = tests::random_vector(n, 1), y = tests::random_vector(n, 2);
+
+    vector expected = y;
+    for (std::size_t i = 0; i < n; ++i) expected[i] += 0.5 * x[i];
+    vector result = y;
+    math::axpy(0.5, x, result);
+    CHECK(result == expected);
+
+    for (std::size_t i = 0; i < n; ++i) expected[i] *= -3;
+    math::scal(-3, result);
+    CHECK(result == expected);
+
+    vector rx = x, ry = y;
+    math::rot(rx, ry, 0.6, 0.8);
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i) {
+      same &= rx[i] == 0.6 * x[i] + 0.8 * y[i];
+      same &= ry[i] == 0.6 * y[i] - 0.8 * x[i];
+    }
+    CHECK(same);
+  }
+}
+
+TEST(dot_nrm2_and_asum_of_strided_views) {
+  // every other element of x is skipped by the view
+  vector x{1, 100, -2, 100, 3, 100};
+  vector y{4, 5, 6};
+  math::const_vector_view strided(x.data(), 3, 2);
+  CHECK(math::dot(strided, y) == 4 - 10 + 18);
+  CHECK(math::asum(strided) == 6);
+  CHECK_NEAR(math::nrm2(strided), std::sqrt(14.0), 1e-15);
+  CHECK_THROWS(math::dot(strided, vector{1, 2}), std::invalid_argument);
+}
+
+TEST(iamax_returns_first_maximum) {
+  CHECK(math::iamax(vector{1, -3, 3, 2}) == 1);
+  CHECK(math::iamax(vector{0, 0, 0}) == 0);
+  CHECK(math::iamax(vector()) == 0);
+
+  threads_scope threads(4);
+  vector long_vector = tests::random_vector(100000, 1);
+  long_vector[77777] = -2;
+  long_vector[88888] = 2;
+  CHECK(math::iamax(long_vector) == 77777);
+
+  // every third element from 1 holds 88888 but not 77777
+  math::const_vector_view strided(long_vector.data() + 1, 33333, 3);
+  CHECK(math::iamax(strided) == (88888 - 1) / 3);
+}
+
+TEST(iamax_returns_first_nan) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  CHECK(math::iamax(vector{1, nan, 3, nan}) == 1);
+  CHECK(math::iamax(vector{nan, 5}) == 0);
+
+  vector x(std::size_t(100), 1.0);
+  x[30] = -HUGE_VAL;
+  x[50] = nan;
+  CHECK(math::iamax(x) == 50);
+}
+
+TEST(fused_dot_matches_separate_dots) {
+  vector x = tests::random_vector(1000, 1);
+  std::vector<vector> ys;
+  for (unsigned k = 0; k < 5; ++k) ys.push_back(tests::random_vector(1000, k));
+  std::vector<math::const_vector_view> views(ys.begin(), ys.end());
+
+  vector fused = math::fused_dot(x, views);
+  for (std::size_t k = 0; k < ys.size(); ++k) {
+    CHECK_NEAR(fused[k], math::dot(x, ys[k]), 1e-13);
+  }
+}
@@ -0,0 +1,91 @@
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../bench/compare.h"
+#include "test.h"
+
+namespace {
+
+// Result with 15 distinct samples around median
+bench::result make_result(const std::string& name, std::size_t size,
+                          double median) {
+  bench::result r;
+  r.name = name;
+  r.size = size;
+  r.batch = 1;
+  for (int i = -7; i <= 7; ++i) r.samples_ns.push_back(median + 0.1 * i);
+  return r;
+}
+
+}  // namespace
+
+TEST(json_results_round_trip) {
+  std::vector<bench::result> results{make_result("a/b", 8, 100)};
+  results[0].flops = 3;
+  results[0].bytes = 4;
+  bench::result skipped;
+  skipped.name = "a/b";
+  skipped.size = 16;
+  skipped.skipped = true;
+  skipped.reason = "out of memory";
+  results.push_back(skipped);
+
+  std::stringstream json;
+  bench::write_json(json, results, bench::options());
+  auto read = bench::read_json(json);
+
+  CHECK(read.size() == 2);
+  if (read.size() != 2) return;
+  CHECK(read[0].name == "a/b" && read[0].size == 8 && read[0].batch == 1);
+  CHECK(read[0].flops == 3 && read[0].bytes == 4);
+  CHECK(read[0].samples_ns == results[0].samples_ns);
+  CHECK(read[1].skipped && read[1].samples_ns.empty());
+
+  std::istringstream malformed("{\"benchmarks\": [");
+  CHECK_THROWS(bench::read_json(malformed), std::runtime_error);
+  std::istringstream no_array("{\"benchmarks\": 1}");
+  CHECK_THROWS(bench::read_json(no_array), std::runtime_error);
+}
+
+TEST(mann_whitney_p_values) {
+  // exact distribution of U for 3 and 3 samples: P(U = 0) = 1 / 20,
+  // P(U <= 3) = 7 / 20
+  CHECK_NEAR(bench::mann_whitney_p({1, 2, 3}, {4, 5, 6}), 0.1, 1e-12);
+  CHECK_NEAR(bench::mann_whitney_p({1, 3, 5}, {2, 4, 6}), 0.7, 1e-12);
+  CHECK(bench::mann_whitney_p({}, {1}) == 1);
+
+  // normal approximation for large and tied samples
+  std::vector<double> x, y;
+  for (int i = 0; i < 40; ++i) {
+    x.push_back(i / 2);
+    y.push_back(100 + i / 2);
+  }
+  CHECK(bench::mann_whitney_p(x, y) < 1e-9);
+  CHECK(bench::mann_whitney_p(x, x) == 1);
+}
+
+TEST(compare_needs_both_threshold_and_significance) {
+  std::vector<bench::result> baseline{
+      make_result("slower", 8, 100), make_result("faster", 8, 100),
+      make_result("noise", 8, 100), make_result("removed", 8, 100)};
+  std::vector<bench::result> current{
+      make_result("slower", 8, 150), make_result("faster", 8, 50),
+      make_result("noise", 8, 101), make_result("slower", 16, 100)};
+  bench::options opts;
+
+  auto comparisons = bench::compare(baseline, current, opts);
+  CHECK(comparisons.size() == 3);
+  if (comparisons.size() != 3) return;
+  CHECK(comparisons[0].status == bench::verdict::regression);
+  CHECK_NEAR(comparisons[0].change, 0.5, 1e-12);
+  CHECK(comparisons[1].status == bench::verdict::improvement);
+  // significant, but within the 5% threshold
+  CHECK(comparisons[2].p_value < opts.alpha);
+  CHECK(comparisons[2].status == bench::verdict::same);
+
+  std::ostringstream out;
+  CHECK(bench::print_comparison(out, comparisons, opts) == 1);
+}
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../math_cross_check.h"
+#include "../math_factorization.h"
+#include "../math_norm.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+// Collects mismatches while alive, checks every call of optimized kernels
+class recorded_mismatches {
+ public:
+  recorded_mismatches() {
+    math::set_cross_check(1);
+    math::set_cross_check_handler(
+        [this](const math::cross_check_mismatch& m) { list.push_back(m); });
+  }
+  ~recorded_mismatches() {
+    math::set_cross_check(0);
+    math::set_cross_check_handler(nullptr);
+  }
+
+  std::vector<math::cross_check_mismatch> list;
+};
+
+}  // namespace
+
+TEST(cross_check_rejects_bad_settings) {
+  CHECK_THROWS(math::set_cross_check(-0.1), std::invalid_argument);
+  CHECK_THROWS(math::set_cross_check(1.5), std::invalid_argument);
+  CHECK_THROWS(math::set_cross_check(0.5, -1), std::invalid_argument);
+  CHECK_THROWS(math::set_cross_check(std::nan("")), std::invalid_argument);
+  CHECK(math::cross_check_fraction() == 0);
+  CHECK(!math::detail::cross_check_sampled());
+}
+
+TEST(optimized_kernels_agree_with_references) {
+  recorded_mismatches mismatches;
+  std::uint64_t before = math::cross_check_mismatches();
+
+  matrix a = tests::random_matrix(37, 53, 1);
+  matrix b = tests::random_matrix(53, 29, 2);
+  matrix c = a * b;
+  matrix t = a.transposed();
+  math::lu_factorization lu(tests::well_conditioned(40, 3));
+  math::vector x = tests::random_vector(5000, 4);
+  double norms = math::norm1(x) + math::norm2(x) + math::norm_inf(x) +
+                 math::norm(x, 3) + math::norm1(a) + math::norm_inf(a);
+
+  CHECK(norms > 0);
+  CHECK(mismatches.list.empty());
+  CHECK(math::cross_check_mismatches() == before);
+}
+
+TEST(cross_check_reports_worst_element) {
+  recorded_mismatches mismatches;
+  std::uint64_t before = math::cross_check_mismatches();
+
+  matrix a = tests::random_matrix(3, 4, 1);
+  matrix b = tests::random_matrix(4, 2, 2);
+  matrix product = a * b;
+  product(1, 1) += 1e-3;
+  product(2, 0) += 1e-14;  // within the tolerance on its own
+  math::detail::check_product(a, b, product);
+
+  CHECK(mismatches.list.size() == 1);
+  CHECK(math::cross_check_mismatches() == before + 1);
+  if (mismatches.list.size() != 1) return;
+  const math::cross_check_mismatch& m = mismatches.list[0];
+  CHECK(m.operation == "matrix::operator*=(matrix)");
+  CHECK(m.index == 3);
+  CHECK(m.actual - m.expected > 0.9e-3);
+  CHECK(m.ulps > math::kCrossCheckUlps);
+  CHECK(m.inputs.size() == 2 && m.inputs[0] == a && m.inputs[1] == b);
+}
+
+TEST(cross_check_reports_norms_and_pivots) {
+  recorded_mismatches mismatches;
+
+  math::vector x = tests::random_vector(100, 1);
+  math::detail::check_norm("norm2", x, 2, math::norm2(x) * (1 + 1e-12));
+  CHECK(mismatches.list.size() == 1);
+
+  // swapped pivots make the factors incomparable
+  matrix a = tests::well_conditioned(4, 2);
+  math::lu_factorization lu(a);
+  std::vector<std::size_t> rows{1, 0, 2, 3};
+  math::detail::check_lu(a, lu.packed(), rows);
+  CHECK(mismatches.list.size() == 2);
+  if (mismatches.list.size() == 2) {
+    CHECK(std::isinf(mismatches.list[1].ulps));
+  }
+}
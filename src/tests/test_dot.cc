@@ -0,0 +1,46 @@
+#include <cmath>
+
+#include "../math_blas.h"
+#include "test.h"
+
+namespace {
+
+using math::vector;
+
+}  // namespace
+
+TEST(dot_matches_naive_sum_for_every_tail_length) {
+  for (std::size_t n = 1; n <= 40; ++n) {
+    vector x = tests::random_vector(n, 1), y = tests::random_vector(n, 2);
+    double expected = 0;
+    for (std::size_t i = 0; i < n; ++i) expected += x[i] * y[i];
+    CHECK_NEAR(math::dot(x, y), expected, 1e-14);
+    CHECK_NEAR(x * y, expected, 1e-14);
+  }
+}
+
+TEST(compensated_dot_keeps_digits_plain_dot_loses) {
+  // blocks of 8 put every value into every accumulator lane in the same
+  // order: each lane adds 1 to 1e16, where the spacing of doubles is 2
+  vector x(std::size_t(24)), y(std::size_t(24));
+  for (std::size_t i = 0; i < 8; ++i) {
+    x[i] = 1e16;
+    x[8 + i] = 1;
+    x[16 + i] = -1e16;
+  }
+  for (std::size_t i = 0; i < 24; ++i) y[i] = 1;
+  CHECK(math::dot(x, y) == 0);
+  CHECK(math::compensated_dot(x, y) == 8);
+
+  // products round too: (1 + 2^-30) (1 - 2^-30) = 1 - 2^-60 is stored as 1
+  double eps = std::ldexp(1.0, -30);
+  for (std::size_t i = 0; i < 8; ++i) {
+    x[i] = 1 + eps;
+    y[i] = 1 - eps;
+    x[8 + i] = -1;
+    y[8 + i] = 1;
+    x[16 + i] = y[16 + i] = 0;
+  }
+  CHECK(math::dot(x, y) == 0);
+  CHECK(math::compensated_dot(x, y) == -std::ldexp(1.0, -57));
+}
@@ -0,0 +1,54 @@
+#include <cstddef>
+#include <stdexcept>
+
+#include "../math_matrix.h"
+#include "../math_vector.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::vector;
+
+}  // namespace
+
+TEST(unchecked_matrix_access_matches_checked_access) {
+  matrix m = tests::random_matrix(5, 7, 1);
+  const matrix& view = m;
+  for (std::size_t i = 0; i < m.rows(); ++i) {
+    const double* row = view.row_data(i);
+    for (std::size_t j = 0; j < m.columns(); ++j) {
+      CHECK(&m.unchecked(i, j) == &m(i, j));
+      CHECK(view.unchecked(i, j) == view(i, j));
+      CHECK(row[j] == m(i, j));
+    }
+  }
+
+  m.unchecked(2, 3) = 42;
+  m.row_data(4)[6] = -1;
+  CHECK(m(2, 3) == 42);
+  CHECK(m(4, 6) == -1);
+  CHECK(m.row_data(1) == m.data() + 7);
+}
+
+TEST(checked_matrix_access_rejects_every_out_of_range_index) {
+  matrix m = tests::random_matrix(3, 4, 1);
+  const matrix& view = m;
+  CHECK_THROWS(m(3, 0), std::out_of_range);
+  CHECK_THROWS(m(0, 4), std::out_of_range);
+  CHECK_THROWS(view(3, 4), std::out_of_range);
+}
+
+TEST(vector_subscript_matches_at) {
+  vector v = tests::random_vector(9, 1);
+  const vector& view = v;
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    CHECK(&v[i] == &v.at(i));
+    CHECK(&v(i) == &v.at(i));
+    CHECK(view[i] == view.at(i));
+  }
+  CHECK(v.data() + v.size() == &*(v.end() - 1) + 1);
+
+  CHECK_THROWS(v.at(9), std::out_of_range);
+  CHECK_THROWS(view(9), std::out_of_range);
+}
@@ -0,0 +1,105 @@
+#include <stdexcept>
+
+#include "../math_blas.h"
+#include "../math_factorization.h"
+#include "../math_inverse_update.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::vector;
+
+// Returns p^T * l * u from packed factors
+matrix reconstruct(const math::lu_factorization& lu) {
+  std::size_t n = lu.size();
+  matrix l(n), u(n, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      (j < i ? l(i, j) : u(i, j)) = lu.packed()(i, j);
+    }
+  }
+
+  matrix product = l * u, result(n, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      result(lu.permutation()[i], j) = product(i, j);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(lu_update_matches_fresh_factorization) {
+  matrix a = tests::well_conditioned(20, 1);
+  vector u = tests::random_vector(20, 2), v = tests::random_vector(20, 3);
+  math::lu_factorization lu(a);
+  lu.update(u, v);
+
+  math::ger(1, u, v, a);
+  math::lu_factorization fresh(a);
+  CHECK(tests::relative_difference(reconstruct(lu), a) < 1e-13);
+  vector b = tests::random_vector(20, 4);
+  CHECK(tests::relative_difference(matrix(lu.solve(b)),
+                                   matrix(fresh.solve(b))) < 1e-12);
+  CHECK_NEAR(lu.determinant(), fresh.determinant(),
+             1e-12 * std::fabs(fresh.determinant()));
+}
+
+TEST(lu_rank_k_update_matches_fresh_factorization) {
+  matrix a = tests::well_conditioned(16, 5);
+  matrix u = tests::random_matrix(16, 3, 6), v = tests::random_matrix(16, 3, 7);
+  math::lu_factorization lu(a);
+  lu.update(u, v);
+
+  math::rank_k_update(1, u, v, a);
+  CHECK(tests::relative_difference(reconstruct(lu), a) < 1e-13);
+}
+
+TEST(cholesky_update_and_downdate_match_fresh_factorization) {
+  matrix a = tests::symmetric_positive_definite(12, 8);
+  vector x = tests::random_vector(12, 9);
+  math::cholesky_factorization cholesky(a);
+
+  cholesky.update(x);
+  matrix updated = a;
+  math::ger(1, x, x, updated);
+  CHECK(tests::relative_difference(
+            cholesky.upper(),
+            math::cholesky_factorization(updated).upper()) < 1e-13);
+
+  cholesky.downdate(x);
+  CHECK(tests::relative_difference(
+            cholesky.upper(), math::cholesky_factorization(a).upper()) < 1e-13);
+}
+
+TEST(cholesky_failed_downdate_rolls_back) {
+  matrix a = tests::symmetric_positive_definite(8, 10);
+  math::cholesky_factorization cholesky(a);
+  matrix before = cholesky.upper();
+
+  // a - x x^T is indefinite when x is large enough
+  vector x = tests::random_vector(8, 11) * 100.0;
+  CHECK_THROWS(cholesky.downdate(x), std::logic_error);
+  CHECK(cholesky.upper() == before);
+}
+
+TEST(updatable_inverse_matches_fresh_inverse) {
+  matrix a = tests::well_conditioned(10, 12);
+  vector u = tests::random_vector(10, 13), v = tests::random_vector(10, 14);
+  math::updatable_inverse inverse(a);
+  inverse.update(u, v);
+
+  math::ger(1, u, v, a);
+  CHECK(tests::relative_difference(inverse.inverse(),
+                                   math::lu_factorization(a).inverse()) <
+        1e-12);
+}
+
+TEST(drift_monitor_refactorizes_when_tolerance_exceeded) {
+  matrix a = tests::well_conditioned(10, 15);
+  math::lu_factorization lu(a, 1e-300);
+  lu.update(tests::random_vector(10, 16), tests::random_vector(10, 17));
+  CHECK(lu.refactorizations() == 1);
+}
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include "../math_fixed.h"
+#include "test.h"
+
+// The static_asserts are evaluated by the compiler. make NO_EXCEPTIONS=1
+// test-constexpr compiles them without exceptions too, where MATH_THROW calls
+// math::detail::fail in the same constexpr functions.
+
+namespace {
+
+using math::fixed_lu;
+using math::fixed_matrix;
+using math::fixed_vector;
+
+constexpr bool near(double a, double b) noexcept {
+  return math::detail::fixed_abs(a - b) <= 1e-12;
+}
+
+template <std::size_t Rows, std::size_t Columns>
+constexpr bool near(const fixed_matrix<Rows, Columns>& a,
+                    const fixed_matrix<Rows, Columns>& b) noexcept {
+  for (std::size_t i = 0; i < Rows * Columns; ++i) {
+    if (!near(a.data()[i], b.data()[i])) return false;
+  }
+  return true;
+}
+
+template <std::size_t N>
+constexpr bool near(const fixed_vector<N>& a,
+                    const fixed_vector<N>& b) noexcept {
+  for (std::size_t i = 0; i < N; ++i) {
+    if (!near(a[i], b[i])) return false;
+  }
+  return true;
+}
+
+constexpr fixed_matrix<2, 2> kRotation{{0, -1}, {1, 0}};
+
+static_assert(kRotation.determinant() == 1);
+static_assert(kRotation.inverse() == fixed_matrix<2, 2>{{0, 1}, {-1, 0}});
+static_assert(kRotation * kRotation == -1.0 * fixed_matrix<2, 2>::identity());
+static_assert(kRotation * fixed_vector<2>{1, 2} == fixed_vector<2>{-2, 1});
+
+// the first pivot is zero, so elimination has to swap rows
+constexpr fixed_matrix<3, 3> kPivoting{{0, 2, 1}, {1, 1, 0}, {2, 0, 3}};
+
+static_assert(near(kPivoting.determinant(), -8));
+static_assert(near(kPivoting * kPivoting.inverse(),
+                   fixed_matrix<3, 3>::identity()));
+static_assert(near(kPivoting.inverse() * kPivoting,
+                   fixed_matrix<3, 3>::identity()));
+static_assert(near(math::lu_solve(kPivoting, fixed_vector<3>{7, 3, 11}),
+                   fixed_vector<3>{1, 2, 3}));
+static_assert(near(fixed_lu<3>(kPivoting).solve(kPivoting),
+                   fixed_matrix<3, 3>::identity()));
+
+// non-square products and transposition
+constexpr fixed_matrix<2, 3> kWide{{1, 2, 3}, {4, 5, 6}};
+
+static_assert(kWide * kWide.transposed() ==
+              fixed_matrix<2, 2>{{14, 32}, {32, 77}});
+static_assert(kWide.transposed() * fixed_vector<2>{1, 1} ==
+              fixed_vector<3>{5, 7, 9});
+static_assert(kWide(1, 2) == 6);
+static_assert(fixed_vector<3>{1, 2, 3} * fixed_vector<3>{4, 5, 6} == 32);
+
+constexpr fixed_matrix<2, 2> kSingular{{1, 2}, {2, 4}};
+
+static_assert(fixed_lu<2>(kSingular).singular());
+static_assert(kSingular.determinant() == 0);
+
+}  // namespace
+
+#if MATH_EXCEPTIONS
+
+TEST(fixed_matrix_errors_throw_at_run_time) {
+  fixed_matrix<2, 2> singular = kSingular;
+  CHECK_THROWS(singular.inverse(), std::logic_error);
+  CHECK_THROWS(math::lu_solve(singular, fixed_vector<2>{1, 1}),
+               std::logic_error);
+  CHECK_THROWS(singular(2, 0), std::out_of_range);
+  CHECK_THROWS((fixed_matrix<2, 2>{{1, 2}}), std::invalid_argument);
+  CHECK_THROWS((fixed_vector<2>{1, 2, 3}), std::invalid_argument);
+  math::matrix wide(std::size_t(2), std::size_t(3));
+  CHECK_THROWS((fixed_matrix<2, 2>(wide)), std::invalid_argument);
+}
+
+TEST(fixed_matrix_matches_matrix) {
+  math::matrix m = tests::random_matrix(4, 4, 1);
+  fixed_matrix<4, 4> fixed(m);
+  CHECK(fixed.to_matrix() == m);
+  CHECK(tests::relative_difference(fixed.inverse().to_matrix(), m.inverse()) <
+        1e-12);
+  CHECK_NEAR(fixed.determinant(), m.determinant(),
+             1e-12 * std::fabs(m.determinant()));
+}
+
+#endif  // MATH_EXCEPTIONS
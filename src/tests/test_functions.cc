@@ -0,0 +1,88 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "../math_functions.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+matrix repeated_product(const matrix& m, std::size_t k) {
+  matrix result(m.rows(), 1.0);
+  for (std::size_t i = 0; i < k; ++i) result *= m;
+  return result;
+}
+
+}  // namespace
+
+TEST(pow_matches_repeated_product) {
+  for (std::size_t n : {1, 3, 17}) {
+    matrix m = tests::random_matrix(n, n, unsigned(n)) * 0.5;
+    for (std::size_t k : {0, 1, 2, 5, 8, 13}) {
+      CHECK(tests::relative_difference(math::pow(m, k),
+                                       repeated_product(m, k)) < 1e-13);
+    }
+  }
+}
+
+TEST(pow_rejects_rectangular_matrix) {
+  CHECK_THROWS(math::pow(matrix(std::size_t(2), std::size_t(3)), 2),
+               std::logic_error);
+}
+
+TEST(expm_of_rotation_generator) {
+  // every Pade degree and scaling: e^[0 -t; t 0] is rotation by t
+  for (double t : {1e-3, 0.1, 0.5, 1.0, 2.0, 10.0, 100.0}) {
+    matrix e = math::expm(matrix{{0, -t}, {t, 0}});
+    matrix expected{{std::cos(t), -std::sin(t)}, {std::sin(t), std::cos(t)}};
+    CHECK(tests::relative_difference(e, expected) < 1e-13 * (1 + t));
+  }
+}
+
+TEST(expm_of_nilpotent_matrix) {
+  // n^3 = 0, so e^n = i + n + n^2 / 2
+  matrix n{{0, 1, 2}, {0, 0, 3}, {0, 0, 0}};
+  matrix expected{{1, 1, 3.5}, {0, 1, 3}, {0, 0, 1}};
+  CHECK(tests::relative_difference(math::expm(n), expected) < 1e-15);
+}
+
+TEST(expm_of_symmetric_matrix) {
+  // [a b; b a] has eigenvectors [1 1] and [1 -1] with eigenvalues a +- b
+  double a = 1.5, b = -4;
+  matrix e = math::expm(matrix{{a, b}, {b, a}});
+  double plus = std::exp(a + b), minus = std::exp(a - b);
+  matrix expected{{(plus + minus) / 2, (plus - minus) / 2},
+                  {(plus - minus) / 2, (plus + minus) / 2}};
+  CHECK(tests::relative_difference(e, expected) < 1e-14);
+
+  // larger one: e^s and e^-s share eigenvectors and are inverses
+  matrix s = tests::symmetric_positive_definite(30, 1) * 0.05;
+  matrix product = math::expm(s) * math::expm(s * -1.0);
+  CHECK(tests::relative_difference(product, matrix(std::size_t(30))) < 1e-12);
+
+  matrix e30 = math::expm(s);
+  CHECK(e30 == e30.transposed());
+}
+
+TEST(expm_rejects_non_finite_elements) {
+  double inf = HUGE_VAL, nan = std::nan("");
+  CHECK_THROWS(math::expm(matrix{{0, 1}, {inf, 0}}), std::invalid_argument);
+  CHECK_THROWS(math::expm(matrix{{nan, 1}, {2, 0}}), std::invalid_argument);
+  CHECK_THROWS(math::expm(matrix{{-inf, 0}, {0, 0}}), std::invalid_argument);
+}
+
+TEST(expm_of_diagonal_matrix) {
+  matrix e = math::expm(matrix{{1, 0}, {0, -2}});
+  CHECK(e(0, 0) == std::exp(1.0));
+  CHECK(e(1, 1) == std::exp(-2.0));
+  CHECK(e(0, 1) == 0 && e(1, 0) == 0);
+}
+
+TEST(expm_of_general_matrix_inverts_with_negation) {
+  for (double scale : {0.01, 0.1, 0.3, 1.0}) {
+    matrix m = tests::random_matrix(12, 12, 2) * scale;
+    matrix product = math::expm(m) * math::expm(m * -1.0);
+    CHECK(tests::relative_difference(product, matrix(std::size_t(12))) < 1e-11);
+  }
+}
@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <vector>
+
+#include "../math_kernels.h"
+#include "../math_tuning.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+// Textbook i-j-k product
+matrix naive_product(const matrix& a, const matrix& b) {
+  matrix result(a.rows(), b.columns());
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < b.columns(); ++j) {
+      double sum = 0;
+      for (std::size_t p = 0; p < a.columns(); ++p) sum += a(i, p) * b(p, j);
+      result(i, j) = sum;
+    }
+  }
+  return result;
+}
+
+struct shape {
+  std::size_t m, k, n;
+};
+
+// Row counts that are not multiples of 4, non-square shapes, and panels
+// wider than 256 columns or deeper than 128 rows of the default blocking
+const shape kShapes[] = {{1, 1, 1},     {3, 5, 7},     {5, 5, 5},
+                         {7, 13, 2},    {2, 9, 31},    {17, 1, 19},
+                         {33, 130, 9},  {6, 300, 261}, {41, 129, 257},
+                         {64, 64, 64},  {65, 17, 3}};
+
+void check_shapes() {
+  unsigned seed = 0;
+  for (const shape& s : kShapes) {
+    matrix a = tests::random_matrix(s.m, s.k, ++seed);
+    matrix b = tests::random_matrix(s.k, s.n, ++seed);
+    matrix expected = naive_product(a, b);
+    matrix c = a * b;
+    CHECK(c.rows() == s.m && c.columns() == s.n);
+    CHECK(tests::relative_difference(c, expected) < 1e-14);
+  }
+}
+
+}  // namespace
+
+TEST(product_matches_naive_product) { check_shapes(); }
+
+TEST(product_does_not_depend_on_blocking) {
+  math::tuning_parameters saved = math::tuning();
+  math::tuning_parameters small = saved;
+  small.gemm_columns = 3;
+  small.gemm_depth = 5;
+  small.gemm_rows_grain = 2;
+  math::set_tuning(small);
+  check_shapes();
+  math::set_tuning(saved);
+}
+
+TEST(gemm_kernel_accumulates_into_strided_block) {
+  // 6 x 9 by 9 x 5 product inside larger buffers with padded rows
+  std::size_t m = 6, k = 9, n = 5, lda = 12, ldb = 7, ldc = 8;
+  matrix a = tests::random_matrix(m, lda, 1);
+  matrix b = tests::random_matrix(k, ldb, 2);
+  matrix c = tests::random_matrix(m + 1, ldc, 3);
+  matrix before = c;
+
+  math::detail::gemm_kernel(m, n, k, a.data(), lda, b.data(), ldb, c.data(),
+                            ldc);
+
+  for (std::size_t i = 0; i <= m; ++i) {
+    for (std::size_t j = 0; j < ldc; ++j) {
+      double expected = before(i, j);
+      if (i < m && j < n) {
+        for (std::size_t p = 0; p < k; ++p) expected += a(i, p) * b(p, j);
+      }
+      CHECK_NEAR(c(i, j), expected, 1e-13);
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#include <future>
+#include <thread>
+
+#include "../math_latency.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+}  // namespace
+
+TEST(latency_is_recorded_only_while_on) {
+  matrix a = tests::random_matrix(4, 4, 1);
+  math::latency::reset();
+  matrix b = a * a;
+  CHECK(math::latency::snapshot().count("matrix::operator*(matrix)") == 0);
+
+  math::latency::set_recording(true);
+  b = a * a;
+  b = a * a;
+  math::latency::set_recording(false);
+  b = a * a;
+
+  auto stats = math::latency::snapshot();
+  CHECK(stats.count("matrix::operator*(matrix)") == 1);
+  CHECK(stats["matrix::operator*(matrix)"].count() == 2);
+  math::latency::reset();
+}
+
+TEST(reset_clears_histograms_of_running_threads) {
+  const char* op = "matrix::operator*(matrix)";
+  matrix a = tests::random_matrix(4, 4, 1);
+  math::latency::reset();
+  math::latency::set_recording(true);
+
+  std::promise<void> recorded, reset_done, recorded_again;
+  std::thread worker([&] {
+    matrix b = a * a;
+    b = a * a;
+    recorded.set_value();
+    reset_done.get_future().wait();
+    b = a * a;
+    recorded_again.set_value();
+  });
+
+  recorded.get_future().wait();
+  CHECK(math::latency::snapshot()[op].count() == 2);
+  math::latency::reset();
+  // the worker has not cleared its histograms yet, they are stale
+  CHECK(math::latency::snapshot().count(op) == 0);
+
+  reset_done.set_value();
+  recorded_again.get_future().wait();
+  CHECK(math::latency::snapshot()[op].count() == 1);
+  worker.join();
+  CHECK(math::latency::snapshot()[op].count() == 1);  // kept after exit
+
+  math::latency::set_recording(false);
+  math::latency::reset();
+}
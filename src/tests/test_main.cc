@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "test.h"
+
+namespace tests {
+
+namespace {
+
+int failures = 0;
+
+}  // namespace
+
+std::vector<test_case>& registry() {
+  static std::vector<test_case> cases;
+  return cases;
+}
+
+registrar::registrar(const char* name, void (*body)()) {
+  registry().push_back({name, body});
+}
+
+void fail(const char* file, int line, const std::string& message) {
+  ++failures;
+  std::cerr << file << ':' << line << ": " << message << std::endl;
+}
+
+math::vector random_vector(std::size_t n, unsigned seed) {
+  std::mt19937_64 generator(seed);
+  std::uniform_real_distribution<double> distribution(-1, 1);
+
+  math::vector result(n);
+  for (auto& el : result) el = distribution(generator);
+  return result;
+}
+
+math::matrix random_matrix(std::size_t rows, std::size_t columns,
+                           unsigned seed) {
+  std::mt19937_64 generator(seed);
+  std::uniform_real_distribution<double> distribution(-1, 1);
+
+  math::matrix result(rows, columns);
+  for (auto& el : result) el = distribution(generator);
+  return result;
+}
+
+math::matrix well_conditioned(std::size_t n, unsigned seed) {
+  math::matrix result = random_matrix(n, n, seed);
+  for (std::size_t i = 0; i < n; ++i) result(i, i) += double(n);
+  return result;
+}
+
+math::matrix symmetric_positive_definite(std::size_t n, unsigned seed) {
+  math::matrix result = well_conditioned(n, seed);
+  return result + result.transposed();
+}
+
+std::string format(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+double relative_difference(const math::matrix& a, const math::matrix& b) {
+  if (a.rows() != b.rows() || a.columns() != b.columns()) return HUGE_VAL;
+
+  double difference = 0, scale = 0;
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < a.columns(); ++j) {
+      difference = std::max(difference, std::fabs(a(i, j) - b(i, j)));
+      scale = std::max(scale, std::fabs(b(i, j)));
+    }
+  }
+  return scale ? difference / scale : difference;
+}
+
+}  // namespace tests
+
+// Runs all tests, or those whose names contain the argument
+int main(int argc, char** argv) {
+  std::string filter = argc > 1 ? argv[1] : "";
+  int count = 0;
+  for (const tests::test_case& test : tests::registry()) {
+    if (test.name.find(filter) == std::string::npos) continue;
+
+    int before = tests::failures;
+    try {
+      test.body();
+    } catch (const std::exception& e) {
+      tests::fail(test.name.c_str(), 0,
+                  std::string("unexpected exception: ") + e.what());
+    }
+    std::cout << (tests::failures == before ? "[ OK ] " : "[FAIL] ")
+              << test.name << std::endl;
+    ++count;
+  }
+
+  std::cout << count << " tests, " << tests::failures << " failed checks"
+            << std::endl;
+  return tests::failures ? 1 : 0;
+}
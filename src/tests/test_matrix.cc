@@ -0,0 +1,98 @@
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "../math_memory.h"
+#include "../math_status.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::status;
+using math::vector;
+
+// Library storage of the calling scope is limited to bytes
+class budget_scope {
+ public:
+  explicit budget_scope(std::size_t bytes) : saved_(math::memory_budget()) {
+    math::set_memory_budget(math::memory_usage().current_bytes + bytes);
+  }
+  ~budget_scope() { math::set_memory_budget(saved_); }
+
+ private:
+  std::size_t saved_;
+};
+
+// try_ versions without allocations and comparisons can not throw, even with
+// MATH_INSTRUMENTATION registering their counters
+static_assert(noexcept(std::declval<matrix&>().try_add(
+    std::declval<const matrix&>())));
+static_assert(noexcept(std::declval<matrix&>().try_subtract(
+    std::declval<const matrix&>())));
+static_assert(noexcept(std::declval<const matrix&>().try_at(0, 0)));
+static_assert(noexcept(std::declval<const vector&>().try_at(0)));
+static_assert(noexcept(std::declval<const matrix&>() ==
+                       std::declval<const matrix&>()));
+
+}  // namespace
+
+TEST(arithmetic_rejects_size_mismatch) {
+  matrix m{{1, 2}, {3, 4}};
+  matrix column{{1}, {2}};
+  CHECK_THROWS(m += column, std::invalid_argument);
+  CHECK_THROWS(m -= column, std::invalid_argument);
+  CHECK_THROWS(column *= m, std::invalid_argument);
+  CHECK(m == (matrix{{1, 2}, {3, 4}}));
+  m *= column;
+  CHECK(m == (matrix{{5}, {11}}));
+}
+
+TEST(try_versions_report_status_and_keep_operands) {
+  matrix m{{1, 2}, {3, 4}};
+  matrix column{{1}, {2}};
+  CHECK(m.try_add(column) == status::size_mismatch);
+  CHECK(m.try_subtract(column) == status::size_mismatch);
+  CHECK(column.try_multiply(m) == status::size_mismatch);
+  CHECK(m == (matrix{{1, 2}, {3, 4}}));
+  CHECK(column == (matrix{{1}, {2}}));
+
+  CHECK(m.try_add(m) == status::ok);
+  CHECK(m == (matrix{{2, 4}, {6, 8}}));
+  CHECK(m.try_multiply(column) == status::ok);
+  CHECK(m == (matrix{{10}, {22}}));
+
+  CHECK(column.try_determinant().error() == status::not_square);
+  CHECK(column.try_inverse().error() == status::not_square);
+  matrix singular{{1, 2}, {2, 4}};
+  CHECK(singular.try_inverse().error() == status::singular);
+  CHECK(singular.try_determinant().value() == 0);
+  CHECK(tests::relative_difference(
+            (matrix{{2, 0}, {0, 4}}).try_inverse().value(),
+            matrix{{0.5, 0}, {0, 0.25}}) == 0);
+
+  CHECK(m.try_at(0, 0).value() == 10);
+  CHECK(m.try_at(0, 1).error() == status::out_of_range);
+
+  vector x{1, 2, 3}, y{4, 5, 6};
+  CHECK(x.try_at(3).error() == status::out_of_range);
+  CHECK(try_dot(x, y).value() == 32);
+  CHECK(try_dot(x, vector{1, 2}).error() == status::size_mismatch);
+  CHECK_THROWS(try_dot(x, vector{1, 2}).value(), std::logic_error);
+  CHECK(std::string(math::to_string(status::singular)) ==
+        "matrix is singular");
+}
+
+TEST(try_multiply_throws_when_product_can_not_be_allocated) {
+  matrix a = tests::random_matrix(64, 64, 1);
+  matrix before = a;
+  {
+    budget_scope budget(1024);
+    CHECK_THROWS(a.try_multiply(a), std::bad_alloc);
+    CHECK(a.try_add(a) == status::ok);  // allocates nothing
+  }
+  CHECK(a == before * 2.0);
+}
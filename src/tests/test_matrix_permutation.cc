@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using size_type = matrix::size_type;
+
+std::vector<size_type> random_permutation(size_type n, unsigned seed) {
+  std::vector<size_type> result(n);
+  std::iota(result.begin(), result.end(), size_type(0));
+  std::shuffle(result.begin(), result.end(), std::mt19937(seed));
+  return result;
+}
+
+}  // namespace
+
+TEST(swap_rows_and_columns) {
+  matrix m{{1, 2, 3}, {4, 5, 6}};
+  m.swap_rows(0, 1);
+  CHECK(m == (matrix{{4, 5, 6}, {1, 2, 3}}));
+  m.swap_columns(0, 2);
+  CHECK(m == (matrix{{6, 5, 4}, {3, 2, 1}}));
+  m.swap_rows(1, 1);
+  CHECK(m == (matrix{{6, 5, 4}, {3, 2, 1}}));
+  CHECK_THROWS(m.swap_rows(0, 2), std::out_of_range);
+  CHECK_THROWS(m.swap_columns(3, 0), std::out_of_range);
+}
+
+TEST(permute_rows_follows_every_cycle) {
+  // cycles (0 2 4), (1 3) and fixed point 5
+  matrix m = tests::random_matrix(6, 3, 1);
+  std::vector<size_type> permutation{2, 3, 4, 1, 0, 5};
+  matrix permuted = m;
+  permuted.permute_rows(permutation);
+  for (size_type i = 0; i < 6; ++i) {
+    for (size_type j = 0; j < 3; ++j) {
+      CHECK(permuted(i, j) == m(permutation[i], j));
+    }
+  }
+}
+
+TEST(permute_rows_and_columns_match_random_permutations) {
+  for (size_type rows : {1, 7, 64}) {
+    for (size_type columns : {1, 5, 3000}) {
+      matrix m = tests::random_matrix(rows, columns, unsigned(rows + columns));
+      auto row_order = random_permutation(rows, 1);
+      auto column_order = random_permutation(columns, 2);
+      matrix permuted = m;
+      permuted.permute_rows(row_order);
+      permuted.permute_columns(column_order);
+
+      bool same = true;
+      for (size_type i = 0; i < rows; ++i) {
+        for (size_type j = 0; j < columns; ++j) {
+          same &= permuted(i, j) == m(row_order[i], column_order[j]);
+        }
+      }
+      CHECK(same);
+    }
+  }
+}
+
+TEST(permute_rejects_non_permutations) {
+  matrix m = tests::random_matrix(3, 3, 1);
+  matrix before = m;
+  CHECK_THROWS(m.permute_rows({0, 0, 1}), std::invalid_argument);
+  CHECK_THROWS(m.permute_rows({0, 1}), std::invalid_argument);
+  CHECK_THROWS(m.permute_columns({0, 1, 3}), std::invalid_argument);
+  CHECK(m == before);
+}
@@ -0,0 +1,62 @@
+#include <limits>
+#include <stdexcept>
+
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using size_type = matrix::size_type;
+
+}  // namespace
+
+TEST(set_columns_grows_and_shrinks_in_place) {
+  for (size_type rows : {1, 3, 17}) {
+    for (size_type from : {1, 4, 9}) {
+      for (size_type to : {1, 2, 4, 13}) {
+        matrix m = tests::random_matrix(rows, from, unsigned(rows * from));
+        matrix resized = m;
+        resized.set_columns(to);
+        CHECK(resized.rows() == rows && resized.columns() == to);
+
+        bool same = true;
+        for (size_type i = 0; i < rows; ++i) {
+          for (size_type j = 0; j < to; ++j) {
+            same &= resized(i, j) == (j < from ? m(i, j) : 0);
+          }
+        }
+        CHECK(same);
+      }
+    }
+  }
+}
+
+TEST(set_rows_keeps_rows_and_capacity) {
+  matrix m{{1, 2}, {3, 4}};
+  m.reserve(100);
+  const double* storage = m.data();
+  m.set_rows(5);
+  CHECK(m.data() == storage);
+  CHECK(m(4, 1) == 0);
+  m.set_rows(1);
+  CHECK(m == (matrix{{1, 2}}));
+  CHECK(m.capacity() >= 100);
+  m.shrink_to_fit();
+  CHECK(m.capacity() == 2);
+  CHECK_THROWS(m.set_rows(0), std::invalid_argument);
+}
+
+TEST(reshape_keeps_element_order) {
+  matrix m{{1, 2, 3}, {4, 5, 6}};
+  const double* storage = m.data();
+  m.reshape(3, 2);
+  CHECK(m == (matrix{{1, 2}, {3, 4}, {5, 6}}));
+  CHECK(m.data() == storage);
+  CHECK_THROWS(m.reshape(4, 2), std::invalid_argument);
+  CHECK_THROWS(m.reshape(0, 6), std::invalid_argument);
+
+  // (2^63 + 3) * 2 wraps around to 6 elements
+  size_type wrapping = (std::numeric_limits<size_type>::max() >> 1) + 4;
+  CHECK_THROWS(m.reshape(wrapping, 2), std::invalid_argument);
+  CHECK(m.rows() == 3 && m.columns() == 2);
+}
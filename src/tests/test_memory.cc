@@ -0,0 +1,64 @@
+#include "../math_instrumentation.h"
+#include "../math_memory.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+}  // namespace
+
+TEST(storage_allocations_are_counted_per_thread) {
+  auto before = math::detail::thread_allocations();
+  {
+    matrix m(std::size_t(10), std::size_t(20));
+    matrix copy = m;
+  }
+  auto after = math::detail::thread_allocations();
+  CHECK(after.allocations - before.allocations == 2);
+  CHECK(after.bytes - before.bytes == 2 * 200 * sizeof(double));
+}
+
+TEST(instrumentation_counts_storage_allocations) {
+  if (!math::instrumentation::enabled()) return;
+  math::instrumentation::reset();
+  matrix a = tests::random_matrix(8, 8, 1);
+  matrix b = a + a;
+  auto stats = math::instrumentation::snapshot();
+  CHECK(stats.count("matrix::operator+") == 1);
+  CHECK(stats["matrix::operator+"].allocations == 1);
+  CHECK(stats["matrix::operator+"].allocated_bytes == 64 * sizeof(double));
+}
+
+TEST(nested_operations_are_counted_once) {
+  if (!math::instrumentation::enabled()) return;
+  math::instrumentation::reset();
+  matrix a = tests::random_matrix(8, 8, 1);
+  matrix b = a * a;
+  auto stats = math::instrumentation::snapshot();
+  CHECK(stats["matrix::operator*(matrix)"].calls == 1);
+  CHECK(stats["matrix::operator*(matrix)"].flops == 2 * 8 * 8 * 8);
+  CHECK(stats.count("matrix::operator*=(matrix)") == 0);
+
+  b *= a;
+  stats = math::instrumentation::snapshot();
+  CHECK(stats["matrix::operator*(matrix)"].calls == 1);
+  CHECK(stats["matrix::operator*=(matrix)"].calls == 1);
+}
+
+TEST(memory_peak_scope_measures_calling_thread_peak) {
+  math::memory_peak_scope outer;
+  matrix kept(std::size_t(10), std::size_t(10));
+  {
+    math::memory_peak_scope inner;
+    { matrix temporary(std::size_t(20), std::size_t(20)); }
+    CHECK(inner.peak_bytes() == 400 * sizeof(double));
+  }
+  // the inner peak rises the outer one, on top of storage kept by it
+  CHECK(outer.peak_bytes() == 500 * sizeof(double));
+
+  math::memory_peak_scope after;
+  CHECK(after.peak_bytes() == 0);
+  matrix product = kept * kept;
+  CHECK(after.peak_bytes() >= 100 * sizeof(double));
+}
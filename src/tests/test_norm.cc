@@ -0,0 +1,74 @@
+#include <cfloat>
+#include <cmath>
+
+#include "../math_blas.h"
+#include "../math_norm.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::vector;
+
+}  // namespace
+
+TEST(norm_p_of_small_vector) {
+  vector x{1, -2, 3};
+  CHECK_NEAR(math::norm(x, 1), 6, 1e-15);
+  CHECK_NEAR(math::norm(x, 2), std::sqrt(14.0), 1e-15);
+  CHECK_NEAR(math::norm(x, 3), std::cbrt(36.0), 1e-15);
+  CHECK(math::norm(x, HUGE_VAL) == 3);
+}
+
+TEST(norm_p_with_large_p_does_not_overflow) {
+  // 1.5^2000 and anything scaled above 1 overflow, the result is the maximum
+  CHECK(math::norm(vector{1.5}, 2000) == 1.5);
+  CHECK(math::norm(vector{-1.5, 1.0}, 2000) == 1.5);
+  CHECK_NEAR(math::norm(vector(3e300, 4e300), 2000), 4e300, 1e-15 * 4e300);
+  CHECK_NEAR(math::norm(vector(3e-300, 4e-300), 2000), 4e-300,
+             1e-15 * 4e-300);
+
+  // strided view takes the sequential path
+  matrix m{{1.5, 0}, {-1.5, 0}};
+  CHECK_NEAR(math::norm(math::column_view(m, 0), 2000),
+             1.5 * std::pow(2.0, 1.0 / 2000), 1e-15);
+}
+
+TEST(norm_p_with_subnormal_maximum) {
+  double tiny = DBL_TRUE_MIN * 3;
+  CHECK(math::norm(vector{tiny}, 3) == tiny);
+  CHECK(math::norm(vector{tiny}, 2000) == tiny);
+  CHECK(math::norm2(vector{tiny}) == tiny);
+  CHECK(math::norm2(vector(3 * DBL_TRUE_MIN, 4 * DBL_TRUE_MIN)) ==
+        5 * DBL_TRUE_MIN);
+  CHECK_NEAR(math::norm(vector(3 * DBL_TRUE_MIN, 4 * DBL_TRUE_MIN), 2),
+             5 * DBL_TRUE_MIN, DBL_TRUE_MIN);
+}
+
+TEST(norm2_of_large_and_small_values) {
+  CHECK_NEAR(math::norm2(vector(3e300, 4e300)), 5e300, 1e-15 * 5e300);
+  CHECK_NEAR(math::norm2(vector(3e-300, 4e-300)), 5e-300, 1e-15 * 5e-300);
+}
+
+TEST(norms_propagate_nan) {
+  double nan = std::nan("");
+  vector small{1, nan, 3};
+  CHECK(std::isnan(math::norm_inf(small)));
+  CHECK(std::isnan(math::norm2(small)));
+  CHECK(std::isnan(math::norm(small, 3)));
+
+  // NaN in every position of the accumulators and of the last chunk
+  for (std::size_t n : {9, 100, 100000}) {
+    for (std::size_t position : {std::size_t(0), n / 2, n - 1}) {
+      vector x = tests::random_vector(n, 1);
+      x[position] = nan;
+      CHECK(std::isnan(math::norm_inf(x)));
+    }
+  }
+
+  // strided path
+  matrix m{{1, 0}, {nan, 0}, {3, 0}};
+  CHECK(std::isnan(math::norm_inf(math::column_view(m, 0))));
+  CHECK(std::isnan(math::norm1(m)));
+  CHECK(std::isnan(math::norm_inf(m)));
+}
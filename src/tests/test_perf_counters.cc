@@ -0,0 +1,79 @@
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "../math_instrumentation.h"
+#include "../math_perf_counters.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+}  // namespace
+
+TEST(hardware_counters_degrade_to_nothing_when_unavailable) {
+  math::instrumentation::reset();
+  bool started = math::instrumentation::start_hardware_counters();
+  CHECK(started == math::instrumentation::hardware_counters());
+  if (!math::instrumentation::enabled()) CHECK(!started);
+
+  // operations work either way and are sampled only while counters run
+  matrix a = tests::random_matrix(6, 6, 1);
+  for (int i = 0; i < 3; ++i) a = a.transposed();
+  math::instrumentation::stop_hardware_counters();
+  a = a.transposed();
+  CHECK(!math::instrumentation::hardware_counters());
+
+  auto stats = math::instrumentation::hardware_snapshot();
+  if (!started) {
+    CHECK(stats.empty());
+    return;
+  }
+  // sizes are bucketed to the next power of two
+  math::instrumentation::hardware_key key{"matrix::transposed", 8};
+  CHECK(stats.count(key) == 1);
+  CHECK(stats[key].calls == 3);
+  CHECK(stats[key].instructions > 0);
+
+  math::instrumentation::reset();
+  CHECK(math::instrumentation::hardware_snapshot().empty());
+}
+
+TEST(hardware_sample_reads_consistently) {
+  math::detail::hardware_sample first, second;
+  if (!math::detail::read_hardware_counters(&first)) return;
+  CHECK(math::detail::read_hardware_counters(&second));
+  CHECK(second.enabled >= first.enabled);
+  CHECK(second.running >= first.running);
+  CHECK(second.values[math::detail::hardware_instructions] >=
+        first.values[math::detail::hardware_instructions]);
+}
+
+TEST(hardware_dumps_derive_ipc_and_misses_per_kilo_instruction) {
+  math::instrumentation::hardware_snapshot_type stats;
+  auto& s = stats[{"op", 64}];
+  s.calls = 2;
+  s.cycles = 1000;
+  s.instructions = 2000;
+  s.l1d_misses = 10;
+  s.llc_misses = 4;
+  s.branch_misses = 1;
+
+  std::ostringstream text;
+  math::instrumentation::dump_hardware_text(text, stats);
+  CHECK(text.str().find("2.00") != std::string::npos);  // IPC
+  CHECK(text.str().find("5.00") != std::string::npos);  // L1D per 1000
+  CHECK(text.str().find("0.50") != std::string::npos);  // branches
+
+  std::ostringstream json;
+  math::instrumentation::dump_hardware_json(json, stats);
+  CHECK(json.str() ==
+        "[\n  {\"operation\": \"op\", \"size\": 64, \"calls\": 2, "
+        "\"cycles\": 1000, \"instructions\": 2000, \"l1d_misses\": 10, "
+        "\"llc_misses\": 4, \"branch_misses\": 1}\n]\n");
+
+  std::ostringstream empty;
+  math::instrumentation::dump_hardware_json(empty, {});
+  CHECK(empty.str() == "[]\n");
+}
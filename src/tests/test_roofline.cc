@@ -0,0 +1,68 @@
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+#include "../bench/roofline.h"
+#include "../math_parallel.h"
+#include "test.h"
+
+TEST(roofline_point_is_bounded_by_peak_and_bandwidth) {
+  bench::roofline_point p;
+  p.limits.threads = 4;
+  p.limits.peak_gflops = 100;
+  p.limits.bandwidth_gbps = 10;
+  p.r.samples_ns = {10};
+  p.r.flops = 200;
+  p.r.bytes = 100;
+
+  // 2 flops per byte: memory bound at 20 GFLOP/s, 20 achieved
+  CHECK(p.intensity() == 2);
+  CHECK(p.attainable_gflops() == 20);
+  CHECK(p.efficiency() == 1);
+
+  // 200 flops per byte: compute bound
+  p.r.bytes = 1;
+  CHECK(p.attainable_gflops() == 100);
+  CHECK(p.efficiency() == 0.2);
+
+  p.base_threads = 1;
+  p.speedup = 3;
+  CHECK(p.parallel_efficiency() == 0.75);
+
+  bench::roofline_point empty;
+  CHECK(empty.intensity() == 0);
+  CHECK(empty.efficiency() == 0);
+}
+
+TEST(run_roofline_sweeps_thread_counts) {
+  std::vector<bench::benchmark> list{
+      {"fake/product",
+       [](std::size_t n) {
+         return bench::workload{[] {}, double(n) * n * n, 8.0 * n * n};
+       }},
+      {"fake/other", [](std::size_t) { return bench::workload{[] {}, 1, 1}; }}};
+  bench::options opts;
+  opts.filter = "product";
+  opts.sizes = {4, 8};
+  opts.thread_counts = {2, 1, 2};
+  opts.warmup = 1;
+  opts.repetitions = 2;
+  opts.min_sample_seconds = 1e-5;
+
+  std::size_t threads = math::num_threads();
+  std::ostringstream out;
+  auto points = bench::run_roofline(list, opts, out);
+  CHECK(math::num_threads() == threads);
+
+  // duplicate counts are dropped, counts are sorted, sizes come first
+  CHECK(points.size() == 4);
+  if (points.size() != 4) return;
+  CHECK(points[0].r.name == "fake/product" && points[0].r.size == 4);
+  CHECK(points[0].limits.threads == 1 && points[1].limits.threads == 2);
+  CHECK(points[2].r.size == 8);
+  for (const auto& p : points) {
+    CHECK(p.base_threads == 1);
+    CHECK(p.limits.peak_gflops > 0 && p.limits.bandwidth_gbps > 0);
+  }
+  CHECK(points[0].speedup == 1);
+}
@@ -0,0 +1,114 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../math_kernels.h"
+#include "../math_small_kernels.h"
+#include "test.h"
+
+// Small kernels promise the results of the general kernels bit for bit, so
+// they are compared exactly for every size they cover.
+
+namespace {
+
+using math::matrix;
+using math::detail::kSmallMax;
+using math::detail::kSmallMin;
+
+// Rows of products are not unrolled, the smallest, an odd and the largest
+// count stand for the others
+const std::size_t kRowCounts[] = {kSmallMin, 5, kSmallMax};
+
+// Determinant of the general path: product of diagonal of the triangle
+double triangle_determinant(const matrix& m) {
+  matrix triangle = m.upper_triangle_matrix();
+  double result = 1;
+  for (std::size_t i = 0; i < m.rows(); ++i) result *= triangle(i, i);
+  return result;
+}
+
+}  // namespace
+
+TEST(small_gemm_matches_gemm_kernel) {
+  unsigned seed = 0;
+  for (std::size_t k = kSmallMin; k <= kSmallMax; ++k) {
+    for (std::size_t n = kSmallMin; n <= kSmallMax; ++n) {
+      for (std::size_t m : kRowCounts) {
+        matrix a = tests::random_matrix(m, k, ++seed);
+        matrix b = tests::random_matrix(k, n, ++seed);
+        auto kernel = math::detail::find_small_gemm(m, k, n);
+        CHECK(kernel != nullptr);
+        if (!kernel) continue;
+
+        std::vector<double> small(m * n, -1.0), general(m * n, 0.0);
+        kernel(m, a.data(), b.data(), small.data());
+        math::detail::gemm_kernel(m, n, k, a.data(), k, b.data(), n,
+                                  general.data(), n);
+        bool same = small == general;
+        if (!same) {
+          tests::fail(__FILE__, __LINE__,
+                      "small gemm differs for " + std::to_string(m) + "x" +
+                          std::to_string(k) + "x" + std::to_string(n));
+        }
+      }
+    }
+  }
+}
+
+TEST(small_kernels_cover_only_small_sizes) {
+  using math::detail::find_small_determinant;
+  using math::detail::find_small_gemm;
+  using math::detail::find_small_transpose;
+  CHECK(find_small_gemm(kSmallMax + 1, 4, 4) == nullptr);
+  CHECK(find_small_gemm(kSmallMin - 1, 4, 4) == nullptr);
+  CHECK(find_small_gemm(4, kSmallMin - 1, 4) == nullptr);
+  CHECK(find_small_gemm(4, 4, kSmallMax + 1) == nullptr);
+  CHECK(find_small_transpose(kSmallMax + 1, 4) == nullptr);
+  CHECK(find_small_transpose(4, kSmallMin - 1) == nullptr);
+  CHECK(find_small_determinant(kSmallMin - 1) == nullptr);
+  CHECK(find_small_determinant(kSmallMax + 1) == nullptr);
+}
+
+TEST(small_transpose_matches_general_transpose) {
+  unsigned seed = 0;
+  for (std::size_t rows = kSmallMin; rows <= kSmallMax; ++rows) {
+    for (std::size_t columns = kSmallMin; columns <= kSmallMax; ++columns) {
+      matrix m = tests::random_matrix(rows, columns, ++seed);
+      auto kernel = math::detail::find_small_transpose(rows, columns);
+      CHECK(kernel != nullptr);
+      if (!kernel) continue;
+
+      std::vector<double> small(rows * columns);
+      kernel(m.data(), small.data());
+      bool same = true;
+      for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < columns; ++j) {
+          same &= small[j * rows + i] == m(i, j);
+        }
+      }
+      CHECK(same);
+    }
+  }
+}
+
+TEST(small_determinant_matches_triangle) {
+  unsigned seed = 0;
+  for (std::size_t n = kSmallMin; n <= kSmallMax; ++n) {
+    auto kernel = math::detail::find_small_determinant(n);
+    CHECK(kernel != nullptr);
+    if (!kernel) continue;
+
+    matrix m = tests::random_matrix(n, n, ++seed);
+    CHECK(kernel(m.data()) == triangle_determinant(m));
+
+    // zero pivot: the first row gets a row below added
+    m(0, 0) = 0;
+    m(1, 0) = 0;
+    CHECK(kernel(m.data()) == triangle_determinant(m));
+
+    // zero column: the determinant is exactly 0
+    for (std::size_t i = 0; i < n; ++i) m(i, n / 2) = 0;
+    CHECK(kernel(m.data()) == 0);
+    CHECK(triangle_determinant(m) == 0);
+  }
+}
@@ -0,0 +1,75 @@
+#include <stdexcept>
+
+#include "../math_parallel.h"
+#include "../math_strassen.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+// Restores options and thread count changed by a test
+struct strassen_scope {
+  math::strassen_options saved = math::get_strassen_options();
+  std::size_t threads = math::num_threads();
+
+  ~strassen_scope() {
+    math::set_strassen_options(saved);
+    math::set_num_threads(threads);
+  }
+};
+
+void check_against_classical(std::size_t n, std::size_t memory_limit,
+                             std::size_t threads) {
+  matrix a = tests::random_matrix(n, n, unsigned(n));
+  matrix b = tests::random_matrix(n, n, unsigned(n + 1));
+
+  math::strassen_options options;
+  math::set_strassen_options(options);
+  matrix classical = a * b;
+
+  options.enabled = true;
+  options.crossover = 16;
+  options.memory_limit = memory_limit;
+  math::set_num_threads(threads);
+  math::set_strassen_options(options);
+  matrix strassen = a * b;
+
+  // the normwise bound grows with the number of recursion levels
+  CHECK(tests::relative_difference(strassen, classical) < 1e-12);
+}
+
+}  // namespace
+
+TEST(strassen_matches_classical_product) {
+  strassen_scope scope;
+  for (std::size_t n : {16, 17, 64, 99, 128, 131}) {
+    for (std::size_t threads : {1, 4}) check_against_classical(n, 0, threads);
+  }
+}
+
+TEST(strassen_within_memory_limit_matches_classical_product) {
+  strassen_scope scope;
+  // too small for the concurrent top level, then too small for any level
+  for (std::size_t limit : {std::size_t(64) << 10, std::size_t(8)}) {
+    for (std::size_t n : {64, 99, 128}) check_against_classical(n, limit, 4);
+  }
+}
+
+TEST(strassen_is_not_used_below_crossover_or_for_rectangles) {
+  strassen_scope scope;
+  math::strassen_options options;
+  options.enabled = true;
+  options.crossover = 32;
+  math::set_strassen_options(options);
+  CHECK(!math::detail::use_strassen(31, 31, 31));
+  CHECK(!math::detail::use_strassen(40, 40, 41));
+  CHECK(math::detail::use_strassen(32, 32, 32));
+}
+
+TEST(strassen_rejects_crossover_below_two) {
+  strassen_scope scope;
+  math::strassen_options options;
+  options.crossover = 1;
+  CHECK_THROWS(math::set_strassen_options(options), std::invalid_argument);
+}
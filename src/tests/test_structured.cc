@@ -0,0 +1,161 @@
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "../math_parallel.h"
+#include "../math_structured.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+using math::vector;
+using size_type = matrix::size_type;
+
+// Kronecker product element by element from its definition
+matrix naive_kron(const matrix& a, const matrix& b) {
+  matrix result(a.rows() * b.rows(), a.columns() * b.columns());
+  for (size_type i = 0; i < result.rows(); ++i) {
+    for (size_type j = 0; j < result.columns(); ++j) {
+      result(i, j) = a(i / b.rows(), j / b.columns()) *
+                     b(i % b.rows(), j % b.columns());
+    }
+  }
+  return result;
+}
+
+// Restores thread count changed by a test
+struct threads_scope {
+  std::size_t saved = math::num_threads();
+  ~threads_scope() { math::set_num_threads(saved); }
+};
+
+}  // namespace
+
+TEST(block_and_set_block) {
+  matrix m = tests::random_matrix(5, 6, 1);
+  matrix b = m.block(1, 2, 3, 4);
+  for (size_type i = 0; i < 3; ++i) {
+    for (size_type j = 0; j < 4; ++j) CHECK(b(i, j) == m(i + 1, j + 2));
+  }
+  matrix target(std::size_t(5), std::size_t(6));
+  target.set_block(1, 2, b);
+  CHECK(target.block(1, 2, 3, 4) == b);
+  CHECK_THROWS(target.set_block(3, 3, b), std::out_of_range);
+  CHECK_THROWS(m.block(0, 0, 6, 1), std::out_of_range);
+}
+
+TEST(kron_matches_definition) {
+  threads_scope scope;
+  math::set_num_threads(4);
+  // the last shape is large enough to be built by several threads
+  const size_type shapes[][4] = {
+      {1, 1, 1, 1}, {2, 3, 4, 1}, {3, 1, 2, 5}, {40, 30, 30, 40}};
+  unsigned seed = 0;
+  for (const auto& s : shapes) {
+    matrix a = tests::random_matrix(s[0], s[1], ++seed);
+    matrix b = tests::random_matrix(s[2], s[3], ++seed);
+    CHECK(math::kron(a, b) == naive_kron(a, b));
+  }
+}
+
+TEST(kron_multiply_matches_kron_product) {
+  unsigned seed = 0;
+  for (size_type n : {1, 2, 7, 20}) {
+    matrix a = tests::random_matrix(n, n + 1, ++seed);
+    matrix b = tests::random_matrix(n + 2, n, ++seed);
+    vector x = tests::random_vector((n + 1) * n, ++seed);
+
+    matrix column(x.size(), std::size_t(1));
+    for (size_type i = 0; i < x.size(); ++i) column(i, 0) = x[i];
+    matrix expected = naive_kron(a, b) * column;
+
+    vector result = math::kron_multiply(a, b, x);
+    matrix actual(result.size(), std::size_t(1));
+    for (size_type i = 0; i < result.size(); ++i) actual(i, 0) = result[i];
+    CHECK(tests::relative_difference(actual, expected) < 1e-13);
+  }
+
+  matrix a = tests::random_matrix(2, 3, 1);
+  CHECK_THROWS(math::kron_multiply(a, a, tests::random_vector(8, 1)),
+               std::invalid_argument);
+}
+
+TEST(hadamard_product_and_division) {
+  threads_scope scope;
+  math::set_num_threads(4);
+  for (size_type n : {1, 3, 300}) {
+    matrix a = tests::random_matrix(n, n + 1, 1);
+    matrix b = tests::random_matrix(n, n + 1, 2);
+    matrix product = math::hadamard_product(a, b);
+    matrix quotient = math::hadamard_division(a, b);
+
+    bool same = true;
+    for (size_type i = 0; i < n; ++i) {
+      for (size_type j = 0; j <= n; ++j) {
+        same &= product(i, j) == a(i, j) * b(i, j);
+        same &= quotient(i, j) == a(i, j) / b(i, j);
+      }
+    }
+    CHECK(same);
+  }
+
+  matrix a = tests::random_matrix(2, 3, 1);
+  matrix b = tests::random_matrix(3, 2, 1);
+  CHECK_THROWS(math::hadamard_product(a, b), std::invalid_argument);
+  CHECK_THROWS(math::hadamard_division(a, b), std::invalid_argument);
+}
+
+TEST(stacking_places_blocks) {
+  matrix a{{1, 2}, {3, 4}};
+  matrix b{{5}, {6}};
+  matrix c{{7, 8}};
+
+  matrix side_by_side{{1, 2, 5}, {3, 4, 6}};
+  CHECK(math::hstack(a, b) == side_by_side);
+  CHECK(math::hstack(std::vector<matrix>{a, b}) == side_by_side);
+
+  matrix one_under_another{{1, 2}, {3, 4}, {7, 8}};
+  CHECK(math::vstack(a, c) == one_under_another);
+  CHECK(math::vstack(std::vector<matrix>{a, c}) == one_under_another);
+
+  matrix diagonal{{1, 2, 0, 0, 0},
+                  {3, 4, 0, 0, 0},
+                  {0, 0, 5, 0, 0},
+                  {0, 0, 6, 0, 0},
+                  {0, 0, 0, 7, 8}};
+  CHECK(math::block_diag(a, b, c) == diagonal);
+  CHECK(math::block_diag(std::vector<matrix>{a, b, c}) == diagonal);
+  CHECK(math::hstack(a) == a);
+
+  CHECK_THROWS(math::hstack(a, c), std::invalid_argument);
+  CHECK_THROWS(math::vstack(a, b), std::invalid_argument);
+  CHECK_THROWS(math::hstack(std::vector<matrix>()), std::invalid_argument);
+  CHECK_THROWS(math::vstack(std::vector<matrix>()), std::invalid_argument);
+  CHECK_THROWS(math::block_diag(std::vector<matrix>()),
+               std::invalid_argument);
+}
+
+TEST(stacking_large_blocks) {
+  threads_scope scope;
+  math::set_num_threads(4);
+  matrix a = tests::random_matrix(500, 300, 1);
+  matrix b = tests::random_matrix(500, 200, 2);
+  matrix c = tests::random_matrix(100, 300, 3);
+
+  matrix wide = math::hstack(a, b);
+  CHECK(wide.block(0, 0, 500, 300) == a);
+  CHECK(wide.block(0, 300, 500, 200) == b);
+
+  matrix tall = math::vstack(a, c);
+  CHECK(tall.block(0, 0, 500, 300) == a);
+  CHECK(tall.block(500, 0, 100, 300) == c);
+
+  matrix diagonal = math::block_diag(a, c);
+  CHECK(diagonal.block(0, 0, 500, 300) == a);
+  CHECK(diagonal.block(500, 300, 100, 300) == c);
+  CHECK(diagonal.block(0, 300, 500, 300) ==
+        matrix(std::size_t(500), std::size_t(300)));
+  CHECK(diagonal.block(500, 0, 100, 300) ==
+        matrix(std::size_t(100), std::size_t(300)));
+}
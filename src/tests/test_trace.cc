@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "../math_instrumentation.h"
+#include "../math_parallel.h"
+#include "test.h"
+
+namespace {
+
+using math::matrix;
+
+std::size_t occurrences(const std::string& text, const std::string& what) {
+  std::size_t count = 0;
+  for (std::size_t pos = text.find(what); pos != std::string::npos;
+       pos = text.find(what, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+std::string written_trace() {
+  std::ostringstream out;
+  math::instrumentation::write_trace(out);
+  return out.str();
+}
+
+}  // namespace
+
+TEST(tracing_starts_only_in_instrumented_builds) {
+  math::instrumentation::start_tracing(16);
+  CHECK(math::instrumentation::tracing() ==
+        math::instrumentation::enabled());
+  math::instrumentation::stop_tracing();
+  CHECK(!math::instrumentation::tracing());
+}
+
+TEST(trace_ring_buffer_keeps_latest_events) {
+  if (!math::instrumentation::enabled()) return;
+  matrix a = tests::random_matrix(4, 6, 1);
+
+  math::instrumentation::start_tracing(3);
+  for (int i = 0; i < 5; ++i) a = a.transposed();
+  math::instrumentation::stop_tracing();
+  a = a.transposed();  // not recorded
+
+  std::string trace = written_trace();
+  CHECK(trace.compare(0, 16, "{\"traceEvents\": ") == 0);
+  CHECK(occurrences(trace, "\"name\": \"matrix::transposed\"") == 3);
+  CHECK(occurrences(trace, "\"ph\": \"X\"") == 3);
+  // sources of the last three transpositions: 4 x 6, 6 x 4, 4 x 6
+  CHECK(occurrences(trace, "\"shape\": [4, 6]") == 2);
+  CHECK(occurrences(trace, "\"shape\": [6, 4]") == 1);
+}
+
+TEST(trace_records_pool_tasks_and_nested_operations) {
+  if (!math::instrumentation::enabled()) return;
+  matrix a = tests::random_matrix(8, 8, 1);
+
+  std::size_t threads = math::num_threads();
+  math::set_num_threads(2);  // one thread runs chunks without the pool
+
+  math::instrumentation::start_tracing();
+  matrix b = a * a;
+  math::detail::parallel_for(4, 1, [](std::size_t, std::size_t) {});
+  math::instrumentation::stop_tracing();
+  math::set_num_threads(threads);
+
+  std::string trace = written_trace();
+  CHECK(occurrences(trace, "\"matrix::operator*(matrix)\"") == 1);
+  CHECK(occurrences(trace, "\"matrix::operator*=(matrix)\"") == 1);
+  CHECK(occurrences(trace, "\"cat\": \"pool\"") == 4);
+  CHECK(occurrences(trace, "\"chunk\": 3") == 1);
+}
+
+TEST(trace_file_keeps_every_event) {
+  if (!math::instrumentation::enabled()) return;
+  std::string path = "math_test_trace.json";
+  matrix a = tests::random_matrix(4, 4, 1);
+
+  // capacity 2 flushes the buffer to the file several times
+  math::instrumentation::start_tracing(path, 2);
+  for (int i = 0; i < 7; ++i) a = a.transposed();
+  math::instrumentation::stop_tracing();
+
+  std::ifstream file(path);
+  std::string trace{std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>()};
+  file.close();
+  std::remove(path.c_str());
+
+  CHECK(trace.compare(0, 2, "[\n") == 0);
+  CHECK(trace.size() > 3 && trace.compare(trace.size() - 3, 3, "\n]\n") == 0);
+  CHECK(occurrences(trace, "\"matrix::transposed\"") == 7);
+
+  CHECK_THROWS(math::instrumentation::start_tracing("no/such/dir/trace.json"),
+               std::runtime_error);
+  CHECK(!math::instrumentation::tracing());
+}
@@ -0,0 +1,116 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "../math_tuning.h"
+#include "test.h"
+
+namespace {
+
+// Fresh directory for profiles, removed with everything in it on destruction
+class temporary_directory {
+ public:
+  temporary_directory()
+      : path_(std::filesystem::temp_directory_path() / "math_tuning_test") {
+    std::filesystem::remove_all(path_);
+  }
+  ~temporary_directory() { std::filesystem::remove_all(path_); }
+
+  std::string file(const std::string& name) const {
+    return (path_ / name).string();
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+void write_file(const std::string& path, const std::string& text) {
+  std::ofstream(path) << text;
+}
+
+}  // namespace
+
+TEST(set_tuning_rejects_zero_parameters) {
+  math::tuning_parameters saved = math::tuning();
+  math::tuning_parameters changed = saved;
+  changed.lu_block = 17;
+  math::set_tuning(changed);
+  CHECK(math::tuning().lu_block == 17);
+
+  changed.gemm_depth = 0;
+  CHECK_THROWS(math::set_tuning(changed), std::invalid_argument);
+  CHECK(math::tuning().gemm_depth == saved.gemm_depth);
+  math::set_tuning(saved);
+}
+
+TEST(tuning_profile_round_trips_and_keeps_other_cpus) {
+  temporary_directory dir;
+  std::string path = dir.file("nested/dir/tuning.profile");
+
+  math::tuning_parameters a, b;
+  a.gemm_columns = 96;
+  a.lu_grain = 5;
+  b.transpose_block = 8;
+  math::write_tuning_profile(path, "cpu a", a);
+  math::write_tuning_profile(path, "cpu b", b);
+  a.gemm_depth = 48;
+  math::write_tuning_profile(path, "cpu a", a);  // replaces its entry
+
+  math::tuning_parameters read;
+  CHECK(math::read_tuning_profile(path, "cpu a", &read));
+  CHECK(read.gemm_columns == 96 && read.gemm_depth == 48);
+  CHECK(read.lu_grain == 5);
+  CHECK(math::read_tuning_profile(path, "cpu b", &read));
+  CHECK(read.transpose_block == 8 && read.gemm_columns == 256);
+
+  math::tuning_parameters untouched;
+  untouched.lu_block = 3;
+  CHECK(!math::read_tuning_profile(path, "cpu c", &untouched));
+  CHECK(!math::read_tuning_profile(dir.file("missing"), "cpu a", &untouched));
+  CHECK(untouched.lu_block == 3);
+}
+
+TEST(tuning_profile_parsing) {
+  temporary_directory dir;
+  std::filesystem::create_directories(dir.file(""));
+  std::string path = dir.file("tuning.profile");
+
+  // comments, spaces and unknown keys are fine, missing keys keep values
+  write_file(path,
+             "# comment\n[other]\ngemm_depth = 1\n\n"
+             "[ this cpu ]\n  gemm_depth=64  \nfuture_key = 1\n");
+  math::tuning_parameters parameters;
+  parameters.lu_block = 3;
+  CHECK(math::read_tuning_profile(path, "this cpu", &parameters));
+  CHECK(parameters.gemm_depth == 64);
+  CHECK(parameters.lu_block == 3);
+
+  write_file(path, "[this cpu]\ngemm_depth 64\n");
+  CHECK_THROWS(math::read_tuning_profile(path, "this cpu", &parameters),
+               std::runtime_error);
+  write_file(path, "[this cpu]\ngemm_depth = 0\n");
+  CHECK_THROWS(math::read_tuning_profile(path, "this cpu", &parameters),
+               std::runtime_error);
+  write_file(path, "[this cpu]\ngemm_depth = -4\n");
+  CHECK_THROWS(math::read_tuning_profile(path, "this cpu", &parameters),
+               std::runtime_error);
+  CHECK(parameters.gemm_depth == 64);
+}
+
+TEST(default_tuning_profile_follows_environment) {
+  const char* saved = std::getenv("MATH_TUNING_PROFILE");
+  std::string saved_value = saved ? saved : "";
+
+  setenv("MATH_TUNING_PROFILE", "/tmp/custom.profile", 1);
+  CHECK(math::default_tuning_profile() == "/tmp/custom.profile");
+  unsetenv("MATH_TUNING_PROFILE");
+  if (std::getenv("HOME")) {
+    CHECK(math::default_tuning_profile() ==
+          std::string(std::getenv("HOME")) +
+              "/.config/cpp_math_library/tuning.profile");
+  }
+
+  if (saved) setenv("MATH_TUNING_PROFILE", saved_value.c_str(), 1);
+}